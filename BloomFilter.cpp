@@ -0,0 +1,59 @@
+#include "BloomFilter.h"
+#include <cmath>
+#include <functional>
+
+namespace {
+    // Doubles within Value::epsilon compare equal, so they are hashed by their epsilon-wide bucket;
+    // a probe checks its own bucket and both neighbours.
+    double doubleBucket(double value) {
+        return std::floor(value / Value::epsilon) + 0.0; // + 0.0 folds -0.0 into 0.0
+    }
+
+    uint64_t hashDouble(double bucket) {
+        return mixHash(std::hash<double>{}(bucket));
+    }
+
+    uint64_t hashString(const std::string& value) {
+        return mixHash(std::hash<std::string>{}(value));
+    }
+}
+
+BloomFilter::BloomFilter(std::size_t expectedItems) : words((expectedItems * bitsPerItem + 63) / 64) {}
+
+void BloomFilter::addHash(uint64_t hash) {
+    // Double hashing: the k probes are h1 + i * h2 (Kirsch and Mitzenmacher).
+    const uint64_t bits = words.size() * 64;
+    const uint64_t h2 = (hash >> 32) | 1;
+    for (int i = 0; i < hashCount; i++) {
+        const uint64_t bit = (hash + i * h2) % bits;
+        words[bit / 64] |= uint64_t(1) << (bit % 64);
+    }
+}
+
+bool BloomFilter::mayContainHash(uint64_t hash) const {
+    const uint64_t bits = words.size() * 64;
+    const uint64_t h2 = (hash >> 32) | 1;
+    for (int i = 0; i < hashCount; i++) {
+        const uint64_t bit = (hash + i * h2) % bits;
+        if (!(words[bit / 64] & (uint64_t(1) << (bit % 64)))) return false;
+    }
+    return true;
+}
+
+void BloomFilter::add(const Value &value) {
+    if (words.empty()) return;
+    addHash(value.type == DataType::DOUBLE ? hashDouble(doubleBucket(value.numValue)) : hashString(value.strValue));
+}
+
+bool BloomFilter::mayContain(const Value &value) const {
+    if (words.empty()) return true;
+    if (value.type != DataType::DOUBLE) return mayContainHash(hashString(value.strValue));
+
+    const double bucket = doubleBucket(value.numValue);
+    return mayContainHash(hashDouble(bucket - 1)) || mayContainHash(hashDouble(bucket)) ||
+           mayContainHash(hashDouble(bucket + 1));
+}
+
+std::size_t BloomFilter::memoryUsage() const {
+    return words.capacity() * sizeof(uint64_t);
+}
\ No newline at end of file
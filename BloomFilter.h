@@ -0,0 +1,28 @@
+#ifndef PROEKT_BLOOMFILTER_H
+#define PROEKT_BLOOMFILTER_H
+
+#include <cstdint>
+#include <vector>
+#include "Data.h"
+
+// Answers "possibly present" or "definitely absent" for Value equality (=), including the
+// tolerant equality of doubles. A default-constructed filter holds no bits and answers
+// "possibly present" for everything.
+class BloomFilter {
+    static constexpr int hashCount = 7;   // optimal for 10 bits per item, ~1% false positives
+    static constexpr int bitsPerItem = 10;
+    std::vector<uint64_t> words;
+
+    void addHash(uint64_t hash);
+    bool mayContainHash(uint64_t hash) const;
+
+public:
+    BloomFilter() = default;
+    explicit BloomFilter(std::size_t expectedItems);
+
+    void add(const Value& value);
+    bool mayContain(const Value& value) const;
+    std::size_t memoryUsage() const;
+};
+
+#endif //PROEKT_BLOOMFILTER_H
\ No newline at end of file
@@ -0,0 +1,83 @@
+#include "Commands.h"
+
+namespace {
+    // Database reports through std::cout; while a command runs, its output is routed to the caller's stream.
+    class OutputRedirect {
+        std::streambuf* previous;
+
+    public:
+        explicit OutputRedirect(std::ostream& out) : previous(nullptr) {
+            if (&out != &std::cout) previous = std::cout.rdbuf(out.rdbuf());
+        }
+        ~OutputRedirect() {
+            if (previous) std::cout.rdbuf(previous);
+        }
+        OutputRedirect(const OutputRedirect&) = delete;
+        OutputRedirect& operator=(const OutputRedirect&) = delete;
+    };
+}
+
+bool processCommand(Session& session, const std::string& command, std::ostream& out) {
+    auto tokens = tokenize(command);
+    if (tokens.empty()) return true;
+
+    OutputRedirect redirect(out);
+
+    const Token& cmd = tokens[0];
+
+    try {
+        if (cmd.is("PREPARE")) {
+            if (tokens.size() < 4 || !tokens[2].is("AS")) throw std::runtime_error("Expected PREPARE name AS statement");
+
+            // The statement is kept as text: its tokens only view `command`.
+            const std::size_t offset = tokens[3].text.data() - command.data();
+            session.prepareNamed(tokens[1].str(), command.substr(offset));
+            std::cout << "Statement " << tokens[1].text << " prepared" << std::endl;
+
+        } else if (cmd.is("EXECUTE")) {
+            if (tokens.size() < 2) throw std::runtime_error("Expected statement name after EXECUTE");
+
+            std::vector<Token> literals;
+            for (size_t i = 2; i < tokens.size(); i++) {
+                if (tokens[i] != "(" && tokens[i] != ")" && tokens[i] != ",") {
+                    literals.push_back(tokens[i]);
+                }
+            }
+            return session.executeNamed(tokens[1].str(), literals);
+
+        } else if (cmd.is("BEGIN")) {
+            session.begin();
+            std::cout << "Transaction started" << std::endl;
+
+        } else if (cmd.is("COMMIT")) {
+            session.commit();
+            std::cout << "Transaction committed" << std::endl;
+
+        } else if (cmd.is("ROLLBACK")) {
+            session.rollback();
+            std::cout << "Transaction rolled back" << std::endl;
+
+        } else if (cmd.is("FORMAT")) {
+            if (tokens.size() < 2) throw std::runtime_error("Expected FORMAT TABLE|CSV|JSON|BINARY");
+            session.setOutputFormat(parseOutputFormat(tokens[1].str()));
+            std::cout << "Output format set to " << tokens[1].text << std::endl;
+
+        } else if (cmd.is("DEALLOCATE")) {
+            if (tokens.size() < 2) throw std::runtime_error("Expected statement name after DEALLOCATE");
+            session.deallocate(tokens[1].str());
+            std::cout << "Statement " << tokens[1].text << " deallocated" << std::endl;
+
+        } else {
+            auto statement = parseStatement(session.getDatabase(), tokens);
+            if (!statement) {
+                std::cout << "Unknown command: " << cmd.text << std::endl;
+                return true;
+            }
+            return session.execute(*statement);
+        }
+
+    } catch (const std::exception& e) {
+        std::cout << "Error: " << e.what() << std::endl;
+    }
+    return true;
+}
\ No newline at end of file
@@ -0,0 +1,11 @@
+#ifndef PROEKT_COMMANDS_H
+#define PROEKT_COMMANDS_H
+
+#include <iostream>
+#include "Session.h"
+
+// Executes one statement against the database and writes everything it prints to `out`.
+// Returns false when the statement asks to end the session (QUIT/EXIT).
+bool processCommand(Session& session, const std::string& command, std::ostream& out = std::cout);
+
+#endif //PROEKT_COMMANDS_H
\ No newline at end of file
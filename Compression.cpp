@@ -0,0 +1,130 @@
+#include "Compression.h"
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+    constexpr std::size_t minMatch = 4;
+    constexpr std::size_t maxOffset = 65535;
+    constexpr int hashBits = 16;
+
+    uint32_t read32(const char* p) {
+        uint32_t value;
+        std::memcpy(&value, p, sizeof(value));
+        return value;
+    }
+
+    uint32_t hashSequence(uint32_t sequence) {
+        return (sequence * 2654435761u) >> (32 - hashBits);
+    }
+
+    void writeLength(std::string& out, std::size_t length) {
+        while (length >= 255) {
+            out.push_back(static_cast<char>(255));
+            length -= 255;
+        }
+        out.push_back(static_cast<char>(length));
+    }
+
+    void writeSequence(std::string& out, std::string_view literals, std::size_t offset, std::size_t matchLength) {
+        const std::size_t literalLength = literals.size();
+        const std::size_t matchCode = matchLength ? matchLength - minMatch : 0;
+        out.push_back(static_cast<char>((std::min<std::size_t>(literalLength, 15) << 4) | std::min<std::size_t>(matchCode, 15)));
+        if (literalLength >= 15) writeLength(out, literalLength - 15);
+        out.append(literals);
+        if (!matchLength) return;
+
+        out.push_back(static_cast<char>(offset & 0xFF));
+        out.push_back(static_cast<char>(offset >> 8));
+        if (matchCode >= 15) writeLength(out, matchCode - 15);
+    }
+
+    class Reader {
+        std::string_view input;
+        std::size_t pos = 0;
+
+    public:
+        explicit Reader(std::string_view input) : input(input) {}
+
+        bool done() const { return pos == input.size(); }
+
+        uint8_t byte() {
+            if (pos >= input.size()) throw std::runtime_error("Compressed data is truncated");
+            return static_cast<uint8_t>(input[pos++]);
+        }
+
+        std::size_t length(std::size_t base) {
+            if (base < 15) return base;
+            uint8_t next;
+            do {
+                next = byte();
+                base += next;
+            } while (next == 255);
+            return base;
+        }
+
+        std::string_view take(std::size_t count) {
+            if (count > input.size() - pos) throw std::runtime_error("Compressed data is truncated");
+            std::string_view bytes = input.substr(pos, count);
+            pos += count;
+            return bytes;
+        }
+    };
+}
+
+std::string compressBlock(std::string_view input) {
+    std::string out;
+    out.reserve(input.size() / 2 + 16);
+    std::vector<uint32_t> table(std::size_t(1) << hashBits, UINT32_MAX);
+
+    std::size_t anchor = 0;
+    std::size_t pos = 0;
+    std::size_t misses = 0;
+    while (pos + minMatch <= input.size()) {
+        const uint32_t sequence = read32(input.data() + pos);
+        uint32_t& slot = table[hashSequence(sequence)];
+        const std::size_t candidate = slot;
+        slot = static_cast<uint32_t>(pos);
+
+        if (candidate == UINT32_MAX || pos - candidate > maxOffset || read32(input.data() + candidate) != sequence) {
+            pos += 1 + (misses++ >> 6); // skip faster through data that does not compress
+            continue;
+        }
+
+        std::size_t length = minMatch;
+        while (pos + length < input.size() && input[candidate + length] == input[pos + length]) length++;
+
+        writeSequence(out, input.substr(anchor, pos - anchor), pos - candidate, length);
+        pos += length;
+        anchor = pos;
+        misses = 0;
+    }
+    writeSequence(out, input.substr(anchor), 0, 0);
+    return out;
+}
+
+std::string decompressBlock(std::string_view input, std::size_t rawSize) {
+    std::string out;
+    out.reserve(rawSize);
+    Reader reader(input);
+
+    while (!reader.done()) {
+        const uint8_t token = reader.byte();
+        out.append(reader.take(reader.length(token >> 4)));
+        if (out.size() > rawSize) throw std::runtime_error("Compressed data is longer than expected");
+        if (reader.done()) break;
+
+        const std::size_t offsetLow = reader.byte();
+        const std::size_t offset = offsetLow | (std::size_t(reader.byte()) << 8);
+        const std::size_t length = reader.length(token & 0x0F) + minMatch;
+        if (offset == 0 || offset > out.size()) throw std::runtime_error("Compressed data has an invalid match offset");
+        if (out.size() + length > rawSize) throw std::runtime_error("Compressed data is longer than expected");
+
+        // Byte by byte: a match may overlap the bytes it is producing (runs).
+        const std::size_t start = out.size() - offset;
+        for (std::size_t i = 0; i < length; i++) out.push_back(out[start + i]);
+    }
+    if (out.size() != rawSize) throw std::runtime_error("Compressed data has an unexpected size");
+    return out;
+}
\ No newline at end of file
@@ -0,0 +1,15 @@
+#ifndef PROEKT_COMPRESSION_H
+#define PROEKT_COMPRESSION_H
+
+#include <string>
+#include <string_view>
+
+// Byte-oriented LZ77 compressor in the style of LZ4: a stream of sequences, each a token byte
+// (literal length << 4 | match length - 4, 15 meaning "more length bytes follow"), the literals,
+// then a 16-bit little-endian match offset. The last sequence carries literals only.
+std::string compressBlock(std::string_view input);
+
+// Throws std::runtime_error when `input` is not a valid stream of `rawSize` bytes.
+std::string decompressBlock(std::string_view input, std::size_t rawSize);
+
+#endif //PROEKT_COMPRESSION_H
\ No newline at end of file
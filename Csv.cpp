@@ -0,0 +1,313 @@
+#include "Csv.h"
+#include <algorithm>
+#include <charconv>
+#include <exception>
+#include <fcntl.h>
+#include <fstream>
+#include <iterator>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+
+namespace {
+    constexpr std::size_t minChunkSize = 1 << 20;
+    constexpr std::size_t exportBufferSize = 1 << 20;
+
+    class MappedFile {
+        int fd = -1;
+        void* data = MAP_FAILED;
+        std::size_t size = 0;
+
+    public:
+        explicit MappedFile(const std::string& path) {
+            fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+            if (fd < 0) throw std::runtime_error("Could not open " + path);
+
+            // The destructor does not run when the constructor throws, so the descriptor is closed here.
+            struct stat info{};
+            if (fstat(fd, &info) < 0) {
+                close(fd);
+                throw std::runtime_error("Could not read " + path);
+            }
+            size = static_cast<std::size_t>(info.st_size);
+            if (size == 0) return;
+
+            data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (data == MAP_FAILED) {
+                close(fd);
+                throw std::runtime_error("Could not map " + path);
+            }
+            madvise(data, size, MADV_SEQUENTIAL);
+        }
+        ~MappedFile() {
+            if (data != MAP_FAILED) munmap(data, size);
+            if (fd >= 0) close(fd);
+        }
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        std::string_view view() const {
+            return size == 0 ? std::string_view() : std::string_view(static_cast<const char*>(data), size);
+        }
+    };
+
+    struct Field {
+        std::string_view text;
+        bool quoted = false;
+        bool escaped = false; // contains doubled quotes that still have to be collapsed
+    };
+
+    struct Chunk {
+        std::size_t begin;
+        std::size_t end;
+        std::size_t firstLine;
+    };
+
+    // Reads one record starting at `pos`; leaves `pos` at the start of the next one.
+    void readRecord(std::string_view text, std::size_t& pos, std::vector<Field>& fields, std::size_t line) {
+        fields.clear();
+        const std::size_t n = text.size();
+
+        while (true) {
+            Field field;
+            if (pos < n && text[pos] == '"') {
+                field.quoted = true;
+                std::size_t start = ++pos;
+                while (true) {
+                    std::size_t quote = text.find('"', pos);
+                    if (quote == std::string_view::npos) {
+                        throw std::runtime_error("Line " + std::to_string(line) + ": unterminated quoted field");
+                    }
+                    if (quote + 1 < n && text[quote + 1] == '"') {
+                        field.escaped = true;
+                        pos = quote + 2;
+                        continue;
+                    }
+                    field.text = text.substr(start, quote - start);
+                    pos = quote + 1;
+                    break;
+                }
+            } else {
+                std::size_t start = pos;
+                while (pos < n && text[pos] != ',' && text[pos] != '\n' && text[pos] != '\r') pos++;
+                field.text = text.substr(start, pos - start);
+            }
+            fields.push_back(field);
+
+            if (pos < n && text[pos] == ',') {
+                pos++;
+                continue;
+            }
+            if (pos < n && text[pos] == '\r') pos++;
+            if (pos < n && text[pos] == '\n') pos++;
+            return;
+        }
+    }
+
+    std::string unescape(const Field& field) {
+        if (!field.escaped) return std::string(field.text);
+        std::string result;
+        result.reserve(field.text.size());
+        for (std::size_t i = 0; i < field.text.size(); i++) {
+            result += field.text[i];
+            if (field.text[i] == '"') i++;
+        }
+        return result;
+    }
+
+    // Cuts the body into about `parts` pieces that start on record boundaries (newlines outside quotes).
+    std::vector<Chunk> splitRecords(std::string_view text, std::size_t begin, std::size_t firstLine, std::size_t parts) {
+        std::vector<Chunk> chunks;
+        const std::size_t target = std::max(minChunkSize, (text.size() - begin) / parts + 1);
+
+        bool inQuotes = false;
+        std::size_t line = firstLine;
+        Chunk current{begin, begin, firstLine};
+        for (std::size_t i = begin; i < text.size(); i++) {
+            const char c = text[i];
+            if (c == '"') {
+                inQuotes = !inQuotes;
+            } else if (c == '\n' && !inQuotes) {
+                line++;
+                if (i + 1 - current.begin >= target) {
+                    current.end = i + 1;
+                    chunks.push_back(current);
+                    current = {i + 1, i + 1, line};
+                }
+            }
+        }
+        if (current.begin < text.size()) {
+            current.end = text.size();
+            chunks.push_back(current);
+        }
+        return chunks;
+    }
+
+}
+
+void appendCsvField(std::string &out, const Value &value, DataType type) {
+    if (type == DataType::DOUBLE) {
+        char digits[32];
+        auto [end, ec] = std::to_chars(digits, digits + sizeof(digits), value.numValue);
+        out.append(digits, end);
+        return;
+    }
+    // Empty strings are quoted so that they do not read back as "use the default".
+    const bool needsQuotes = value.strValue.empty() ||
+                             value.strValue.find_first_of(",\"\r\n") != std::string::npos;
+    if (!needsQuotes) {
+        out += value.strValue;
+        return;
+    }
+    out += '"';
+    for (char c : value.strValue) {
+        if (c == '"') out += '"';
+        out += c;
+    }
+    out += '"';
+}
+
+std::vector<Row> parseCsvRecords(std::string_view text, const std::vector<Column> &columns,
+                                 const std::vector<int> &fieldColumns, std::size_t firstLine) {
+    Value defaultMarker;
+    defaultMarker.strValue = "__INTERNAL_DEFAULT__";
+
+    std::vector<Row> rows;
+    rows.reserve(text.size() / (fieldColumns.size() * 8 + 1));
+    std::vector<Field> fields;
+    std::size_t pos = 0;
+    std::size_t line = firstLine;
+
+    while (pos < text.size()) {
+        if (text[pos] == '\n' || text[pos] == '\r') {
+            pos++;
+            line += text[pos - 1] == '\n';
+            continue;
+        }
+        readRecord(text, pos, fields, line);
+        if (fields.size() != fieldColumns.size()) {
+            throw std::runtime_error("Line " + std::to_string(line) + ": expected " +
+                                     std::to_string(fieldColumns.size()) + " fields, got " + std::to_string(fields.size()));
+        }
+
+        Row row;
+        row.values.assign(columns.size(), defaultMarker);
+        for (std::size_t f = 0; f < fields.size(); f++) {
+            const Field& field = fields[f];
+            if (field.text.empty() && !field.quoted) continue;
+
+            const Column& col = columns[fieldColumns[f]];
+            Value& value = row.values[fieldColumns[f]];
+            if (col.type == DataType::DOUBLE) {
+                double number;
+                auto [end, ec] = std::from_chars(field.text.data(), field.text.data() + field.text.size(), number);
+                if (ec != std::errc() || end != field.text.data() + field.text.size()) {
+                    throw std::runtime_error("Line " + std::to_string(line) + ": invalid number '" +
+                                             std::string(field.text) + "' for column " + col.name);
+                }
+                value = Value(number);
+            } else {
+                value = Value(unescape(field), col.type);
+            }
+        }
+        rows.push_back(std::move(row));
+        line++;
+    }
+    return rows;
+}
+
+std::vector<Row> readCsv(const Table &table, const std::string &path) {
+    MappedFile file(path);
+    std::string_view text = file.view();
+
+    std::size_t pos = 0;
+    std::vector<Field> header;
+    while (pos < text.size() && (text[pos] == '\n' || text[pos] == '\r')) pos++;
+    if (pos >= text.size()) throw std::runtime_error(path + " has no header line");
+    readRecord(text, pos, header, 1);
+
+    const auto& columns = table.getColumns();
+    std::vector<int> fieldColumns;
+    for (const auto& field : header) {
+        int colIdx = table.getColumnIndex(unescape(field));
+        if (colIdx == -1) throw std::runtime_error("Unknown column in CSV header: " + unescape(field));
+        if (std::ranges::find(fieldColumns, colIdx) != fieldColumns.end()) {
+            throw std::runtime_error("Duplicate column in CSV header: " + unescape(field));
+        }
+        fieldColumns.push_back(colIdx);
+    }
+
+    const std::size_t workers = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<Chunk> chunks = splitRecords(text, pos, 2, workers);
+
+    std::vector<std::vector<Row>> parsed(chunks.size());
+    std::vector<std::exception_ptr> errors(chunks.size());
+    std::vector<std::thread> threads;
+    for (std::size_t c = 0; c < chunks.size(); c++) {
+        threads.emplace_back([&, c] {
+            try {
+                const Chunk& chunk = chunks[c];
+                parsed[c] = parseCsvRecords(text.substr(chunk.begin, chunk.end - chunk.begin), columns,
+                                            fieldColumns, chunk.firstLine);
+            } catch (...) {
+                errors[c] = std::current_exception();
+            }
+        });
+    }
+    for (auto& thread : threads) thread.join();
+    for (const auto& error : errors) {
+        if (error) std::rethrow_exception(error);
+    }
+
+    // One batch for the whole file, so a duplicate key anywhere rejects the import as a unit.
+    std::vector<Row> batch;
+    for (auto& rows : parsed) {
+        if (batch.empty()) batch = std::move(rows);
+        else std::ranges::move(rows, std::back_inserter(batch));
+    }
+    return batch;
+}
+
+std::size_t importCsv(Table &table, const std::string &path) {
+    std::vector<Row> batch = readCsv(table, path);
+    const std::size_t imported = batch.size();
+    table.appendRows(std::move(batch));
+    return imported;
+}
+
+std::size_t exportCsv(const Table &table, const std::string &path) {
+    std::ofstream file(path, std::ios::binary);
+    if (!file.is_open()) throw std::runtime_error("Could not open " + path);
+
+    const auto& columns = table.getColumns();
+    std::string buffer;
+    buffer.reserve(exportBufferSize + 4096);
+
+    for (std::size_t i = 0; i < columns.size(); i++) {
+        if (i > 0) buffer += ',';
+        appendCsvField(buffer, Value(columns[i].name), DataType::STRING);
+    }
+    buffer += '\n';
+
+    // A partitioned table is written partition by partition.
+    std::vector<const Table*> sources = {&table};
+    for (const auto& partition : table.getPartitions()) sources.push_back(&partition);
+    for (const Table* source : sources) {
+        for (const auto& row : source->getRows()) {
+            for (std::size_t i = 0; i < columns.size(); i++) {
+                if (i > 0) buffer += ',';
+                appendCsvField(buffer, row.values[i], columns[i].type);
+            }
+            buffer += '\n';
+
+            if (buffer.size() >= exportBufferSize) {
+                file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+                buffer.clear();
+            }
+        }
+    }
+    file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    if (!file) throw std::runtime_error("Could not write " + path);
+    return table.getRowCount();
+}
\ No newline at end of file
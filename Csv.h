@@ -0,0 +1,21 @@
+#ifndef PROEKT_CSV_H
+#define PROEKT_CSV_H
+
+#include <string_view>
+#include "Table.h"
+
+// CSV bulk transfer. The first record names the columns; a field left empty takes the column's
+// default (or next auto-increment value), while a quoted empty field is an empty string.
+
+// Parses the records of `text` into rows shaped like `columns`; field i is stored in column fieldColumns[i].
+std::vector<Row> parseCsvRecords(std::string_view text, const std::vector<Column>& columns,
+                                 const std::vector<int>& fieldColumns, std::size_t firstLine);
+
+void appendCsvField(std::string& out, const Value& value, DataType type);
+
+// Reads the rows of a CSV file shaped like `table`, without appending them.
+std::vector<Row> readCsv(const Table& table, const std::string& path);
+std::size_t importCsv(Table& table, const std::string& path);
+std::size_t exportCsv(const Table& table, const std::string& path);
+
+#endif //PROEKT_CSV_H
\ No newline at end of file
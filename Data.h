@@ -1,5 +1,7 @@
 #ifndef PROEKT_DATA_H
 #define PROEKT_DATA_H
+#include <cstdint>
+#include <memory_resource>
 #include <string>
 #include <utility>
 #include <vector>
@@ -62,6 +64,12 @@ struct Value {
     bool operator>=(const Value& other) const { return !(*this < other); }
 };
 
+// Heap bytes behind a string; short strings are stored inside the object and cost none.
+inline std::size_t stringHeapBytes(const std::string& text) {
+    static const std::size_t inlineCapacity = std::string().capacity();
+    return text.capacity() > inlineCapacity ? text.capacity() + 1 : 0;
+}
+
 struct Column {
     std::string name;
     DataType type;
@@ -70,17 +78,35 @@ struct Column {
     bool autoIncrement;
     bool indexed;
     bool uniqueIndex;
+    bool bloomFilter; // per-block Bloom filters for equality scans
+    bool trigramIndex; // a TrigramIndex for LIKE patterns
+    std::vector<std::string> include; // INCLUDE columns stored in the index, making it covering
 
-    Column() : type(DataType::DOUBLE), hasDefault(false), autoIncrement(false), indexed(false), uniqueIndex(false) {}
+    Column() : type(DataType::DOUBLE), hasDefault(false), autoIncrement(false), indexed(false), uniqueIndex(false), bloomFilter(false), trigramIndex(false) {}
     Column(std::string  name, const DataType type, const bool indexed = false, const bool uniqueIndex = false)
-        : name(std::move(name)), type(type), hasDefault(false), autoIncrement(false), indexed(indexed), uniqueIndex(uniqueIndex) {}
+        : name(std::move(name)), type(type), hasDefault(false), autoIncrement(false), indexed(indexed), uniqueIndex(uniqueIndex), bloomFilter(false), trigramIndex(false) {}
 };
 
+// Finalizer of splitmix64: spreads the bits of a std::hash result for sketches and filters.
+inline uint64_t mixHash(uint64_t x) {
+    x ^= x >> 30; x *= 0xBF58476D1CE4E5B9;
+    x ^= x >> 27; x *= 0x94D049BB133111EB;
+    return x ^ (x >> 31);
+}
+
+// Rows stored in a Table draw their value arrays from the table's pool (see Table::rowMemory);
+// rows anywhere else use the default heap. Copies always land on the default heap.
 struct Row {
-    std::vector<Value> values;
+    std::pmr::vector<Value> values;
 
     Row() = default;
-    Row(const std::vector<Value>& values) : values(values) {}
+    explicit Row(std::pmr::memory_resource* memory) : values(memory) {}
+    Row(const Row& other) = default;
+    Row(Row&& other) noexcept = default;
+    Row(const Row& other, std::pmr::memory_resource* memory) : values(other.values, memory) {}
+    Row(const std::vector<Value>& values) : values(values.begin(), values.end()) {}
+    Row& operator=(const Row& other) = default;
+    Row& operator=(Row&& other) = default;
 
     bool operator==(const Row& other) const {
         return values == other.values;
@@ -1,11 +1,50 @@
 #include "Database.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <thread>
+#include "Csv.h"
+#include "Storage.h"
+
+// Unversioned files may end with sections after the last table: u32 tag, u32 length, payload.
+// Unknown tags are skipped.
+constexpr uint32_t statisticsSectionTag = 0x54415453; // "STAT"
+
+namespace {
+    // The normalized text of a SELECT with its bound values, the key of its cached result.
+    std::string resultKey(const std::string& tableName, const std::vector<std::string>& columnNames,
+                          const Expression* where, const std::string& orderByColumn, bool isDistinct) {
+        std::string key = isDistinct ? "SELECT DISTINCT" : "SELECT";
+        for (const auto& column : columnNames) {
+            key += ' ';
+            key += column;
+        }
+        key += " FROM ";
+        key += tableName;
+        if (where) {
+            key += " WHERE ";
+            where->appendKey(key);
+        }
+        if (!orderByColumn.empty()) {
+            key += " ORDER BY ";
+            key += orderByColumn;
+        }
+        return key;
+    }
+}
 
-void Database::createTable(const std::string &tableName, const std::vector<Column> &columnNames) {
+void Database::createTable(const std::string &tableName, const std::vector<Column> &columnNames,
+                           const PartitionScheme &partitioning) {
     if (tables.contains(tableName)) {
         throw std::runtime_error("Table " + tableName + " already exists");
     }
-    tables[tableName] = Table(tableName, columnNames);
-    saveToDisk();
+    Table table(tableName, columnNames, partitioning);
+    touch(tableName);
+    tables[tableName] = std::move(table);
+    ++schemaVersion;
+    persist();
     std::cout << "Table " << tableName << " created" << std::endl;
 }
 
@@ -13,8 +52,17 @@ void Database::dropTable(const std::string &tableName) {
     if (!tables.contains(tableName)) {
         throw std::runtime_error("Table " + tableName + " does not exists");
     }
+    touch(tableName);
+    if (activeTransaction != 0) {
+        // Kept to be put back by a rollback; a table the transaction created has nothing to put back.
+        TableUndo& undo = transactions.at(activeTransaction).undo.at(tableName);
+        if (!undo.created && !undo.dropped) undo.dropped = std::move(openTable(tableName));
+    }
     tables.erase(tableName);
-    saveToDisk();
+    coldTables.erase(tableName);
+    tableMemoryLimits.erase(tableName);
+    ++schemaVersion;
+    persist();
     std::cout << "Table " << tableName << " deleted" << std::endl;
 }
 
@@ -32,10 +80,7 @@ void Database::listTables() const {
 }
 
 void Database::tableInfo(const std::string &tableName) {
-    if (!tables.contains(tableName)) {
-        throw std::runtime_error("Table " + tableName + " does not exists");
-    }
-    const auto &table = tables[tableName];
+    const auto &table = visibleTable(tableName);
     std::cout << "Table " << tableName << " : (";
 
     std::vector<Column> columns = table.getColumns();
@@ -43,204 +88,292 @@ void Database::tableInfo(const std::string &tableName) {
         std::cout << table.getColumns()[i].name << ":" << dataTypeToString(table.getColumns()[i].type);
         if (table.getColumns()[i].indexed) {
             std::cout << ", " << (table.getColumns()[i].uniqueIndex ? "Unique " : "") << "Indexed";
+            const auto& include = table.getColumns()[i].include;
+            for (std::size_t j = 0; j < include.size(); j++) {
+                std::cout << (j == 0 ? " INCLUDE (" : ", ") << include[j] << (j + 1 == include.size() ? ")" : "");
+            }
+        }
+        if (table.getColumns()[i].bloomFilter) {
+            std::cout << ", Bloom";
+        }
+        if (table.getColumns()[i].trigramIndex) {
+            std::cout << ", Trigram";
         }
         if (i < table.getColumns().size() - 1) std::cout << "; ";
     }
     std::cout << ")" << std::endl;
-    std::cout << "Total " << table.getRows().size() << " rows ("
-             << table.getDataSize() / 1024.0 << " KB data) in the table" << std::endl;
+    const MemoryUsage usage = table.getMemoryUsage();
+    std::cout << "Total " << table.getRowCount() << " rows (" << formatBytes(usage.total()) << " in memory: "
+              << formatBytes(usage.rowBytes) << " rows, " << formatBytes(usage.stringBytes) << " strings, "
+              << formatBytes(usage.indexBytes) << " indexes, " << formatBytes(usage.summaryBytes)
+              << " zone maps) in the table" << std::endl;
+    for (const auto& column : table.getColumns()) {
+        if (!column.indexed) continue;
+        // A partitioned table's index is made of one tree per partition.
+        std::size_t indexBytes = table.getIndex(column.name) ? table.getIndex(column.name)->memoryUsage() : 0;
+        for (const auto& partition : table.getPartitions()) indexBytes += partition.getIndex(column.name)->memoryUsage();
+        std::cout << "Index on " << column.name << ": " << formatBytes(indexBytes) << std::endl;
+    }
+    if (table.isPartitioned()) {
+        const PartitionScheme& scheme = table.getPartitioning();
+        std::cout << "Partitioned by " << (scheme.kind == PartitionKind::RANGE ? "RANGE" : "HASH") << "(" << scheme.column
+                  << ") into " << table.getPartitions().size() << " partitions:" << std::endl;
+        for (std::size_t p = 0; p < table.getPartitions().size(); p++) {
+            const Table& partition = table.getPartitions()[p];
+            std::cout << "  p" << p << " (" << scheme.describe(p) << "): " << partition.getRowCount() << " rows, "
+                      << formatBytes(partition.getMemoryUsage().total()) << (partition.getStatistics() ? ", analyzed" : "")
+                      << std::endl;
+        }
+    }
+
+    if (const TableStats* stats = table.getStatistics()) {
+        std::cout << "Statistics (" << stats->rowCount << " rows analyzed):" << std::endl;
+        for (const auto& column : table.getColumns()) {
+            const ColumnStats& columnStats = stats->columns.at(column.name);
+            std::cout << "  " << column.name << ": ~" << columnStats.distinctCount << " distinct";
+            if (columnStats.distinctCount > 0) {
+                std::cout << ", min " << columnStats.min.toString() << ", max " << columnStats.max.toString();
+            }
+            std::cout << std::endl;
+        }
+    }
 }
 
-void Database::insert(const std::string &tableName, std::vector<Row> &rows) {
+void Database::analyze(const std::string &tableName) {
     if (!tables.contains(tableName)) {
         throw std::runtime_error("Table " + tableName + " does not exists");
     }
-    Table &table = tables[tableName];
-    for (auto &row : rows) {
-        if (row.values.size() > table.getColumns().size()) {
-            throw std::runtime_error("Column size mismatch");
+    touch(tableName);
+    Table &table = openTable(tableName);
+    if (table.isPartitioned()) {
+        // The planner plans every partition by itself, so each gets its own statistics.
+        for (std::size_t p = 0; p < table.getPartitions().size(); p++) {
+            table.setPartitionStatistics(p, analyzeTable(table.getPartitions()[p]));
         }
-        table.insertRow(row);
+    } else {
+        table.setStatistics(analyzeTable(table));
     }
-    saveToDisk();
-    std::cout << (rows.size() == 1 ? "1 row" : std::to_string(rows.size()) + " rows")
-         << " inserted." << std::endl;
+    persist();
+    std::cout << "Table " << tableName << " analyzed (" << table.getRowCount() << " rows)." << std::endl;
 }
 
-void Database::remove(const std::string &tableName, std::unique_ptr<Expression> whereExpr) {
+void Database::insert(const std::string &tableName, std::vector<Row> &rows) {
     if (!tables.contains(tableName)) {
         throw std::runtime_error("Table " + tableName + " does not exists");
     }
-    Table &table = tables[tableName];
-    int removedRows = 0;
-    for (int i = table.getRows().size() - 1; i >= 0; i--) {
-        if (!whereExpr || whereExpr->evaluate(table.getRows()[i], table)) {
-            table.removeRow(i);
-            ++removedRows;
+    touch(tableName);
+    Table &table = openTable(tableName);
+    for (const auto &row : rows) {
+        if (row.values.size() > table.getColumns().size()) {
+            throw std::runtime_error("Column size mismatch");
         }
     }
-    saveToDisk();
+    reserveMemory(tableName, table, table.estimateAppendBytes(rows));
+    const std::size_t inserted = rows.size();
+    table.appendRows(std::move(rows));
+    persist();
+    std::cout << (inserted == 1 ? "1 row" : std::to_string(inserted) + " rows")
+         << " inserted." << std::endl;
+}
+
+void Database::remove(const std::string &tableName, const std::unique_ptr<Expression> &whereExpr) {
+    QueryPlan plan = runRemove(tableName, whereExpr.get());
+    std::size_t removedRows = plan.find("Delete")->rowsOut;
     std::cout << removedRows << " row" << (removedRows == 1 ? "" : "s") << " removed." << std::endl;
 }
 
-void Database::select(const std::string& tableName, const std::vector<std::string>& columnNames,
-                      const std::unique_ptr<Expression>& whereExpression, const std::string& orderByColumn,
-                      bool isDistinct) {
+QueryPlan Database::runRemove(const std::string &tableName, Expression *whereExpr) {
     if (!tables.contains(tableName)) {
         throw std::runtime_error("Table " + tableName + " does not exists");
     }
-    const Table &table = tables[tableName];
-
-    std::vector<int> columnsToDisplay;
-    if (columnNames.size() == 1 && columnNames[0] == "*") {
-        for (std::size_t i = 0; i < table.getColumns().size(); i++) {
-            columnsToDisplay.push_back(i);
+    touch(tableName);
+    Table &table = openTable(tableName);
+    QueryPlan plan = planRemove(table, whereExpr);
+    if (table.isPartitioned()) {
+        const auto matches = findPartitionMatches(table, whereExpr, plan);
+        OperatorStats* erase = plan.find("Delete");
+        OperatorTimer timer(erase);
+        for (std::size_t i = 0; i < matches.size(); i++) {
+            table.removePartitionRows(plan.partitions[i], matches[i]);
+            erase->rowsIn += matches[i].size();
         }
+        erase->rowsOut = erase->rowsIn;
     } else {
-        for (const auto& name : columnNames) {
-            int idx = table.getColumnIndex(name);
-            if (idx != -1) columnsToDisplay.push_back(idx);
-        }
-    }
-
-    std::vector<Row> filteredRows;
-    for (const Row &row : table.getRows()) {
-        if (!whereExpression || whereExpression->evaluate(row, table)) {
-            filteredRows.push_back(row);
-        }
+        std::vector<std::size_t> matches = findMatchingRows(table, whereExpr, plan);
+        OperatorStats* erase = plan.find("Delete");
+        OperatorTimer timer(erase);
+        table.removeRows(matches);
+        erase->rowsIn = erase->rowsOut = matches.size();
     }
+    persist();
+    return plan;
+}
 
-    if (!orderByColumn.empty()) {
-        int sortColIdx = table.getColumnIndex(orderByColumn);
-        if (sortColIdx != -1) {
-            std::ranges::sort(filteredRows, [sortColIdx](const Row& a, const Row& b) {
-                return a.values[sortColIdx] < b.values[sortColIdx];
-            });
-        }
-    }
+QueryPlan Database::explainRemove(const std::string &tableName, const std::unique_ptr<Expression> &whereExpr,
+                                  bool analyze) {
+    if (!analyze) return planRemove(visibleTable(tableName), whereExpr.get());
+    // Like EXPLAIN ANALYZE elsewhere, the statement really runs so the counters are real.
+    QueryPlan plan = runRemove(tableName, whereExpr.get());
+    plan.analyzed = true;
+    return plan;
+}
 
-    std::vector<Row> results;
-    std::set<Row> seenRows;
-    for (const auto& row : filteredRows) {
-        Row projection;
-        for (int colIdx : columnsToDisplay) {
-            projection.values.push_back(row.values[colIdx]);
-        }
+void Database::update(const std::string &tableName, const std::vector<Assignment> &assignments,
+                      const std::unique_ptr<Expression> &whereExpr) {
+    QueryPlan plan = runUpdate(tableName, assignments, whereExpr.get());
+    std::size_t updatedRows = plan.find("Update")->rowsOut;
+    std::cout << updatedRows << " row" << (updatedRows == 1 ? "" : "s") << " updated." << std::endl;
+}
 
-        if (isDistinct) {
-            if (seenRows.insert(projection).second) {
-                results.push_back(projection);
-            }
-        } else {
-            results.push_back(projection);
-        }
+QueryPlan Database::runUpdate(const std::string &tableName, const std::vector<Assignment> &assignments,
+                              Expression *whereExpr) {
+    if (!tables.contains(tableName)) {
+        throw std::runtime_error("Table " + tableName + " does not exists");
     }
-
-    for (size_t i = 0; i < columnsToDisplay.size(); i++) {
-        std::cout << "|" << table.getColumns()[columnsToDisplay[i]].name;
+    touch(tableName);
+    Table &table = openTable(tableName);
+    QueryPlan plan = planUpdate(table, whereExpr, assignments);
+    if (table.isPartitioned()) {
+        const auto matches = findPartitionMatches(table, whereExpr, plan);
+        OperatorStats* modify = plan.find("Update");
+        OperatorTimer timer(modify);
+        table.updatePartitionRows(plan.partitions, matches, assignments);
+        for (const auto& ids : matches) modify->rowsIn += ids.size();
+        modify->rowsOut = modify->rowsIn;
+    } else {
+        std::vector<std::size_t> matches = findMatchingRows(table, whereExpr, plan);
+        OperatorStats* modify = plan.find("Update");
+        OperatorTimer timer(modify);
+        table.updateRows(matches, assignments);
+        modify->rowsIn = modify->rowsOut = matches.size();
     }
-    std::cout << "|" << std::endl;
+    persist();
+    return plan;
+}
 
-    for (size_t i = 0; i < columnsToDisplay.size(); i++) {
-        for (size_t j = 0; j < table.getColumns()[columnsToDisplay[i]].name.length() + 1; j++) {
-            std::cout << "-";
-        }
-    }
-    std::cout << std::endl;
+QueryPlan Database::explainUpdate(const std::string &tableName, const std::vector<Assignment> &assignments,
+                                  const std::unique_ptr<Expression> &whereExpr, bool analyze) {
+    if (!analyze) return planUpdate(visibleTable(tableName), whereExpr.get(), assignments);
+    QueryPlan plan = runUpdate(tableName, assignments, whereExpr.get());
+    plan.analyzed = true;
+    return plan;
+}
 
-    for (const auto& row : results) {
-        for (size_t i = 0; i < row.values.size(); i++) {
-            std::cout << "|" << std::setw(table.getColumns()[columnsToDisplay[i]].name.length())
-                 << row.values[i].toString();
-        }
-        std::cout << "|" << std::endl;
+void Database::addPartition(const std::string &tableName, const Value &bound) {
+    if (!tables.contains(tableName)) {
+        throw std::runtime_error("Table " + tableName + " does not exists");
     }
-
-    std::cout << "Total " << results.size() << " row"
-         << (results.size() == 1 ? "" : "s") << " selected" << std::endl;
+    touch(tableName);
+    Table &table = openTable(tableName);
+    table.addPartition(bound);
+    persist();
+    std::cout << "Table " << tableName << " split at " << bound.toString() << " (" << table.getPartitions().size()
+              << " partitions)" << std::endl;
 }
 
-uint64_t calculateChecksum(const std::vector<char>& data) {
-    uint64_t checksum = 0xFDDB0123456789AB;
-    for (char c : data) {
-        checksum = (checksum ^ static_cast<uint8_t>(c)) * 0xBF58476D1CE4E5B9;
+void Database::dropPartition(const std::string &tableName, const Value &key) {
+    if (!tables.contains(tableName)) {
+        throw std::runtime_error("Table " + tableName + " does not exists");
     }
-    return checksum;
+    touch(tableName);
+    Table &table = openTable(tableName);
+    const std::size_t dropped = table.dropPartition(key);
+    persist();
+    std::cout << "Partition dropped from " << tableName << " (" << dropped << " row" << (dropped == 1 ? "" : "s")
+              << " removed)" << std::endl;
 }
 
-void Database::saveToDisk() const {
-    std::ostringstream buffer(std::ios::binary);
-
-    uint32_t tableCount = tables.size();
-    buffer.write(reinterpret_cast<char*>(&tableCount), sizeof(tableCount));
-
-    for (const auto& t : tables) {
-        const Table& table = t.second;
-
-        uint32_t nameLen = table.getName().length();
-        buffer.write(reinterpret_cast<char*>(&nameLen), sizeof(nameLen));
-        buffer.write(table.getName().c_str(), nameLen);
-
-        uint32_t colCount = table.getColumns().size();
-        buffer.write(reinterpret_cast<char*>(&colCount), sizeof(colCount));
-
-        for (const auto& col : table.getColumns()) {
-            uint32_t colNameLen = col.name.length();
-            buffer.write(reinterpret_cast<char*>(&colNameLen), sizeof(colNameLen));
-            buffer.write(col.name.c_str(), colNameLen);
-
-            uint8_t type = static_cast<uint8_t>(col.type);
-            buffer.write(reinterpret_cast<char*>(&type), sizeof(type));
+void Database::importCsv(const std::string &tableName, const std::string &path) {
+    if (!tables.contains(tableName)) {
+        throw std::runtime_error("Table " + tableName + " does not exists");
+    }
+    touch(tableName);
+    Table &table = openTable(tableName);
+    std::vector<Row> rows = readCsv(table, path);
+    reserveMemory(tableName, table, table.estimateAppendBytes(rows));
+    const std::size_t imported = rows.size();
+    table.appendRows(std::move(rows));
+    persist();
+    std::cout << imported << " row" << (imported == 1 ? "" : "s") << " imported." << std::endl;
+}
 
-            uint8_t flags = (col.indexed ? 1 : 0) |
-                               (col.autoIncrement ? 2 : 0) |
-                               (col.uniqueIndex ? 4 : 0) |
-                               (col.hasDefault ? 8 : 0);
-            buffer.write(reinterpret_cast<char*>(&flags), sizeof(flags));
+void Database::exportCsv(const std::string &tableName, const std::string &path) {
+    std::size_t exported = ::exportCsv(visibleTable(tableName), path);
+    std::cout << exported << " row" << (exported == 1 ? "" : "s") << " exported." << std::endl;
+}
 
-            if (col.autoIncrement) {
-                uint32_t currentCounter = table.getAutoIncrementCounters()[col.name];
-                buffer.write(reinterpret_cast<char*>(&currentCounter), sizeof(currentCounter));
-            }
+ResultSet Database::select(const std::string& tableName, const std::vector<std::string>& columnNames,
+                           const std::unique_ptr<Expression>& whereExpression, const std::string& orderByColumn,
+                           bool isDistinct) const {
+    const Table &table = visibleTable(tableName);
+    std::string key;
+    if (resultCache.isEnabled()) {
+        key = resultKey(tableName, columnNames, whereExpression.get(), orderByColumn, isDistinct);
+        if (auto cached = resultCache.find(key, table.getVersion())) return *cached;
+    }
+    QueryPlan plan = planSelect(table, columnNames, whereExpression.get(), orderByColumn, isDistinct);
+    ResultSet result = executeSelect(table, columnNames, whereExpression.get(), orderByColumn, plan);
+    if (resultCache.isEnabled()) resultCache.put(key, table.getVersion(), result);
+    return result;
+}
 
-            if (col.hasDefault) {
-                if (col.type == DataType::DOUBLE) {
-                    buffer.write(reinterpret_cast<const char*>(&col.defaultValue.numValue), sizeof(double));
-                } else {
-                    uint32_t strLen = col.defaultValue.strValue.length();
-                    buffer.write(reinterpret_cast<char*>(&strLen), sizeof(strLen));
-                    buffer.write(col.defaultValue.strValue.c_str(), strLen);
-                }
-            }
-        }
+QueryPlan Database::explainSelect(const std::string &tableName, const std::vector<std::string> &columnNames,
+                                  const std::unique_ptr<Expression> &whereExpression,
+                                  const std::string &orderByColumn, bool isDistinct, bool analyze) const {
+    const Table &table = visibleTable(tableName);
+    QueryPlan plan = planSelect(table, columnNames, whereExpression.get(), orderByColumn, isDistinct);
+    if (analyze) {
+        executeSelect(table, columnNames, whereExpression.get(), orderByColumn, plan);
+        plan.analyzed = true;
+    }
+    return plan;
+}
 
-        uint32_t rowCount = table.getRows().size();
-        buffer.write(reinterpret_cast<char*>(&rowCount), sizeof(rowCount));
+void Database::saveToDisk() {
+    // Only committed state goes to disk: tables an open transaction is writing are saved as they were before it.
+    // nullptr stands for a locked table whose file still holds its committed state.
+    std::map<std::string, Table*> committed;
+    for (auto& [tableName, table] : tables) {
+        if (!tableLocks.contains(tableName)) committed[tableName] = &table;
+    }
+    for (const auto& [tableName, owner] : tableLocks) {
+        const TableUndo& undo = transactions.at(owner).undo.at(tableName);
+        if (undo.created) continue;
+        const Table& written = undo.dropped ? *undo.dropped : tables.at(tableName);
+        committed[tableName] = written.isCommittedDirty() ? &committedTable(tableName, undo) : nullptr;
+    }
 
-        for (const auto& row : table.getRows()) {
-            for (size_t i = 0; i < row.values.size(); i++) {
-                const Value& val = row.values[i];
-                if (table.getColumns()[i].type == DataType::DOUBLE) {
-                    buffer.write(reinterpret_cast<const char*>(&val.numValue), sizeof(val.numValue));
-                } else {
-                    uint32_t strLen = val.strValue.length();
-                    buffer.write(reinterpret_cast<char*>(&strLen), sizeof(strLen));
-                    buffer.write(val.strValue.c_str(), strLen);
-                }
-            }
+    // Table files first, then the catalog that points at them, then files nothing points at any
+    // more: a crash at any step leaves the previous catalog with every file it names.
+    bool catalogChanged = catalogStale || !std::filesystem::exists(dbPath);
+    for (auto& [tableName, table] : committed) {
+        if (coldTables.contains(tableName)) continue;
+        auto file = catalog.tableFiles.find(tableName);
+        if (!table || (file != catalog.tableFiles.end() && !table->isDirty())) continue;
+        if (file == catalog.tableFiles.end()) {
+            file = catalog.tableFiles.emplace(tableName, catalog.nextFileId++).first;
+            catalogChanged = true;
         }
+        std::filesystem::create_directories(dbPath + ".tables");
+        writeFileAtomically(tableFilePath(file->second), encodeTableFile(*table));
+        table->markClean();
     }
 
-    std::string serializedData = buffer.str();
-    std::vector dataVec(serializedData.begin(), serializedData.end());
-    uint64_t checksum = calculateChecksum(dataVec);
-
-    std::ofstream file(dbPath, std::ios::binary);
-    if (!file.is_open()) throw std::invalid_argument("Could not open file");
-
-    file.write(reinterpret_cast<char*>(&checksum), sizeof(checksum));
-    file.write(dataVec.data(), dataVec.size());
-    file.close();
+    std::vector<uint64_t> orphaned;
+    std::erase_if(catalog.tableFiles, [&](const auto& entry) {
+        if (committed.contains(entry.first)) return false;
+        orphaned.push_back(entry.second);
+        return true;
+    });
+    if (!orphaned.empty()) catalogChanged = true;
+
+    if (catalogChanged) {
+        writeFileAtomically(dbPath, encodeCatalog(catalog));
+        catalogStale = false;
+    }
+    for (uint64_t fileId : orphaned) {
+        std::filesystem::remove(tableFilePath(fileId));
+    }
 }
 
 void Database::loadFromDisk() {
@@ -254,14 +387,35 @@ void Database::loadFromDisk() {
 
     file.seekg(0, std::ios::beg);
 
-    uint64_t storedChecksum;
-    file.read(reinterpret_cast<char*>(&storedChecksum), sizeof(storedChecksum));
-
-    std::vector<char> data(static_cast<size_t>(size) - sizeof(uint64_t));
-    file.read(data.data(), data.size());
+    std::vector<char> fileData(static_cast<size_t>(size));
+    file.read(fileData.data(), fileData.size());
     file.close();
 
-    if (calculateChecksum(data) != storedChecksum) {
+    if (isVersionedFile(fileData)) {
+        DatabaseFile databaseFile = decodeDatabaseFile(fileData);
+        if (databaseFile.singleFile) {
+            // Version 2: everything is in memory already; the next save splits it into table files.
+            tables = std::move(databaseFile.tables);
+            catalogStale = true;
+            return;
+        }
+        // Tables stay on disk until a statement first needs them (see openTable).
+        catalog = std::move(databaseFile.catalog);
+        for (const auto& tableName : catalog.tableFiles | std::views::keys) {
+            tables[tableName];
+            coldTables.insert(tableName);
+        }
+        return;
+    }
+
+    // Unversioned file: checksum, then the tables row by row with fixed-width fields.
+    // Like version 2 it is loaded whole and rewritten in the current layout by the next save.
+    catalogStale = true;
+    uint64_t storedChecksum;
+    std::memcpy(&storedChecksum, fileData.data(), sizeof(storedChecksum));
+    std::vector<char> data(fileData.begin() + sizeof(uint64_t), fileData.end());
+
+    if (calculateChecksum(data.data(), data.size()) != storedChecksum) {
         throw std::runtime_error("Database file is corrupted or invalid (Checksum mismatch)!");
     }
 
@@ -299,6 +453,7 @@ void Database::loadFromDisk() {
             col.autoIncrement = (flags & 2) != 0;
             col.uniqueIndex = (flags & 4) != 0;
             col.hasDefault = (flags & 8) != 0;
+            col.bloomFilter = (flags & 16) != 0;
 
             if (col.autoIncrement) {
                 uint32_t savedCounter;
@@ -332,8 +487,8 @@ void Database::loadFromDisk() {
         uint32_t rowCount;
         buffer.read(reinterpret_cast<char*>(&rowCount), sizeof(rowCount));
 
-        for (uint32_t r = 0; r < rowCount; r++) {
-            Row row;
+        std::vector<Row> rows(rowCount);
+        for (auto& row : rows) {
             for (const auto& col : columns) {
                 if (col.type == DataType::DOUBLE) {
                     double val;
@@ -347,11 +502,304 @@ void Database::loadFromDisk() {
                     row.values.emplace_back(str, col.type);
                 }
             }
-            table.insertRow(row);
+        }
+        table.appendRows(std::move(rows));
+    }
+
+    uint32_t tag;
+    uint32_t sectionLen;
+    while (buffer.read(reinterpret_cast<char*>(&tag), sizeof(tag)) &&
+           buffer.read(reinterpret_cast<char*>(&sectionLen), sizeof(sectionLen))) {
+        if (tag != statisticsSectionTag) {
+            buffer.seekg(sectionLen, std::ios::cur);
+            continue;
+        }
+        uint32_t analyzedCount;
+        buffer.read(reinterpret_cast<char*>(&analyzedCount), sizeof(analyzedCount));
+        for (uint32_t t = 0; t < analyzedCount; t++) {
+            uint32_t nameLen;
+            buffer.read(reinterpret_cast<char*>(&nameLen), sizeof(nameLen));
+            std::string tableName(nameLen, ' ');
+            buffer.read(&tableName[0], nameLen);
+            TableStats stats = readTableStats(buffer);
+            if (tables.contains(tableName)) tables[tableName].setStatistics(std::move(stats));
+        }
+    }
+}
+
+void Database::setMemoryLimit(std::size_t bytes) {
+    memoryLimit = bytes;
+    if (bytes == 0) std::cout << "Global memory limit removed" << std::endl;
+    else std::cout << "Global memory limit set to " << formatBytes(bytes) << std::endl;
+}
+
+void Database::setTableMemoryLimit(const std::string &tableName, std::size_t bytes) {
+    if (!tables.contains(tableName)) {
+        throw std::runtime_error("Table " + tableName + " does not exists");
+    }
+    if (bytes == 0) {
+        tableMemoryLimits.erase(tableName);
+        std::cout << "Memory limit of " << tableName << " removed" << std::endl;
+    } else {
+        tableMemoryLimits[tableName] = bytes;
+        std::cout << "Memory limit of " << tableName << " set to " << formatBytes(bytes) << std::endl;
+    }
+}
+
+MemoryUsage Database::getMemoryUsage() const {
+    MemoryUsage usage;
+    for (const auto& [tableName, table] : tables) {
+        if (!coldTables.contains(tableName)) usage += table.getMemoryUsage();
+    }
+    for (const auto& [id, transaction] : transactions) {
+        for (const auto& [tableName, undo] : transaction.undo) {
+            if (undo.dropped) usage += undo.dropped->getMemoryUsage();
+            if (undo.committedView) usage += undo.committedView->getMemoryUsage();
+        }
+    }
+    return usage;
+}
+
+void Database::setResultCacheBudget(std::size_t bytes) {
+    resultCache.setBudget(bytes);
+    if (bytes == 0) {
+        resultCache.clear();
+        std::cout << "Result cache disabled" << std::endl;
+    } else {
+        std::cout << "Result cache budget set to " << formatBytes(bytes) << std::endl;
+    }
+}
+
+const ResultCache &Database::getResultCache() const {
+    return resultCache;
+}
+
+void Database::stats() const {
+    std::cout << "Memory by table:" << std::endl;
+    for (const auto& [tableName, table] : tables) {
+        std::cout << "  " << tableName << ": ";
+        if (coldTables.contains(tableName)) {
+            std::cout << "not loaded" << std::endl;
+            continue;
+        }
+        const MemoryUsage usage = table.getMemoryUsage();
+        std::cout << table.getRowCount() << " rows, " << formatBytes(usage.total()) << " ("
+                  << formatBytes(usage.rowBytes) << " rows, " << formatBytes(usage.stringBytes) << " strings, "
+                  << formatBytes(usage.indexBytes) << " indexes, " << formatBytes(usage.summaryBytes) << " zone maps";
+        if (usage.undoBytes) std::cout << ", " << formatBytes(usage.undoBytes) << " undo log";
+        std::cout << ")";
+        auto limit = tableMemoryLimits.find(tableName);
+        if (limit != tableMemoryLimits.end()) std::cout << ", limit " << formatBytes(limit->second);
+        std::cout << std::endl;
+    }
+    std::cout << "Total " << formatBytes(getMemoryUsage().total()) << " in memory";
+    if (memoryLimit) std::cout << ", limit " << formatBytes(memoryLimit);
+    std::cout << std::endl;
+    if (resultCache.isEnabled()) {
+        std::cout << "Result cache: " << resultCache.size() << " results, " << formatBytes(resultCache.getBytes())
+                  << " of " << formatBytes(resultCache.getBudget()) << ", " << resultCache.getHits() << " hits, "
+                  << resultCache.getMisses() << " misses" << std::endl;
+    }
+}
+
+void Database::reserveMemory(const std::string &tableName, const Table &table, std::size_t incomingBytes) const {
+    // Tables keep their byte counts as they change, so each sum below only adds up per-table totals.
+    auto limit = tableMemoryLimits.find(tableName);
+    if (limit != tableMemoryLimits.end()) {
+        const std::size_t used = table.getMemoryUsage().total();
+        if (used + incomingBytes > limit->second) {
+            throw std::runtime_error("Memory limit of " + tableName + " (" + formatBytes(limit->second) + ") would be exceeded: " +
+                                     formatBytes(used) + " used, about " + formatBytes(incomingBytes) + " more needed");
+        }
+    }
+    if (memoryLimit) {
+        const std::size_t used = getMemoryUsage().total();
+        if (used + incomingBytes > memoryLimit) {
+            throw std::runtime_error("Global memory limit (" + formatBytes(memoryLimit) + ") would be exceeded: " +
+                                     formatBytes(used) + " used, about " + formatBytes(incomingBytes) + " more needed");
         }
     }
 }
 
 Table &Database::getTable(const std::string &tableName) {
-    return tables[tableName];
+    if (!tables.contains(tableName)) return tables[tableName];
+    return openTable(tableName);
+}
+
+bool Database::hasTable(const std::string &tableName) const {
+    return tables.contains(tableName);
+}
+
+uint64_t Database::getSchemaVersion() const {
+    return schemaVersion;
+}
+
+void Database::touch(const std::string &tableName) {
+    auto lock = tableLocks.find(tableName);
+    if (activeTransaction == 0) {
+        if (lock != tableLocks.end()) {
+            throw std::runtime_error("Table " + tableName + " is locked by an open transaction");
+        }
+        return;
+    }
+    if (lock != tableLocks.end()) {
+        if (lock->second != activeTransaction) {
+            throw std::runtime_error("Table " + tableName + " is locked by another transaction");
+        }
+        return;
+    }
+
+    // Nothing is copied: from here on the table logs what each write overwrites.
+    TableUndo& undo = transactions[activeTransaction].undo[tableName];
+    if (tables.contains(tableName)) {
+        openTable(tableName).beginUndoLog();
+    } else {
+        undo.created = true;
+    }
+    tableLocks[tableName] = activeTransaction;
+}
+
+void Database::persist() {
+    if (activeTransaction != 0) return;
+    flushPending = true;
+    if (!groupCommit) flush();
+}
+
+const Table &Database::visibleTable(const std::string &tableName) const {
+    // Other sessions keep reading the committed image of a table while a transaction is writing it.
+    auto lock = tableLocks.find(tableName);
+    if (lock != tableLocks.end() && lock->second != activeTransaction) {
+        return committedTable(tableName, transactions.at(lock->second).undo.at(tableName));
+    }
+    if (!tables.contains(tableName)) throw std::runtime_error("Table " + tableName + " does not exists");
+    return openTable(tableName);
+}
+
+Table &Database::committedTable(const std::string &tableName, const TableUndo &undo) const {
+    if (undo.created) throw std::runtime_error("Table " + tableName + " does not exists");
+    const Table& written = undo.dropped ? *undo.dropped : tables.at(tableName);
+    if (!undo.committedView || undo.viewVersion != written.getVersion()) {
+        undo.committedView = written.committedImage();
+        undo.viewVersion = written.getVersion();
+    }
+    return *undo.committedView;
+}
+
+Table &Database::openTable(const std::string &tableName) const {
+    Table& table = tables.at(tableName);
+    if (coldTables.contains(tableName)) {
+        // A file that fails to decode leaves the table cold, so the bad file is never overwritten.
+        table = decodeTableFile(readFile(tableFilePath(catalog.tableFiles.at(tableName))));
+        coldTables.erase(tableName);
+    }
+    return table;
+}
+
+LoadReport Database::preloadTables(std::size_t threads) {
+    const auto start = std::chrono::steady_clock::now();
+    const std::vector<std::string> names(coldTables.begin(), coldTables.end());
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    threads = std::max<std::size_t>(1, std::min(threads, names.size()));
+
+    // Table files are independent: workers take the next unread one until none are left.
+    std::vector<std::optional<Table>> loaded(names.size());
+    std::vector<std::exception_ptr> errors(names.size());
+    std::vector<LoadReport> workerReports(threads);
+    std::atomic<std::size_t> next{0};
+    auto work = [&](LoadReport& report) {
+        for (std::size_t i = next++; i < names.size(); i = next++) {
+            try {
+                const auto readStart = std::chrono::steady_clock::now();
+                const std::vector<char> data = readFile(tableFilePath(catalog.tableFiles.at(names[i])));
+                report.readSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - readStart).count();
+                loaded[i] = decodeTableFile(data, &report);
+            } catch (...) {
+                errors[i] = std::current_exception();
+            }
+        }
+    };
+    std::vector<std::thread> workers;
+    for (std::size_t w = 1; w < threads; w++) workers.emplace_back(work, std::ref(workerReports[w]));
+    work(workerReports[0]);
+    for (auto& worker : workers) worker.join();
+
+    LoadReport report;
+    report.threads = threads;
+    for (const auto& workerReport : workerReports) report += workerReport;
+    for (std::size_t i = 0; i < names.size(); i++) {
+        if (!loaded[i]) continue;
+        report.tables++;
+        report.rows += loaded[i]->getRowCount();
+        tables.at(names[i]) = std::move(*loaded[i]);
+        coldTables.erase(names[i]);
+    }
+    report.wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    char timing[160];
+    std::snprintf(timing, sizeof(timing), "in %.3f s on %zu thread%s (read %.3f s, decode %.3f s, index %.3f s)",
+                  report.wallSeconds, report.threads, report.threads == 1 ? "" : "s", report.readSeconds,
+                  report.decodeSeconds, report.indexSeconds);
+    std::cout << "Loaded " << report.tables << " table" << (report.tables == 1 ? "" : "s") << " (" << report.rows
+              << " rows) " << timing << std::endl;
+    for (const auto& error : errors) {
+        if (error) std::rethrow_exception(error);
+    }
+    return report;
+}
+
+std::string Database::tableFilePath(uint64_t fileId) const {
+    return dbPath + ".tables/" + std::to_string(fileId) + ".tbl";
+}
+
+TransactionId Database::beginTransaction() {
+    TransactionId id = nextTransactionId++;
+    transactions[id];
+    return id;
+}
+
+void Database::commitTransaction(TransactionId id) {
+    auto txn = transactions.find(id);
+    if (txn == transactions.end()) throw std::runtime_error("No transaction in progress");
+
+    for (const auto& [tableName, undo] : txn->second.undo) {
+        auto table = tables.find(tableName);
+        if (table != tables.end()) table->second.commitUndoLog();
+        tableLocks.erase(tableName);
+    }
+    transactions.erase(txn);
+
+    flushPending = true;
+    if (!groupCommit) flush();
+}
+
+void Database::rollbackTransaction(TransactionId id) {
+    auto txn = transactions.find(id);
+    if (txn == transactions.end()) throw std::runtime_error("No transaction in progress");
+
+    for (auto& [tableName, undo] : txn->second.undo) {
+        if (undo.created) {
+            tables.erase(tableName);
+        } else {
+            if (undo.dropped) tables[tableName] = std::move(*undo.dropped);
+            tables.at(tableName).rollbackUndoLog();
+        }
+        tableLocks.erase(tableName);
+    }
+    transactions.erase(txn);
+    ++schemaVersion;
+}
+
+void Database::setActiveTransaction(TransactionId id) {
+    activeTransaction = id;
+}
+
+void Database::setGroupCommit(bool enabled) {
+    groupCommit = enabled;
+    if (!groupCommit) flush();
+}
+
+void Database::flush() {
+    if (!flushPending) return;
+    saveToDisk();
+    flushPending = false;
 }
\ No newline at end of file
@@ -3,18 +3,66 @@
 #include <algorithm>
 #include <ranges>
 #include <iostream>
-#include <iomanip>
 #include <fstream>
+#include <optional>
 #include <set>
 #include <sstream>
 #include "Expression.h"
+#include "Planner.h"
+#include "ResultCache.h"
+#include "ResultSet.h"
+#include "Storage.h"
+
+using TransactionId = uint64_t;
 
 class Database {
-    std::map<std::string, Table> tables;
+    // A table a transaction has written. The table itself keeps the undo log of the changes
+    // (see Table::beginUndoLog); this holds what the log cannot.
+    struct TableUndo {
+        bool created = false;         // the transaction created the table
+        std::optional<Table> dropped; // the table the transaction dropped, undo log and all
+        // The committed state other sessions read, built from the log on their first read and
+        // again once the table has changed since.
+        mutable std::optional<Table> committedView;
+        mutable uint64_t viewVersion = 0;
+    };
+    struct Transaction {
+        std::map<std::string, TableUndo> undo;
+    };
+
+    // Tables named in `coldTables` are empty placeholders for tables still only on disk;
+    // openTable reads them on first use, which is also why both are mutable.
+    mutable std::map<std::string, Table> tables;
+    mutable std::set<std::string> coldTables;
+    Catalog catalog;          // file id of every table saved so far
+    bool catalogStale = false; // the file at dbPath is not the current catalog
     std::string dbPath;
+    uint64_t schemaVersion = 0;
+
+    std::map<TransactionId, Transaction> transactions;
+    std::map<std::string, TransactionId> tableLocks; // table name -> transaction writing it
+    TransactionId activeTransaction = 0;
+    TransactionId nextTransactionId = 1;
+    bool groupCommit = false;
+    bool flushPending = false;
 
-    void saveToDisk() const;
+    // Memory limits in bytes, 0 for none. Inserts and imports that would go over are rejected.
+    std::size_t memoryLimit = 0;
+    std::map<std::string, std::size_t> tableMemoryLimits;
+    mutable ResultCache resultCache; // off until given a budget
+
+    // Writes only the tables changed since they were read or last written, each to its own file.
+    void saveToDisk();
     void loadFromDisk();
+    Table& openTable(const std::string& tableName) const;
+    std::string tableFilePath(uint64_t fileId) const;
+    void touch(const std::string& tableName);
+    void persist();
+    const Table& visibleTable(const std::string& tableName) const;
+    Table& committedTable(const std::string& tableName, const TableUndo& undo) const;
+    void reserveMemory(const std::string& tableName, const Table& table, std::size_t incomingBytes) const;
+    QueryPlan runRemove(const std::string& tableName, Expression* whereExpr);
+    QueryPlan runUpdate(const std::string& tableName, const std::vector<Assignment>& assignments, Expression* whereExpr);
 
 public:
     Database(const std::string& dbPath = "fmisql.db") : dbPath(dbPath) {
@@ -24,14 +72,52 @@ public:
         saveToDisk();
     }
 
-    void createTable(const std::string& tableName, const std::vector<Column>& columnNames);
+    void createTable(const std::string& tableName, const std::vector<Column>& columnNames, const PartitionScheme& partitioning = {});
     void dropTable(const std::string& tableName);
     void listTables() const;
     void tableInfo(const std::string& tableName);
-    void select(const std::string& tableName, const std::vector<std::string>& columnNames, const std::unique_ptr<Expression>& whereExpression, const std::string& orderByColumn, bool isDistinct);
+    void analyze(const std::string& tableName);
+    ResultSet select(const std::string& tableName, const std::vector<std::string>& columnNames, const std::unique_ptr<Expression>& whereExpression, const std::string& orderByColumn, bool isDistinct) const;
     void insert(const std::string& tableName, std::vector<Row>& rows);
-    void remove(const std::string& tableName, std::unique_ptr<Expression> whereExpr);
+    void remove(const std::string& tableName, const std::unique_ptr<Expression>& whereExpr);
+    void update(const std::string& tableName, const std::vector<Assignment>& assignments, const std::unique_ptr<Expression>& whereExpr);
+    // EXPLAIN: the plan the statement would run. With `analyze` the statement is executed
+    // (a REMOVE really deletes) and every operator carries its measured counters.
+    QueryPlan explainSelect(const std::string& tableName, const std::vector<std::string>& columnNames, const std::unique_ptr<Expression>& whereExpression, const std::string& orderByColumn, bool isDistinct, bool analyze) const;
+    QueryPlan explainRemove(const std::string& tableName, const std::unique_ptr<Expression>& whereExpr, bool analyze);
+    QueryPlan explainUpdate(const std::string& tableName, const std::vector<Assignment>& assignments,
+                            const std::unique_ptr<Expression>& whereExpr, bool analyze);
+    // ADDPARTITION / DROPPARTITION on a RANGE partitioned table (see Table::addPartition and dropPartition).
+    void addPartition(const std::string& tableName, const Value& bound);
+    void dropPartition(const std::string& tableName, const Value& key);
+    void importCsv(const std::string& tableName, const std::string& path);
+    void exportCsv(const std::string& tableName, const std::string& path);
+    // SETLIMIT and STATS. Usage counts every loaded table and the undo logs of open transactions;
+    // tables not read from disk yet take no memory.
+    void setMemoryLimit(std::size_t bytes);
+    void setTableMemoryLimit(const std::string& tableName, std::size_t bytes);
+    MemoryUsage getMemoryUsage() const;
+    // SETCACHE: the byte budget of the SELECT result cache, 0 to turn it off.
+    void setResultCacheBudget(std::size_t bytes);
+    const ResultCache& getResultCache() const;
+    void stats() const;
     Table& getTable(const std::string& tableName);
+    bool hasTable(const std::string& tableName) const;
+    uint64_t getSchemaVersion() const;
+    // Reads every table still only on disk now instead of on first use, `threads` table files at
+    // a time (0 for one per hardware thread), and prints how long each phase took. A table whose
+    // file fails to load stays on disk; the first such error is rethrown after the others are in.
+    LoadReport preloadTables(std::size_t threads = 0);
+
+    TransactionId beginTransaction();
+    void commitTransaction(TransactionId id);
+    void rollbackTransaction(TransactionId id);
+    void setActiveTransaction(TransactionId id);
+
+    // With group commit on, commits only mark the database dirty and the owner calls flush()
+    // once for a whole batch of statements.
+    void setGroupCommit(bool enabled);
+    void flush();
 };
 
 #endif //PROEKT_DATABASE_H
\ No newline at end of file
@@ -1,29 +1,107 @@
 #ifndef PROEKT_EXPRESSION_H
 #define PROEKT_EXPRESSION_H
 
+#include <algorithm>
+#include <charconv>
 #include <memory>
 #include <utility>
+#include "Pattern.h"
 #include "Table.h"
 
+// Values for the `?` placeholders of a prepared statement, filled in right before it runs.
+struct Parameters {
+    std::vector<Value> values;
+    std::vector<DataType> types;
+    uint64_t generation = 0; // bumped by every bind, so expressions can tell stale derived data
+
+    std::size_t add(const DataType type) {
+        types.push_back(type);
+        values.push_back(type == DataType::DOUBLE ? Value(0.0) : Value("", type));
+        return types.size() - 1;
+    }
+};
+
+// A literal, or a `?` placeholder read from the statement's parameters whenever it is used.
+class Operand {
+    Value value;
+    const Parameters* parameters = nullptr;
+    std::size_t parameterIndex = 0;
+
+public:
+    Operand(Value value) : value(std::move(value)) {}
+    Operand(const Parameters* parameters, const std::size_t parameterIndex) : parameters(parameters), parameterIndex(parameterIndex) {}
+
+    const Value& get() const {
+        return parameters ? parameters->values[parameterIndex] : value;
+    }
+    bool isPlaceholder() const { return parameters != nullptr; }
+};
+
+// Exact rendering of a value for Expression::appendKey: doubles round-trip, strings are length-prefixed.
+inline void appendValueKey(std::string& key, const Value& value) {
+    if (value.type == DataType::DOUBLE) {
+        char digits[32];
+        auto [end, ec] = std::to_chars(digits, digits + sizeof(digits), value.numValue);
+        key += 'n';
+        key.append(digits, end);
+    } else {
+        key += value.type == DataType::DATE ? 'd' : 's';
+        key += std::to_string(value.strValue.size());
+        key += ':';
+        key += value.strValue;
+    }
+}
+
+// Whether a block's zone map leaves room for a value equal to `value` (see Value::epsilon).
+inline bool blockMayEqual(const BlockSummary& block, std::size_t colIndex, const Value& value) {
+    if (!block.blooms[colIndex].mayContain(value)) return false;
+    const Value& min = block.min[colIndex];
+    const Value& max = block.max[colIndex];
+    // Mixed-type comparisons do not follow the column's ordering, so the bounds say nothing.
+    if (block.mixedTypes[colIndex] || (min.type == DataType::DOUBLE) != (value.type == DataType::DOUBLE)) return true;
+    if (value.type == DataType::DOUBLE) {
+        return min.numValue < value.numValue + Value::epsilon && value.numValue - Value::epsilon < max.numValue;
+    }
+    return !(value < min) && !(max < value);
+}
+
 class Expression {
 public:
     virtual ~Expression() = default;
     virtual bool evaluate(const Row& row, const Table& table) const = 0;
+    virtual std::string toString() const = 0;
+    // Appends an exact, unambiguous rendering (doubles round-trip, strings are length-prefixed)
+    // used to key cached results; toString rounds for display.
+    virtual void appendKey(std::string& key) const = 0;
+    // Appends the names of the columns the expression reads.
+    virtual void collectColumns(std::vector<std::string>& columns) const = 0;
+    // False only when no row of the block can satisfy the expression.
+    virtual bool mayMatchBlock(const Table&, std::size_t) const { return true; }
 };
 
 class ComparisonExpression : public Expression {
     std::string colName;
     std::string op;
-    Value value;
+    Operand value;
 
 public:
-    ComparisonExpression(std::string  colName, std::string  op, Value  value) : colName(std::move(colName)), op(std::move(op)), value(std::move(value)) {}
+    ComparisonExpression(std::string  colName, std::string  op, Operand  value) : colName(std::move(colName)), op(std::move(op)), value(std::move(value)) {}
+    ComparisonExpression(std::string  colName, std::string  op, const Parameters* parameters, const std::size_t parameterIndex)
+        : colName(std::move(colName)), op(std::move(op)), value(parameters, parameterIndex) {}
+
+    const Value& operand() const {
+        return value.get();
+    }
+    const std::string& getColumnName() const { return colName; }
+    const std::string& getOperator() const { return op; }
+
     bool evaluate(const Row& row, const Table& table) const override {
         const int colIndex = table.getColumnIndex(colName);
         if (colIndex == -1) {
             return false;
         }
         const Value& rowValue = row.values[colIndex];
+        const Value& value = operand();
 
         if (op == "=") return rowValue == value;
         if (op == "!=") return rowValue != value;
@@ -34,6 +112,210 @@ public:
 
         return false;
     }
+
+    std::string toString() const override {
+        return colName + " " + op + " " + operand().toString();
+    }
+
+    void appendKey(std::string& key) const override {
+        key += colName;
+        key += op;
+        appendValueKey(key, operand());
+    }
+
+    void collectColumns(std::vector<std::string>& columns) const override {
+        columns.push_back(colName);
+    }
+
+    bool mayMatchBlock(const Table& table, std::size_t blockIdx) const override {
+        const int colIndex = table.getColumnIndex(colName);
+        if (colIndex == -1) return false;
+
+        const BlockSummary& block = table.getBlock(blockIdx);
+        const Value& value = operand();
+        if (op == "=") return blockMayEqual(block, colIndex, value);
+
+        const Value& min = block.min[colIndex];
+        const Value& max = block.max[colIndex];
+        // Mixed-type comparisons do not follow the column's ordering, so the bounds say nothing.
+        if (block.mixedTypes[colIndex] || (min.type == DataType::DOUBLE) != (value.type == DataType::DOUBLE)) return true;
+
+        if (value.type == DataType::DOUBLE && op == "!=") {
+            // Double equality is tolerant (see Value::epsilon).
+            return !(value.numValue - Value::epsilon < min.numValue && max.numValue < value.numValue + Value::epsilon);
+        }
+        if (op == "!=") return !(min == value && max == value);
+        if (op == "<") return min < value;
+        if (op == "<=") return !(value < min);
+        if (op == ">") return value < max;
+        if (op == ">=") return !(max < value);
+        return true;
+    }
+};
+
+// col IN (v1, v2, ...). The values are kept sorted so a row is matched by binary search; a list
+// with placeholders is re-sorted the first time it is used after the parameters are rebound.
+class InExpression : public Expression {
+    std::string colName;
+    std::vector<Operand> items;
+    mutable std::vector<Value> sorted; // the items' values, ascending, without exact duplicates
+    mutable bool sortedValid = false;
+    mutable uint64_t sortedGeneration = 0;
+    const Parameters* parameters = nullptr; // set when any item is a placeholder
+
+public:
+    InExpression(std::string colName, std::vector<Operand> items, const Parameters* parameters = nullptr)
+        : colName(std::move(colName)), items(std::move(items)), parameters(parameters) {}
+
+    const std::string& getColumnName() const { return colName; }
+
+    const std::vector<Value>& values() const {
+        if (sortedValid && (!parameters || sortedGeneration == parameters->generation)) return sorted;
+        sorted.clear();
+        for (const auto& item : items) sorted.push_back(item.get());
+        std::ranges::sort(sorted);
+        const auto duplicates = std::ranges::unique(sorted, [](const Value& a, const Value& b) { return !(a < b) && !(b < a); });
+        sorted.erase(duplicates.begin(), duplicates.end());
+        sortedValid = true;
+        if (parameters) sortedGeneration = parameters->generation;
+        return sorted;
+    }
+
+    bool evaluate(const Row& row, const Table& table) const override {
+        const int colIndex = table.getColumnIndex(colName);
+        if (colIndex == -1) return false;
+        const Value& rowValue = row.values[colIndex];
+        const std::vector<Value>& list = values();
+        if (list.empty() || (rowValue.type == DataType::DOUBLE) != (list.front().type == DataType::DOUBLE)) return false;
+
+        if (rowValue.type == DataType::DOUBLE) {
+            // Double equality is tolerant (see Value::epsilon): look for a value inside the window.
+            auto it = std::ranges::upper_bound(list, rowValue.numValue - Value::epsilon, {}, &Value::numValue);
+            return it != list.end() && it->numValue < rowValue.numValue + Value::epsilon;
+        }
+        return std::ranges::binary_search(list, rowValue);
+    }
+
+    std::string toString() const override {
+        std::string text = colName + " IN (";
+        for (const auto& value : values()) text += (&value == &values().front() ? "" : ", ") + value.toString();
+        return text + ")";
+    }
+
+    void appendKey(std::string& key) const override {
+        key += colName;
+        key += "IN(";
+        for (const auto& value : values()) {
+            appendValueKey(key, value);
+            key += ',';
+        }
+        key += ')';
+    }
+
+    void collectColumns(std::vector<std::string>& columns) const override {
+        columns.push_back(colName);
+    }
+
+    bool mayMatchBlock(const Table& table, std::size_t blockIdx) const override {
+        const int colIndex = table.getColumnIndex(colName);
+        if (colIndex == -1) return false;
+        const BlockSummary& block = table.getBlock(blockIdx);
+        return std::ranges::any_of(values(), [&](const Value& value) { return blockMayEqual(block, colIndex, value); });
+    }
+};
+
+// col BETWEEN low AND high, both ends included: the same as col >= low AND col <= high.
+class BetweenExpression : public Expression {
+    std::string colName;
+    Operand low;
+    Operand high;
+
+public:
+    BetweenExpression(std::string colName, Operand low, Operand high)
+        : colName(std::move(colName)), low(std::move(low)), high(std::move(high)) {}
+
+    const std::string& getColumnName() const { return colName; }
+    const Value& lowValue() const { return low.get(); }
+    const Value& highValue() const { return high.get(); }
+
+    bool evaluate(const Row& row, const Table& table) const override {
+        const int colIndex = table.getColumnIndex(colName);
+        if (colIndex == -1) return false;
+        const Value& rowValue = row.values[colIndex];
+        return rowValue >= low.get() && rowValue <= high.get();
+    }
+
+    std::string toString() const override {
+        return colName + " BETWEEN " + low.get().toString() + " AND " + high.get().toString();
+    }
+
+    void appendKey(std::string& key) const override {
+        key += colName;
+        key += "BETWEEN";
+        appendValueKey(key, low.get());
+        key += ',';
+        appendValueKey(key, high.get());
+    }
+
+    void collectColumns(std::vector<std::string>& columns) const override {
+        columns.push_back(colName);
+    }
+
+    bool mayMatchBlock(const Table& table, std::size_t blockIdx) const override {
+        const int colIndex = table.getColumnIndex(colName);
+        if (colIndex == -1) return false;
+        const BlockSummary& block = table.getBlock(blockIdx);
+        const Value& min = block.min[colIndex];
+        const Value& max = block.max[colIndex];
+        const Value& lowValue = low.get();
+        // Mixed-type comparisons do not follow the column's ordering, so the bounds say nothing.
+        if (block.mixedTypes[colIndex] || (min.type == DataType::DOUBLE) != (lowValue.type == DataType::DOUBLE)) return true;
+        return !(max < lowValue) && !(high.get() < min);
+    }
+};
+
+// col LIKE pattern, on String and Date columns (see likeMatch); numbers never match.
+class LikeExpression : public Expression {
+    std::string colName;
+    Operand pattern;
+
+public:
+    LikeExpression(std::string colName, Operand pattern) : colName(std::move(colName)), pattern(std::move(pattern)) {}
+
+    const std::string& getColumnName() const { return colName; }
+    const std::string& getPattern() const { return pattern.get().strValue; }
+
+    bool evaluate(const Row& row, const Table& table) const override {
+        const int colIndex = table.getColumnIndex(colName);
+        if (colIndex == -1) return false;
+        const Value& rowValue = row.values[colIndex];
+        return rowValue.type != DataType::DOUBLE && likeMatch(rowValue.strValue, getPattern());
+    }
+
+    std::string toString() const override {
+        return colName + " LIKE " + pattern.get().toString();
+    }
+
+    void appendKey(std::string& key) const override {
+        key += colName;
+        key += "LIKE";
+        appendValueKey(key, pattern.get());
+    }
+
+    void collectColumns(std::vector<std::string>& columns) const override {
+        columns.push_back(colName);
+    }
+
+    bool mayMatchBlock(const Table& table, std::size_t blockIdx) const override {
+        const int colIndex = table.getColumnIndex(colName);
+        if (colIndex == -1) return false;
+        const BlockSummary& block = table.getBlock(blockIdx);
+        const std::string_view prefix = likePrefix(getPattern());
+        if (prefix.empty() || block.mixedTypes[colIndex] || block.min[colIndex].type == DataType::DOUBLE) return true;
+        // Every match starts with the prefix, so lies in [prefix, successor).
+        const std::optional<std::string> successor = prefixSuccessor(prefix);
+        return !(block.max[colIndex].strValue < prefix) && (!successor || block.min[colIndex].strValue < *successor);
+    }
 };
 
 class LogicalExpression : public Expression {
@@ -43,12 +325,47 @@ class LogicalExpression : public Expression {
 
 public:
     LogicalExpression(const std::string& op, std::unique_ptr<Expression> left, std::unique_ptr<Expression> right = nullptr) : op(op), left(std::move(left)), right(std::move(right)) {}
+    const std::string& getOperator() const { return op; }
+    const Expression* getLeft() const { return left.get(); }
+    const Expression* getRight() const { return right.get(); }
+    // The planner reorders AND/OR operands in place; evaluation has no side effects, so order never changes a result.
+    std::unique_ptr<Expression>& leftOperand() { return left; }
+    std::unique_ptr<Expression>& rightOperand() { return right; }
+
     bool evaluate(const Row& row, const Table& table) const override {
         if (op == "NOT") return !left->evaluate(row, table);
         if (op == "AND") return left->evaluate(row, table) && right->evaluate(row, table);
         if (op == "OR") return left->evaluate(row, table) || right->evaluate(row, table);
         return false;
     }
+
+    bool mayMatchBlock(const Table& table, std::size_t blockIdx) const override {
+        if (op == "AND") return left->mayMatchBlock(table, blockIdx) && right->mayMatchBlock(table, blockIdx);
+        if (op == "OR") return left->mayMatchBlock(table, blockIdx) || right->mayMatchBlock(table, blockIdx);
+        return true;
+    }
+
+    void collectColumns(std::vector<std::string>& columns) const override {
+        left->collectColumns(columns);
+        if (right) right->collectColumns(columns);
+    }
+
+    void appendKey(std::string& key) const override {
+        key += '(';
+        key += op;
+        key += ' ';
+        left->appendKey(key);
+        if (right) {
+            key += ' ';
+            right->appendKey(key);
+        }
+        key += ')';
+    }
+
+    std::string toString() const override {
+        if (op == "NOT") return "NOT (" + left->toString() + ")";
+        return "(" + left->toString() + " " + op + " " + right->toString() + ")";
+    }
 };
 
 #endif //PROEKT_EXPRESSION_H
\ No newline at end of file
@@ -1,52 +1,125 @@
 #include "Index.h"
 
-void Index::insert(const Value &val, size_t rowIdx) {
-    if (isUnique) {
-        if (uniqueIndices.contains(val)) {
-            throw std::logic_error("Unique index already exists");
-        }
-        uniqueIndices[val] = rowIdx;
-    } else {
-        nonUniqueIndexes.insert({val, rowIdx});
+template class Index<double>;
+template class Index<std::string>;
+
+namespace {
+    bool isNumeric(const Value& val) {
+        return val.type == DataType::DOUBLE;
     }
 }
 
-void Index::remove(const Value &val, size_t rowIdx) {
-    if (isUnique) {
-        uniqueIndices.erase(val);
-    } else {
-        auto range = nonUniqueIndexes.equal_range(val);
-        for (auto it = range.first; it != range.second; ++it) {
-            if (it->second == rowIdx) {
-                nonUniqueIndexes.erase(it);
-                break;
-            }
-        }
+ColumnIndex::ColumnIndex(DataType type, bool isUnique, std::vector<std::size_t> included)
+    : tree(type == DataType::DOUBLE ? decltype(tree)(Index<double>(isUnique, included.size()))
+                                    : decltype(tree)(Index<std::string>(isUnique, included.size()))),
+      included(std::move(included)) {}
+
+std::vector<Value> ColumnIndex::payloadOf(const Row *row) const {
+    std::vector<Value> payload;
+    payload.reserve(included.size());
+    for (std::size_t colIdx : included) {
+        payload.push_back(row && colIdx < row->values.size() ? row->values[colIdx] : Value());
     }
+    return payload;
 }
 
-std::vector<size_t> Index::find(const Value &val) const {
-    std::vector<size_t> result;
+bool ColumnIndex::accepts(const Value &val) const {
+    return isNumeric(val) == std::holds_alternative<Index<double>>(tree);
+}
 
-    if (isUnique) {
-        auto it = uniqueIndices.find(val);
-        if (it != uniqueIndices.end()) {
-            result.push_back(it->second);
-        }
-    } else {
-        auto range = nonUniqueIndexes.equal_range(val);
-        for (auto it = range.first; it != range.second; ++it) {
-            result.push_back(it->second);
+void ColumnIndex::insert(const Value &val, std::size_t rowIdx, const Row *row) {
+    if (!accepts(val)) return;
+    const std::vector<Value> payload = included.empty() ? std::vector<Value>() : payloadOf(row);
+    if (auto numbers = std::get_if<Index<double>>(&tree)) numbers->insert(val.numValue, rowIdx, payload.data());
+    else std::get<Index<std::string>>(tree).insert(val.strValue, rowIdx, payload.data());
+}
+
+void ColumnIndex::insertSorted(const std::vector<std::pair<const Value*, std::size_t>> &entries, const std::vector<Row> *rows) {
+    auto merge = [&](auto& index, auto key) {
+        std::vector<std::pair<decltype(key(*entries.front().first)), std::size_t>> keys;
+        std::vector<Value> payloads;
+        keys.reserve(entries.size());
+        payloads.reserve(entries.size() * included.size());
+        for (const auto& [val, rowIdx] : entries) {
+            if (!accepts(*val)) continue;
+            keys.emplace_back(key(*val), rowIdx);
+            for (std::size_t colIdx : included) {
+                payloads.push_back(rows && rowIdx < rows->size() ? (*rows)[rowIdx].values[colIdx] : Value());
+            }
         }
+        index.insertSorted(std::move(keys), payloads);
+    };
+    if (entries.empty()) return;
+    if (auto numbers = std::get_if<Index<double>>(&tree)) merge(*numbers, [](const Value& val) { return val.numValue; });
+    else merge(std::get<Index<std::string>>(tree), [](const Value& val) { return val.strValue; });
+}
+
+void ColumnIndex::remove(const Value &val, std::size_t rowIdx) {
+    if (!accepts(val)) return;
+    if (auto numbers = std::get_if<Index<double>>(&tree)) numbers->remove(val.numValue, rowIdx);
+    else std::get<Index<std::string>>(tree).remove(val.strValue, rowIdx);
+}
+
+void ColumnIndex::updateIncluded(const Value &val, std::size_t rowIdx, std::size_t column, const Value &value) {
+    const auto slot = std::ranges::find(included, column);
+    if (slot == included.end() || !accepts(val)) return;
+    const std::size_t position = slot - included.begin();
+    if (auto numbers = std::get_if<Index<double>>(&tree)) numbers->setPayload(val.numValue, rowIdx, position, value);
+    else std::get<Index<std::string>>(tree).setPayload(val.strValue, rowIdx, position, value);
+}
+
+std::vector<std::size_t> ColumnIndex::find(const Value &val) const {
+    if (!accepts(val)) return {};
+    if (auto numbers = std::get_if<Index<double>>(&tree)) return numbers->find(val.numValue);
+    return std::get<Index<std::string>>(tree).find(val.strValue);
+}
+
+std::vector<std::size_t> ColumnIndex::findRange(const Value *low, bool lowInclusive, const Value *high, bool highInclusive) const {
+    if ((low && !accepts(*low)) || (high && !accepts(*high))) return {};
+    if (auto numbers = std::get_if<Index<double>>(&tree)) {
+        return numbers->findRange(low ? &low->numValue : nullptr, lowInclusive, high ? &high->numValue : nullptr, highInclusive);
+    }
+    return std::get<Index<std::string>>(tree).findRange(low ? &low->strValue : nullptr, lowInclusive,
+                                                        high ? &high->strValue : nullptr, highInclusive);
+}
+
+void ColumnIndex::scanRange(const Value *low, bool lowInclusive, const Value *high, bool highInclusive, std::size_t keyColumn,
+                            Row &row, const std::function<void()> &visit) const {
+    if ((low && !accepts(*low)) || (high && !accepts(*high))) return;
+    auto unpack = [&](const Value* payload) {
+        for (std::size_t i = 0; i < included.size(); i++) row.values[included[i]] = payload[i];
+        visit();
+    };
+    Value& key = row.values[keyColumn];
+    if (auto numbers = std::get_if<Index<double>>(&tree)) {
+        key.type = DataType::DOUBLE;
+        numbers->scanRange(low ? &low->numValue : nullptr, lowInclusive, high ? &high->numValue : nullptr, highInclusive,
+                           [&](double number, std::size_t, const Value* payload) {
+                               key.numValue = number;
+                               unpack(payload);
+                           });
+        return;
     }
-    return result;
+    // String keys are assigned into the same Value, reusing its buffer.
+    std::get<Index<std::string>>(tree).scanRange(low ? &low->strValue : nullptr, lowInclusive, high ? &high->strValue : nullptr,
+                                                 highInclusive, [&](const std::string& text, std::size_t, const Value* payload) {
+                                                     key.strValue = text;
+                                                     unpack(payload);
+                                                 });
+}
+
+const std::vector<std::size_t> &ColumnIndex::getIncluded() const {
+    return included;
+}
+
+void ColumnIndex::clear() {
+    std::visit([](auto& index) { index.clear(); }, tree);
 }
 
-void Index::clear() {
-    uniqueIndices.clear();
-    nonUniqueIndexes.clear();
+bool ColumnIndex::getIsUnique() const {
+    return std::visit([](const auto& index) { return index.getIsUnique(); }, tree);
 }
 
-bool Index::getIsUnique() const {
-    return isUnique;
+std::size_t ColumnIndex::memoryUsage() const {
+    return std::visit([](const auto& index) { return index.memoryUsage(); }, tree);
 }
\ No newline at end of file
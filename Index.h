@@ -1,22 +1,435 @@
 #ifndef PROEKT_INDEX_H
 #define PROEKT_INDEX_H
-#include <map>
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <limits>
 #include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
 #include "Data.h"
 
+// B+tree from keys to row ids. Entries are ordered by (key, row), so equal keys of a non-unique
+// index sit next to each other in row order. Keys are compared with their own `<` only: doubles
+// are ordered exactly, with none of Value's epsilon.
+// Nodes are fixed arrays of a few cache lines held in two vectors and linked by position, so a
+// copy of the tree is a copy of the vectors and a range scan walks contiguous leaf arrays.
+// Removal does not merge underfull leaves; Table rebuilds its indexes when rows are compacted.
+// An index built with a payload width carries that many Values with every entry (the INCLUDE
+// columns of a covering index), kept in its leaf next to the key.
+template <typename Key>
 class Index {
-    std::map<Value, std::size_t> uniqueIndices; // value -> single row
-    std::multimap<Value, std::size_t> nonUniqueIndexes; //value -> multipleRows
+    static constexpr std::size_t nodeBytes = 256;
+    static constexpr uint32_t leafCapacity = std::max<std::size_t>(8, nodeBytes / sizeof(Key));
+    static constexpr uint32_t innerCapacity = leafCapacity; // children per inner node
+    static constexpr uint32_t none = std::numeric_limits<uint32_t>::max();
+    static constexpr std::size_t lastRow = std::numeric_limits<std::size_t>::max();
+
+    struct Leaf {
+        std::array<Key, leafCapacity> keys;
+        std::array<std::size_t, leafCapacity> rows;
+        std::vector<Value> payload; // payloadWidth values per entry, in entry order
+        uint32_t count = 0;
+        uint32_t next = none;
+        uint32_t prev = none;
+        uint32_t parent = none;
+    };
+
+    // keys[i]/rows[i] is the first entry under children[i + 1] when it was split off.
+    struct Inner {
+        std::array<Key, innerCapacity - 1> keys;
+        std::array<std::size_t, innerCapacity - 1> rows;
+        std::array<uint32_t, innerCapacity> children;
+        uint32_t count = 0;
+        uint32_t parent = none;
+        bool leafChildren = true;
+    };
+
+    struct Cursor {
+        uint32_t leaf;
+        uint32_t pos;
+    };
+
+    std::vector<Leaf> leaves;
+    std::vector<Inner> inners;
+    uint32_t root = none;
+    bool rootIsLeaf = true;
     bool isUnique;
+    std::size_t payloadWidth;
+    std::size_t keyBytes = 0;     // heap buffers of the stored keys, counted as they are stored
+    std::size_t payloadBytes = 0; // heap buffers of the payload values
+
+    static std::size_t heapBytes(const Key& key) {
+        if constexpr (std::is_same_v<Key, std::string>) return stringHeapBytes(key);
+        else return 0;
+    }
+
+    static bool entryLess(const Key& a, std::size_t rowA, const Key& b, std::size_t rowB) {
+        return a < b || (!(b < a) && rowA < rowB);
+    }
+
+    static bool sameKey(const Key& a, const Key& b) {
+        return !(a < b) && !(b < a);
+    }
+
+    void skipEmpty(Cursor& at) const {
+        while (at.leaf != none && at.pos == leaves[at.leaf].count) {
+            at = {leaves[at.leaf].next, 0};
+        }
+    }
+
+    uint32_t findLeaf(const Key& key, std::size_t row) const {
+        uint32_t node = root;
+        if (rootIsLeaf) return node;
+        while (true) {
+            const Inner& inner = inners[node];
+            uint32_t child = 0;
+            while (child + 1 < inner.count && !entryLess(key, row, inner.keys[child], inner.rows[child])) child++;
+            if (inner.leafChildren) return inner.children[child];
+            node = inner.children[child];
+        }
+    }
+
+    uint32_t positionInLeaf(const Leaf& leaf, const Key& key, std::size_t row) const {
+        uint32_t low = 0, high = leaf.count;
+        while (low < high) {
+            const uint32_t mid = (low + high) / 2;
+            if (entryLess(leaf.keys[mid], leaf.rows[mid], key, row)) low = mid + 1;
+            else high = mid;
+        }
+        return low;
+    }
+
+    // First entry not less than (key, row).
+    Cursor lowerBound(const Key& key, std::size_t row) const {
+        if (root == none) return {none, 0};
+        Cursor at{findLeaf(key, row), 0};
+        at.pos = positionInLeaf(leaves[at.leaf], key, row);
+        skipEmpty(at);
+        return at;
+    }
+
+    Cursor begin() const {
+        Cursor at{leaves.empty() ? none : 0u, 0};
+        if (root != none) {
+            // Leaf 0 is always the leftmost: splits only ever add leaves to the right.
+            skipEmpty(at);
+        }
+        return at;
+    }
+
+    bool holdsKey(Cursor at, const Key& key) const {
+        skipEmpty(at);
+        return at.leaf != none && sameKey(leaves[at.leaf].keys[at.pos], key);
+    }
+
+    bool keyBefore(Cursor at, const Key& key) const {
+        if (at.pos > 0) return sameKey(leaves[at.leaf].keys[at.pos - 1], key);
+        for (uint32_t leaf = leaves[at.leaf].prev; leaf != none; leaf = leaves[leaf].prev) {
+            if (leaves[leaf].count > 0) return sameKey(leaves[leaf].keys[leaves[leaf].count - 1], key);
+        }
+        return false;
+    }
+
+    void insertIntoParent(uint32_t left, bool leftIsLeaf, const Key& key, std::size_t row, uint32_t right) {
+        const uint32_t parent = leftIsLeaf ? leaves[left].parent : inners[left].parent;
+        if (parent == none) {
+            const uint32_t newRoot = static_cast<uint32_t>(inners.size());
+            Inner& top = inners.emplace_back();
+            top.leafChildren = leftIsLeaf;
+            top.children[0] = left;
+            top.children[1] = right;
+            top.keys[0] = key;
+            top.rows[0] = row;
+            top.count = 2;
+            keyBytes += heapBytes(top.keys[0]);
+            setParent(left, leftIsLeaf, newRoot);
+            setParent(right, leftIsLeaf, newRoot);
+            root = newRoot;
+            rootIsLeaf = false;
+            return;
+        }
+
+        Inner* node = &inners[parent];
+        const uint32_t slot = static_cast<uint32_t>(std::find(node->children.begin(), node->children.begin() + node->count, left) -
+                                                    node->children.begin()) + 1;
+        if (node->count < innerCapacity) {
+            std::move_backward(node->children.begin() + slot, node->children.begin() + node->count, node->children.begin() + node->count + 1);
+            std::move_backward(node->keys.begin() + slot - 1, node->keys.begin() + node->count - 1, node->keys.begin() + node->count);
+            std::move_backward(node->rows.begin() + slot - 1, node->rows.begin() + node->count - 1, node->rows.begin() + node->count);
+            node->children[slot] = right;
+            node->keys[slot - 1] = key;
+            node->rows[slot - 1] = row;
+            node->count++;
+            keyBytes += heapBytes(node->keys[slot - 1]);
+            setParent(right, leftIsLeaf, parent);
+            return;
+        }
+
+        // Full: lay out all children and separators, keep the first half here, move the rest to a
+        // new node and push the separator between the halves up.
+        std::vector<uint32_t> children(node->children.begin(), node->children.end());
+        std::vector<Key> keys(std::make_move_iterator(node->keys.begin()), std::make_move_iterator(node->keys.end()));
+        std::vector<std::size_t> rows(node->rows.begin(), node->rows.end());
+        children.insert(children.begin() + slot, right);
+        keys.insert(keys.begin() + slot - 1, key);
+        rows.insert(rows.begin() + slot - 1, row);
+
+        const uint32_t keep = (innerCapacity + 1) / 2;
+        const uint32_t sibling = static_cast<uint32_t>(inners.size());
+        inners.emplace_back();
+        node = &inners[parent];
+        Inner& split = inners[sibling];
+        split.leafChildren = node->leafChildren;
+        node->count = keep;
+        split.count = innerCapacity + 1 - keep;
+        for (uint32_t i = 0; i < keep; i++) node->children[i] = children[i];
+        for (uint32_t i = 0; i + 1 < keep; i++) {
+            node->keys[i] = std::move(keys[i]);
+            node->rows[i] = rows[i];
+        }
+        for (uint32_t i = 0; i < split.count; i++) {
+            split.children[i] = children[keep + i];
+            setParent(split.children[i], split.leafChildren, sibling);
+        }
+        for (uint32_t i = 0; i + 1 < split.count; i++) {
+            split.keys[i] = std::move(keys[keep + i]);
+            split.rows[i] = rows[keep + i];
+        }
+        if (slot < keep) setParent(right, leftIsLeaf, parent);
+        // The new separator stays on this level and the middle one moves up, where its copy is counted.
+        keyBytes += heapBytes(key);
+        keyBytes -= heapBytes(keys[keep - 1]);
+        insertIntoParent(parent, false, keys[keep - 1], rows[keep - 1], sibling);
+    }
+
+    // Payload arrays are allocated whole, so entries never reallocate them.
+    uint32_t newLeaf() {
+        const uint32_t leafIdx = static_cast<uint32_t>(leaves.size());
+        leaves.emplace_back().payload.reserve(leafCapacity * payloadWidth);
+        return leafIdx;
+    }
+
+    static std::size_t payloadHeapBytes(const Value* payload, std::size_t width) {
+        std::size_t bytes = 0;
+        for (std::size_t i = 0; i < width; i++) bytes += stringHeapBytes(payload[i].strValue);
+        return bytes;
+    }
+
+    void setParent(uint32_t node, bool isLeaf, uint32_t parent) {
+        if (isLeaf) leaves[node].parent = parent;
+        else inners[node].parent = parent;
+    }
+
+    // Inserts at `pos` of `leafIdx`, splitting when full; returns the leaf holding the new entry.
+    uint32_t insertAt(uint32_t leafIdx, uint32_t pos, Key key, std::size_t row, const Value* payload) {
+        Leaf* leaf = &leaves[leafIdx];
+        if (leaf->count < leafCapacity) {
+            std::move_backward(leaf->keys.begin() + pos, leaf->keys.begin() + leaf->count, leaf->keys.begin() + leaf->count + 1);
+            std::move_backward(leaf->rows.begin() + pos, leaf->rows.begin() + leaf->count, leaf->rows.begin() + leaf->count + 1);
+            leaf->keys[pos] = std::move(key);
+            leaf->rows[pos] = row;
+            leaf->count++;
+            keyBytes += heapBytes(leaf->keys[pos]);
+            if (payloadWidth > 0) {
+                leaf->payload.insert(leaf->payload.begin() + pos * payloadWidth, payload, payload + payloadWidth);
+                payloadBytes += payloadHeapBytes(payload, payloadWidth);
+            }
+            return leafIdx;
+        }
+
+        // Appending past the rightmost entry leaves this leaf full, so ascending loads pack densely.
+        const bool appending = pos == leaf->count && leaf->next == none;
+        const uint32_t keep = appending ? leafCapacity : leafCapacity / 2;
+        const uint32_t sibling = newLeaf();
+        leaf = &leaves[leafIdx];
+        Leaf& split = leaves[sibling];
+        split.count = leaf->count - keep;
+        std::move(leaf->keys.begin() + keep, leaf->keys.begin() + leaf->count, split.keys.begin());
+        std::copy(leaf->rows.begin() + keep, leaf->rows.begin() + leaf->count, split.rows.begin());
+        if (payloadWidth > 0) {
+            split.payload.assign(std::make_move_iterator(leaf->payload.begin() + keep * payloadWidth),
+                                 std::make_move_iterator(leaf->payload.end()));
+            leaf->payload.resize(keep * payloadWidth);
+        }
+        leaf->count = keep;
+        split.next = leaf->next;
+        split.prev = leafIdx;
+        split.parent = leaf->parent;
+        if (leaf->next != none) leaves[leaf->next].prev = sibling;
+        leaf->next = sibling;
+
+        const uint32_t target = pos <= keep && !appending ? leafIdx : sibling;
+        insertAt(target, target == leafIdx ? pos : pos - keep, std::move(key), row, payload);
+        insertIntoParent(leafIdx, true, leaves[sibling].keys[0], leaves[sibling].rows[0], sibling);
+        return target;
+    }
+
+    uint32_t insertEntry(Key key, std::size_t row, const Value* payload, uint32_t hint) {
+        if (root == none) {
+            root = newLeaf();
+            rootIsLeaf = true;
+        }
+
+        // A leaf is a safe target without a descent when the entry lies inside its current range,
+        // or past its first entry when it is the rightmost leaf.
+        uint32_t leafIdx = none;
+        if (hint != none && leaves[hint].count > 0) {
+            const Leaf& leaf = leaves[hint];
+            const bool afterFirst = !entryLess(key, row, leaf.keys[0], leaf.rows[0]);
+            const bool beforeLast = entryLess(key, row, leaf.keys[leaf.count - 1], leaf.rows[leaf.count - 1]);
+            if (afterFirst && (beforeLast || leaf.next == none)) leafIdx = hint;
+        }
+        if (leafIdx == none) leafIdx = findLeaf(key, row);
+
+        const uint32_t pos = positionInLeaf(leaves[leafIdx], key, row);
+        if (isUnique && (holdsKey({leafIdx, pos}, key) || keyBefore({leafIdx, pos}, key))) {
+            throw std::logic_error("Unique index already exists");
+        }
+        return insertAt(leafIdx, pos, std::move(key), row, payload);
+    }
+
+public:
+    explicit Index(const bool isUnique = false, std::size_t payloadWidth = 0) : isUnique(isUnique), payloadWidth(payloadWidth) {}
+
+    // `payload` points at payloadWidth values; it may be null when the width is 0.
+    void insert(const Key& key, std::size_t rowIdx, const Value* payload = nullptr) {
+        insertEntry(key, rowIdx, payload, none);
+    }
+
+    // Entries sorted by (key, row), with payloadWidth values per entry in `payloads`. Each insertion
+    // starts from the leaf of the previous one, so an ascending batch appends to the rightmost leaf
+    // without descending the tree.
+    void insertSorted(std::vector<std::pair<Key, std::size_t>>&& entries, const std::vector<Value>& payloads = {}) {
+        uint32_t hint = none;
+        for (std::size_t i = 0; i < entries.size(); i++) {
+            hint = insertEntry(std::move(entries[i].first), entries[i].second, payloads.data() + i * payloadWidth, hint);
+        }
+    }
+
+    // Overwrites value `slot` of the payload of entry (key, row), if there is such an entry.
+    void setPayload(const Key& key, std::size_t rowIdx, std::size_t slot, const Value& value) {
+        Cursor at = lowerBound(key, rowIdx);
+        if (at.leaf == none) return;
+        Leaf& leaf = leaves[at.leaf];
+        if (!sameKey(leaf.keys[at.pos], key) || leaf.rows[at.pos] != rowIdx) return;
+        Value& stored = leaf.payload[at.pos * payloadWidth + slot];
+        payloadBytes -= std::min(payloadBytes, stringHeapBytes(stored.strValue));
+        stored = value;
+        payloadBytes += stringHeapBytes(stored.strValue);
+    }
+
+    void remove(const Key& key, std::size_t rowIdx) {
+        Cursor at = lowerBound(key, rowIdx);
+        if (at.leaf == none) return;
+        Leaf& leaf = leaves[at.leaf];
+        if (!sameKey(leaf.keys[at.pos], key) || leaf.rows[at.pos] != rowIdx) return;
+        keyBytes -= std::min(keyBytes, heapBytes(leaf.keys[at.pos]));
+        std::move(leaf.keys.begin() + at.pos + 1, leaf.keys.begin() + leaf.count, leaf.keys.begin() + at.pos);
+        std::move(leaf.rows.begin() + at.pos + 1, leaf.rows.begin() + leaf.count, leaf.rows.begin() + at.pos);
+        if (payloadWidth > 0) {
+            const auto first = leaf.payload.begin() + at.pos * payloadWidth;
+            payloadBytes -= std::min(payloadBytes, payloadHeapBytes(&*first, payloadWidth));
+            leaf.payload.erase(first, first + payloadWidth);
+        }
+        leaf.count--;
+    }
+
+    std::vector<std::size_t> find(const Key& key) const {
+        std::vector<std::size_t> result;
+        for (Cursor at = lowerBound(key, 0); at.leaf != none; at = {leaves[at.leaf].next, 0}) {
+            const Leaf& leaf = leaves[at.leaf];
+            for (; at.pos < leaf.count; at.pos++) {
+                if (!sameKey(leaf.keys[at.pos], key)) return result;
+                result.push_back(leaf.rows[at.pos]);
+            }
+        }
+        return result;
+    }
+
+    // Calls visit(key, row, payload) for every entry whose key lies between the bounds, in key
+    // order; a null bound leaves that side open. `payload` points at the entry's payloadWidth values.
+    template <typename Visit>
+    void scanRange(const Key* low, bool lowInclusive, const Key* high, bool highInclusive, Visit&& visit) const {
+        if (low && high && (*high < *low || (!(*low < *high) && !(lowInclusive && highInclusive)))) {
+            return;
+        }
+        Cursor at = low ? lowerBound(*low, lowInclusive ? 0 : lastRow) : begin();
+        for (; at.leaf != none; at = {leaves[at.leaf].next, 0}) {
+            const Leaf& leaf = leaves[at.leaf];
+            for (; at.pos < leaf.count; at.pos++) {
+                if (high && (highInclusive ? *high < leaf.keys[at.pos] : !(leaf.keys[at.pos] < *high))) return;
+                visit(leaf.keys[at.pos], leaf.rows[at.pos], leaf.payload.data() + at.pos * payloadWidth);
+            }
+        }
+    }
+
+    // Rows whose key lies between the bounds, in key order; a null bound leaves that side open.
+    std::vector<std::size_t> findRange(const Key* low, bool lowInclusive, const Key* high, bool highInclusive) const {
+        std::vector<std::size_t> result;
+        scanRange(low, lowInclusive, high, highInclusive, [&](const Key&, std::size_t row, const Value*) { result.push_back(row); });
+        return result;
+    }
+
+    void clear() {
+        leaves.clear();
+        inners.clear();
+        root = none;
+        rootIsLeaf = true;
+        keyBytes = 0;
+        payloadBytes = 0;
+    }
+
+    // Bytes of the node arrays and payload arrays plus the heap buffers of string keys and payload values.
+    std::size_t memoryUsage() const {
+        return leaves.capacity() * sizeof(Leaf) + inners.capacity() * sizeof(Inner) + keyBytes +
+               leaves.size() * leafCapacity * payloadWidth * sizeof(Value) + payloadBytes;
+    }
+
+    bool getIsUnique() const {
+        return isUnique;
+    }
+};
+
+extern template class Index<double>;
+extern template class Index<std::string>;
+
+// The index of one table column, keyed by the column's type: numbers in an Index<double>, strings
+// and dates (which compare as text) in an Index<std::string>. A value of the other kind is not
+// indexed and never found: it compares neither equal nor ordered to any key of the column's kind.
+// A covering index also stores the values of its INCLUDE columns (positions in the table's rows)
+// with every entry, so queries reading only those and the key never touch the rows.
+class ColumnIndex {
+    std::variant<Index<double>, Index<std::string>> tree;
+    std::vector<std::size_t> included;
+
+    std::vector<Value> payloadOf(const Row* row) const;
 
 public:
-    Index(const bool isUnique = false) : isUnique(isUnique) {}
+    explicit ColumnIndex(DataType type = DataType::DOUBLE, bool isUnique = false, std::vector<std::size_t> included = {});
 
-    void insert(const Value& val, size_t rowIdx);
-    void remove(const Value& val, size_t rowIdx);
-    std::vector<size_t> find(const Value& val) const;
+    bool accepts(const Value& val) const;
+    // `row` is the indexed row, which a covering index copies its INCLUDE values from.
+    void insert(const Value& val, std::size_t rowIdx, const Row* row = nullptr);
+    // `entries` sorted by value, then row; see Index::insertSorted. `rows` holds the indexed rows.
+    void insertSorted(const std::vector<std::pair<const Value*, std::size_t>>& entries, const std::vector<Row>* rows = nullptr);
+    void remove(const Value& val, std::size_t rowIdx);
+    // Follows a change of column `column` of the row indexed under (val, rowIdx) into its INCLUDE values.
+    void updateIncluded(const Value& val, std::size_t rowIdx, std::size_t column, const Value& value);
+    std::vector<std::size_t> find(const Value& val) const;
+    std::vector<std::size_t> findRange(const Value* low, bool lowInclusive, const Value* high, bool highInclusive) const;
+    // Index-only access: for every entry between the bounds, in key order, writes the key into
+    // row.values[keyColumn] and the INCLUDE values into their columns of `row`, then calls visit().
+    void scanRange(const Value* low, bool lowInclusive, const Value* high, bool highInclusive, std::size_t keyColumn,
+                   Row& row, const std::function<void()>& visit) const;
+    const std::vector<std::size_t>& getIncluded() const;
     void clear();
     bool getIsUnique() const;
+    std::size_t memoryUsage() const;
 };
 
 #endif //PROEKT_INDEX_H
\ No newline at end of file
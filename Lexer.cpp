@@ -0,0 +1,102 @@
+#include "Lexer.h"
+#include <cctype>
+#include <charconv>
+#include <stdexcept>
+
+namespace {
+    char upperChar(char c) {
+        return static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+    }
+
+    bool isSymbol(char c) {
+        return c == ',' || c == '(' || c == ')' || c == '{' || c == '}' || c == ':';
+    }
+
+    bool isOperatorChar(char c) {
+        return c == '=' || c == '!' || c == '<' || c == '>';
+    }
+
+    bool isQuote(char c) {
+        return c == '"' || c == '\'';
+    }
+
+    bool endsWord(char c) {
+        return std::isspace(static_cast<unsigned char>(c)) || isSymbol(c) || isOperatorChar(c) || c == '?' || c == '"';
+    }
+
+    bool looksNumeric(std::string_view text) {
+        std::size_t i = text[0] == '-' ? 1 : 0;
+        if (i < text.size() && text[i] == '.') i++;
+        return i < text.size() && std::isdigit(static_cast<unsigned char>(text[i]));
+    }
+
+    bool parsesAsNumber(std::string_view text, double& number) {
+        auto [end, ec] = std::from_chars(text.data(), text.data() + text.size(), number);
+        return ec == std::errc() && end == text.data() + text.size();
+    }
+}
+
+bool equalsIgnoreCase(std::string_view a, std::string_view b) {
+    if (a.size() != b.size()) return false;
+    for (std::size_t i = 0; i < a.size(); i++) {
+        if (upperChar(a[i]) != upperChar(b[i])) return false;
+    }
+    return true;
+}
+
+bool Token::is(std::string_view keyword) const {
+    return kind == TokenKind::WORD && equalsIgnoreCase(text, keyword);
+}
+
+std::vector<Token> tokenize(std::string_view input) {
+    std::vector<Token> tokens;
+    std::size_t i = 0;
+
+    while (i < input.size()) {
+        const char c = input[i];
+        const std::size_t start = i;
+
+        if (std::isspace(static_cast<unsigned char>(c))) {
+            i++;
+            continue;
+        }
+
+        if (isQuote(c)) {
+            // An unterminated string runs to the end of the command.
+            const std::size_t close = input.find(c, i + 1);
+            i = close == std::string_view::npos ? input.size() : close + 1;
+            tokens.push_back({TokenKind::STRING, input.substr(start, i - start)});
+        } else if (isSymbol(c)) {
+            tokens.push_back({TokenKind::SYMBOL, input.substr(i++, 1)});
+        } else if (c == '?') {
+            tokens.push_back({TokenKind::PLACEHOLDER, input.substr(i++, 1)});
+        } else if (isOperatorChar(c)) {
+            i++;
+            if (i < input.size() && input[i] == '=' && c != '=') i++;
+            tokens.push_back({TokenKind::OPERATOR, input.substr(start, i - start)});
+        } else {
+            while (i < input.size() && !endsWord(input[i])) i++;
+            const std::string_view text = input.substr(start, i - start);
+            double number;
+            const bool numeric = looksNumeric(text) && parsesAsNumber(text, number);
+            tokens.push_back({numeric ? TokenKind::NUMBER : TokenKind::WORD, text});
+        }
+    }
+    return tokens;
+}
+
+std::string_view unquote(const Token& token) {
+    std::string_view text = token.text;
+    if (token.kind != TokenKind::STRING) return text;
+    text.remove_prefix(1);
+    if (!text.empty() && text.back() == token.text.front()) text.remove_suffix(1);
+    return text;
+}
+
+double parseNumber(std::string_view text) {
+    double number;
+    if (text.empty() || !parsesAsNumber(text, number)) {
+        throw std::invalid_argument("Invalid number: " + std::string(text));
+    }
+    return number;
+}
\ No newline at end of file
@@ -0,0 +1,36 @@
+#ifndef PROEKT_LEXER_H
+#define PROEKT_LEXER_H
+
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+enum class TokenKind { WORD, NUMBER, STRING, SYMBOL, OPERATOR, PLACEHOLDER };
+
+// A token is a view into the command text, so the text must outlive it.
+// STRING tokens keep their surrounding quotes; unquote() strips them.
+struct Token {
+    TokenKind kind = TokenKind::WORD;
+    std::string_view text;
+
+    // Case-insensitive keyword match; only bare words can be keywords.
+    bool is(std::string_view keyword) const;
+
+    bool operator==(std::string_view other) const { return text == other; }
+    std::string str() const { return std::string(text); }
+};
+
+bool equalsIgnoreCase(std::string_view a, std::string_view b);
+
+// Splits a command into words, numbers, quoted strings, the symbols , ( ) { } : and the comparison
+// operators = != < <= > >=. A `?` is a placeholder.
+std::vector<Token> tokenize(std::string_view input);
+
+// The contents of a quoted string token, or the token itself when it is not quoted.
+std::string_view unquote(const Token& token);
+
+// Parses the whole token as a double; throws std::invalid_argument when it is not a number.
+double parseNumber(std::string_view text);
+
+#endif //PROEKT_LEXER_H
\ No newline at end of file
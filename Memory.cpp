@@ -0,0 +1,68 @@
+#include "Memory.h"
+#include <charconv>
+#include <cstdio>
+#include <stdexcept>
+#include "Lexer.h"
+
+TrackingResource::TrackingResource(std::pmr::memory_resource *upstream) : upstream(upstream) {}
+
+void *TrackingResource::do_allocate(std::size_t size, std::size_t alignment) {
+    void* p = upstream->allocate(size, alignment);
+    bytes += size;
+    return p;
+}
+
+void TrackingResource::do_deallocate(void *p, std::size_t size, std::size_t alignment) {
+    upstream->deallocate(p, size, alignment);
+    bytes -= size;
+}
+
+bool TrackingResource::do_is_equal(const std::pmr::memory_resource &other) const noexcept {
+    return this == &other;
+}
+
+std::size_t TrackingResource::getBytes() const {
+    return bytes;
+}
+
+std::size_t MemoryUsage::total() const {
+    return rowBytes + stringBytes + indexBytes + summaryBytes + undoBytes;
+}
+
+MemoryUsage &MemoryUsage::operator+=(const MemoryUsage &other) {
+    rowBytes += other.rowBytes;
+    stringBytes += other.stringBytes;
+    indexBytes += other.indexBytes;
+    summaryBytes += other.summaryBytes;
+    undoBytes += other.undoBytes;
+    return *this;
+}
+
+std::string formatBytes(std::size_t bytes) {
+    if (bytes < 1024) return std::to_string(bytes) + " B";
+    const char* units[] = {"KB", "MB", "GB", "TB"};
+    double value = bytes / 1024.0;
+    int unit = 0;
+    while (value >= 1024 && unit < 3) {
+        value /= 1024;
+        unit++;
+    }
+    char text[32];
+    std::snprintf(text, sizeof(text), "%.1f %s", value, units[unit]);
+    return text;
+}
+
+std::size_t parseByteSize(std::string_view text) {
+    double number = 0;
+    auto [end, ec] = std::from_chars(text.data(), text.data() + text.size(), number);
+    const std::string_view suffix = text.substr(end - text.data());
+    std::size_t scale = 0;
+    if (suffix.empty() || equalsIgnoreCase(suffix, "B")) scale = 1;
+    else if (equalsIgnoreCase(suffix, "KB")) scale = std::size_t(1) << 10;
+    else if (equalsIgnoreCase(suffix, "MB")) scale = std::size_t(1) << 20;
+    else if (equalsIgnoreCase(suffix, "GB")) scale = std::size_t(1) << 30;
+    if (ec != std::errc() || number < 0 || scale == 0) {
+        throw std::runtime_error("Invalid size: " + std::string(text));
+    }
+    return static_cast<std::size_t>(number * scale);
+}
\ No newline at end of file
@@ -0,0 +1,43 @@
+#ifndef PROEKT_MEMORY_H
+#define PROEKT_MEMORY_H
+
+#include <cstddef>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+
+// Forwards to `upstream` and counts the bytes currently allocated through it. Placed upstream
+// of a pool it reports the pool's real footprint, including its free lists.
+class TrackingResource : public std::pmr::memory_resource {
+    std::pmr::memory_resource* upstream;
+    std::size_t bytes = 0;
+
+protected:
+    void* do_allocate(std::size_t size, std::size_t alignment) override;
+    void do_deallocate(void* p, std::size_t size, std::size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+public:
+    explicit TrackingResource(std::pmr::memory_resource* upstream = std::pmr::new_delete_resource());
+
+    std::size_t getBytes() const;
+};
+
+// Bytes held by a table, by what holds them.
+struct MemoryUsage {
+    std::size_t rowBytes = 0;     // the row array and the pooled value arrays
+    std::size_t stringBytes = 0;  // heap buffers of string and date values
+    std::size_t indexBytes = 0;   // B+tree nodes and the heap buffers of string keys
+    std::size_t summaryBytes = 0; // zone maps and Bloom filters
+    std::size_t undoBytes = 0;    // what open transactions overwrote, kept to roll them back
+
+    std::size_t total() const;
+    MemoryUsage& operator+=(const MemoryUsage& other);
+};
+
+// "512 B", "12.5 KB", "3.0 MB"...
+std::string formatBytes(std::size_t bytes);
+// A byte count with an optional B, KB, MB or GB suffix (case-insensitive, powers of 1024).
+std::size_t parseByteSize(std::string_view text);
+
+#endif //PROEKT_MEMORY_H
\ No newline at end of file
@@ -1,124 +1,138 @@
 #ifndef PROEKT_PARSER_H
 #define PROEKT_PARSER_H
 
-#include <chrono>
 #include "Database.h"
+#include "Lexer.h"
 
 class Parser {
 public:
-    static std::vector<std::string> tokenize(const std::string& str) {
-        std::vector<std::string> tokens;
-        std::string current;
-        bool inQuotes = false;
-
-        for (size_t i = 0; i < str.length(); i++) {
-            char c = str[i];
-
-            if (c == '"') {
-                inQuotes = !inQuotes;
-                current += c;
-            } else if (inQuotes) {
-                current += c;
-            } else if (isspace(c) || c == ',' || c == '(' || c == ')' || c == '{' || c == '}' || c == ':') {
-                if (!current.empty()) {
-                    tokens.push_back(current);
-                    current.clear();
-                }
-                if (c == ',' || c == '(' || c == ')' || c == '{' || c == '}' || c == ':') {
-                    tokens.emplace_back(1, c);
-                }
-            } else {
-                current += c;
-            }
-        }
-
-        if (!current.empty()) tokens.push_back(current);
-        return tokens;
+    static DataType parseDataType(std::string_view str) {
+        if (equalsIgnoreCase(str, "double")) return DataType::DOUBLE;
+        if (equalsIgnoreCase(str, "string")) return DataType::STRING;
+        if (equalsIgnoreCase(str, "date")) return DataType::DATE;
+        throw std::runtime_error("Unknown data type: " + std::string(str));
     }
 
-    static DataType parseDataType(const std::string& str) {
-        std::string lower = str;
-        std::ranges::transform(lower, lower.begin(), ::tolower);
-        if (lower == "double") return DataType::DOUBLE;
-        if (lower == "string") return DataType::STRING;
-        if (lower == "date") return DataType::DATE;
-        throw std::runtime_error("Unknown data type: " + str);
+    static Value parseValue(const Token& token, DataType type) {
+        if (type == DataType::DOUBLE) {
+            return Value(parseNumber(token.text));
+        }
+        return Value(std::string(unquote(token)), type);
     }
 
-    static Value parseValue(const std::string& str, DataType type) {
-        if (type == DataType::DOUBLE) {
-            return Value(stod(str));
+    // A literal of the column's type, or a `?` placeholder when the statement is being prepared.
+    static Operand parseOperand(std::span<const Token> tokens, size_t& pos, DataType type, Parameters* parameters) {
+        if (pos >= tokens.size()) throw std::runtime_error("Expected a value");
+        if (tokens[pos].kind == TokenKind::PLACEHOLDER) {
+            if (!parameters) throw std::runtime_error("Placeholders are only allowed in prepared statements");
+            pos++;
+            return Operand(parameters, parameters->add(type));
         }
-        std::string cleaned = str;
-        if (cleaned.front() == '"') cleaned = cleaned.substr(1);
-        if (cleaned.back() == '"') cleaned.pop_back();
-        return Value(cleaned, type);
+        return Operand(parseValue(tokens[pos++], type));
     }
 
-    static std::unique_ptr<Expression> parseWhereExpression(const std::vector<std::string>& tokens, size_t& pos, const Table& table) {
-        return parseOr(tokens, pos, table);
+    static std::unique_ptr<Expression> parseWhereExpression(std::span<const Token> tokens, size_t& pos, const Table& table, Parameters* parameters = nullptr) {
+        return parseOr(tokens, pos, table, parameters);
     }
 
-    static std::unique_ptr<Expression> parseOr(const std::vector<std::string>& tokens, size_t& pos, const Table& table) {
-        auto left = parseAnd(tokens, pos, table);
+    static std::unique_ptr<Expression> parseOr(std::span<const Token> tokens, size_t& pos, const Table& table, Parameters* parameters = nullptr) {
+        auto left = parseAnd(tokens, pos, table, parameters);
 
         while (pos < tokens.size()) {
-            std::string op = tokens[pos];
-            std::ranges::transform(op, op.begin(), ::toupper);
-
-            if (op != "OR") break;
+            if (!tokens[pos].is("OR")) break;
 
             pos++;
-            auto right = parseAnd(tokens, pos, table);
+            auto right = parseAnd(tokens, pos, table, parameters);
             left = std::make_unique<LogicalExpression>("OR", std::move(left), std::move(right));
         }
         return left;
     }
 
-    static std::unique_ptr<Expression> parseAnd(const std::vector<std::string>& tokens, size_t& pos, const Table& table) {
-        auto left = parsePrimary(tokens, pos, table);
+    static std::unique_ptr<Expression> parseAnd(std::span<const Token> tokens, size_t& pos, const Table& table, Parameters* parameters = nullptr) {
+        auto left = parsePrimary(tokens, pos, table, parameters);
 
         while (pos < tokens.size()) {
-            std::string op = tokens[pos];
-            std::ranges::transform(op, op.begin(), ::toupper);
-
-            if (op != "AND") break;
+            if (!tokens[pos].is("AND")) break;
 
             pos++;
-            auto right = parsePrimary(tokens, pos, table);
+            auto right = parsePrimary(tokens, pos, table, parameters);
             left = std::make_unique<LogicalExpression>("AND", std::move(left), std::move(right));
         }
         return left;
     }
 
-    static std::unique_ptr<Expression> parsePrimary(const std::vector<std::string>& tokens, size_t& pos, const Table& table) {
+    static std::unique_ptr<Expression> parsePrimary(std::span<const Token> tokens, size_t& pos, const Table& table, Parameters* parameters = nullptr) {
         if (pos >= tokens.size()) return nullptr;
 
-        std::string token = tokens[pos];
-        std::string upperToken = token;
-        std::ranges::transform(upperToken, upperToken.begin(), ::toupper);
-
-        if (upperToken == "NOT") {
+        if (tokens[pos].is("NOT")) {
             pos++;
-            auto expr = parsePrimary(tokens, pos, table);
+            auto expr = parsePrimary(tokens, pos, table, parameters);
             return std::make_unique<LogicalExpression>("NOT", std::move(expr));
         }
 
-        if (token == "(") {
+        if (tokens[pos] == "(") {
             pos++;
-            auto expr = parseOr(tokens, pos, table);
+            auto expr = parseOr(tokens, pos, table, parameters);
             if (pos < tokens.size() && tokens[pos] == ")") pos++;
             return expr;
         }
 
-        std::string colName = tokens[pos++];
-        std::string op = tokens[pos++];
+        // col [NOT] IN (v, ...), col [NOT] BETWEEN low AND high and col [NOT] LIKE pattern
+        auto isKeyword = [&](std::size_t at) {
+            return at < tokens.size() && (tokens[at].is("IN") || tokens[at].is("BETWEEN") || tokens[at].is("LIKE"));
+        };
+        const bool negated = pos + 1 < tokens.size() && tokens[pos + 1].is("NOT") && isKeyword(pos + 2);
+        const std::size_t keyword = pos + (negated ? 2 : 1);
+        if (isKeyword(keyword)) {
+            std::string colName = tokens[pos].str();
+            int colIdx = table.getColumnIndex(colName);
+            if (colIdx == -1) throw std::runtime_error("Unknown column: " + colName);
+            const DataType type = table.getColumns()[colIdx].type;
+            pos = keyword + 1;
+
+            std::unique_ptr<Expression> expr;
+            if (tokens[keyword].is("IN")) {
+                if (pos >= tokens.size() || tokens[pos] != "(") throw std::runtime_error("Expected ( after IN");
+                pos++;
+                std::vector<Operand> items;
+                bool placeholders = false;
+                while (pos < tokens.size() && tokens[pos] != ")") {
+                    if (tokens[pos] == ",") {
+                        pos++;
+                        continue;
+                    }
+                    items.push_back(parseOperand(tokens, pos, type, parameters));
+                    placeholders = placeholders || items.back().isPlaceholder();
+                }
+                if (pos >= tokens.size()) throw std::runtime_error("Expected ) after IN list");
+                pos++;
+                if (items.empty()) throw std::runtime_error("Expected values in IN list");
+                expr = std::make_unique<InExpression>(colName, std::move(items), placeholders ? parameters : nullptr);
+            } else if (tokens[keyword].is("LIKE")) {
+                if (type == DataType::DOUBLE) throw std::runtime_error("LIKE needs a String or Date column: " + colName);
+                expr = std::make_unique<LikeExpression>(colName, parseOperand(tokens, pos, DataType::STRING, parameters));
+            } else {
+                Operand low = parseOperand(tokens, pos, type, parameters);
+                if (pos >= tokens.size() || !tokens[pos].is("AND")) throw std::runtime_error("Expected AND in BETWEEN");
+                pos++;
+                Operand high = parseOperand(tokens, pos, type, parameters);
+                expr = std::make_unique<BetweenExpression>(colName, std::move(low), std::move(high));
+            }
+            if (negated) return std::make_unique<LogicalExpression>("NOT", std::move(expr));
+            return expr;
+        }
+
+        if (pos + 2 >= tokens.size() || tokens[pos + 1].kind != TokenKind::OPERATOR) {
+            throw std::runtime_error("Expected column, comparison and value near: " + tokens[pos].str());
+        }
+        std::string colName = tokens[pos++].str();
+        std::string op = tokens[pos++].str();
 
         int colIdx = table.getColumnIndex(colName);
         if (colIdx == -1) throw std::runtime_error("Unknown column: " + colName);
 
-        Value val = parseValue(tokens[pos++], table.getColumns()[colIdx].type);
-        return std::make_unique<ComparisonExpression>(colName, op, val);
+        const DataType type = table.getColumns()[colIdx].type;
+        return std::make_unique<ComparisonExpression>(colName, op, parseOperand(tokens, pos, type, parameters));
     }
 };
 #endif //PROEKT_PARSER_H
\ No newline at end of file
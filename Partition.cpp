@@ -0,0 +1,82 @@
+#include "Partition.h"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+namespace {
+    // Rows stay in their partitions on disk, so the hash must not change between builds or runs:
+    // FNV-1a for strings, and for doubles the bit pattern of their epsilon-wide bucket (as in
+    // BloomFilter), both spread by mixHash.
+    double doubleBucket(double value) {
+        return std::floor(value / Value::epsilon) + 0.0; // + 0.0 folds -0.0 into 0.0
+    }
+
+    uint64_t hashBucket(double bucket) {
+        return mixHash(std::bit_cast<uint64_t>(bucket));
+    }
+
+    uint64_t hashString(const std::string& value) {
+        uint64_t hash = 0xCBF29CE484222325;
+        for (unsigned char c : value) hash = (hash ^ c) * 0x100000001B3;
+        return mixHash(hash);
+    }
+}
+
+std::size_t PartitionScheme::partitionCount() const {
+    switch (kind) {
+        case PartitionKind::RANGE: return bounds.size() + 1;
+        case PartitionKind::HASH: return count;
+        case PartitionKind::NONE: return 0;
+    }
+    return 0;
+}
+
+std::size_t PartitionScheme::partitionOf(const Value &key) const {
+    if (kind == PartitionKind::HASH) {
+        const uint64_t hash = key.type == DataType::DOUBLE ? hashBucket(doubleBucket(key.numValue)) : hashString(key.strValue);
+        return hash % count;
+    }
+    return std::ranges::upper_bound(bounds, key) - bounds.begin();
+}
+
+bool PartitionScheme::mayHold(std::size_t partition, const std::string &op, const Value &value) const {
+    if (kind == PartitionKind::HASH) {
+        if (op != "=") return true;
+        if (value.type != DataType::DOUBLE) return partitionOf(value) == partition;
+        // Double equality is tolerant (see Value::epsilon): equal keys fall in this bucket or a neighbour.
+        const double bucket = doubleBucket(value.numValue);
+        for (double probe : {bucket - 1, bucket, bucket + 1}) {
+            if (hashBucket(probe) % count == partition) return true;
+        }
+        return false;
+    }
+
+    // Mixed-type comparisons do not follow the column's ordering, so the bounds say nothing.
+    if (kind != PartitionKind::RANGE || (value.type == DataType::DOUBLE) != (bounds.front().type == DataType::DOUBLE)) {
+        return true;
+    }
+    const Value* lower = partition > 0 ? &bounds[partition - 1] : nullptr;
+    const Value* upper = partition < bounds.size() ? &bounds[partition] : nullptr;
+    if (op == "=") {
+        if (value.type == DataType::DOUBLE) {
+            return (!lower || lower->numValue < value.numValue + Value::epsilon) &&
+                   (!upper || value.numValue - Value::epsilon < upper->numValue);
+        }
+        return (!lower || !(value < *lower)) && (!upper || value < *upper);
+    }
+    if (op == "<") return !lower || *lower < value;
+    if (op == "<=") return !lower || !(value < *lower);
+    if (op == ">" || op == ">=") return !upper || value < *upper;
+    return true;
+}
+
+std::string PartitionScheme::describe(std::size_t partition) const {
+    if (kind == PartitionKind::HASH) {
+        return "hash(" + column + ") % " + std::to_string(count) + " = " + std::to_string(partition);
+    }
+    std::string text;
+    if (partition > 0) text = bounds[partition - 1].toString() + " <= ";
+    text += column;
+    if (partition < bounds.size()) text += " < " + bounds[partition].toString();
+    return text;
+}
\ No newline at end of file
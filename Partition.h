@@ -0,0 +1,30 @@
+#ifndef PROEKT_PARTITION_H
+#define PROEKT_PARTITION_H
+
+#include <string>
+#include <vector>
+#include "Data.h"
+
+enum class PartitionKind { NONE, RANGE, HASH };
+
+// How a partitioned table spreads its rows over its partitions by the value of one column.
+// RANGE: `bounds` ascending, n bounds making n + 1 partitions; partition i holds the keys in
+// [bounds[i - 1], bounds[i]), the first and the last being open-ended.
+// HASH: `count` partitions, a key going to hash(key) % count.
+struct PartitionScheme {
+    static constexpr std::size_t maxPartitions = 4096;
+
+    PartitionKind kind = PartitionKind::NONE;
+    std::string column;
+    std::vector<Value> bounds;
+    std::size_t count = 0;
+
+    std::size_t partitionCount() const;
+    std::size_t partitionOf(const Value& key) const;
+    // False only when no key of the partition can satisfy `key op value`.
+    bool mayHold(std::size_t partition, const std::string& op, const Value& value) const;
+    // The keys a partition holds, e.g. `"2024-01-01" <= day < "2024-02-01"` or `hash(id) % 4 = 1`.
+    std::string describe(std::size_t partition) const;
+};
+
+#endif //PROEKT_PARTITION_H
\ No newline at end of file
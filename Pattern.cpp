@@ -0,0 +1,52 @@
+#include "Pattern.h"
+#include <algorithm>
+
+bool likeMatch(std::string_view text, std::string_view pattern) {
+    // Greedy match that backtracks only to the last `%`: each `%` either consumes one more
+    // character or ends, and an earlier `%` never needs to be revisited.
+    std::size_t t = 0, p = 0;
+    std::size_t starPattern = std::string_view::npos, starText = 0;
+    while (t < text.size()) {
+        if (p < pattern.size() && pattern[p] == '%') {
+            starPattern = p++;
+            starText = t;
+        } else if (p < pattern.size() && (pattern[p] == '_' || pattern[p] == text[t])) {
+            p++;
+            t++;
+        } else if (starPattern != std::string_view::npos) {
+            p = starPattern + 1;
+            t = ++starText;
+        } else {
+            return false;
+        }
+    }
+    while (p < pattern.size() && pattern[p] == '%') p++;
+    return p == pattern.size();
+}
+
+std::string_view likePrefix(std::string_view pattern) {
+    return pattern.substr(0, pattern.find_first_of("%_"));
+}
+
+bool hasWildcards(std::string_view pattern) {
+    return pattern.find_first_of("%_") != std::string_view::npos;
+}
+
+std::vector<std::string_view> likeFragments(std::string_view pattern) {
+    std::vector<std::string_view> fragments;
+    std::size_t start = 0;
+    while (start <= pattern.size()) {
+        const std::size_t end = std::min(pattern.find_first_of("%_", start), pattern.size());
+        if (end > start) fragments.push_back(pattern.substr(start, end - start));
+        start = end + 1;
+    }
+    return fragments;
+}
+
+std::optional<std::string> prefixSuccessor(std::string_view prefix) {
+    std::string successor(prefix);
+    while (!successor.empty() && static_cast<unsigned char>(successor.back()) == 0xFF) successor.pop_back();
+    if (successor.empty()) return std::nullopt;
+    successor.back() = static_cast<char>(static_cast<unsigned char>(successor.back()) + 1);
+    return successor;
+}
\ No newline at end of file
@@ -0,0 +1,21 @@
+#ifndef PROEKT_PATTERN_H
+#define PROEKT_PATTERN_H
+
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// LIKE patterns: `%` matches any run of characters (none included), `_` exactly one byte, and
+// every other character only itself, case-sensitively.
+bool likeMatch(std::string_view text, std::string_view pattern);
+// The literal characters before the first wildcard: "ab" for "ab%c_".
+std::string_view likePrefix(std::string_view pattern);
+bool hasWildcards(std::string_view pattern);
+// The runs of literal characters between wildcards: "ab", "cd" for "%ab_cd%".
+std::vector<std::string_view> likeFragments(std::string_view pattern);
+// The smallest string above every string that starts with `prefix`, so the strings with that
+// prefix are exactly [prefix, successor). None when no such string exists ("" or all 0xFF bytes).
+std::optional<std::string> prefixSuccessor(std::string_view prefix);
+
+#endif //PROEKT_PATTERN_H
\ No newline at end of file
@@ -0,0 +1,746 @@
+#include "Planner.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <numeric>
+#include <set>
+
+namespace {
+    // Cost units: visiting one row of a sequential scan costs 1. A row reached through an index
+    // also pays for the tree walk, sorting the ids and the random access to the row.
+    constexpr double seqRowCost = 1.0;
+    constexpr double indexRowCost = 3.0;
+
+    // Guesses used when a table has no statistics.
+    constexpr double defaultEqualSelectivity = 0.1;
+    constexpr double defaultRangeSelectivity = 1.0 / 3;
+    constexpr double defaultBetweenSelectivity = 1.0 / 4;
+    constexpr double defaultLikeSelectivity = 0.1;
+
+    const ColumnStats* columnStatistics(const Table& table, const std::string& colName) {
+        const TableStats* stats = table.getStatistics();
+        if (!stats || stats->rowCount == 0) return nullptr;
+        auto it = stats->columns.find(colName);
+        return it != stats->columns.end() ? &it->second : nullptr;
+    }
+
+    bool sameKind(const Column& column, const Value& value) {
+        return (column.type == DataType::DOUBLE) == (value.type == DataType::DOUBLE);
+    }
+
+    double valueSelectivity(const Table& table, const std::string& colName, const std::string& op, const Value& value) {
+        const int colIdx = table.getColumnIndex(colName);
+        if (colIdx == -1) return 0;
+
+        const Column& column = table.getColumns()[colIdx];
+        if (!sameKind(column, value)) {
+            return op == "!=" ? 1 : 0;
+        }
+
+        const ColumnStats* columnStats = columnStatistics(table, column.name);
+        if (columnStats) {
+            const double equal = columnStats->fractionEqual(value);
+            const double below = columnStats->fractionBelow(value);
+            double fraction = 0;
+            if (op == "=") fraction = equal;
+            else if (op == "!=") fraction = 1 - equal;
+            else if (op == "<") fraction = below;
+            else if (op == "<=") fraction = below + equal;
+            else if (op == ">") fraction = 1 - below - equal;
+            else if (op == ">=") fraction = 1 - below;
+            return std::clamp(fraction, 0.0, 1.0);
+        }
+
+        if (op == "=") {
+            return column.uniqueIndex ? 1.0 / std::max<std::size_t>(1, table.getRows().size()) : defaultEqualSelectivity;
+        }
+        if (op == "!=") return 1 - defaultEqualSelectivity;
+        return defaultRangeSelectivity;
+    }
+
+    double inSelectivity(const Table& table, const InExpression& in) {
+        double fraction = 0;
+        for (const auto& value : in.values()) fraction += valueSelectivity(table, in.getColumnName(), "=", value);
+        return std::min(fraction, 1.0);
+    }
+
+    double betweenSelectivity(const Table& table, const BetweenExpression& between) {
+        const int colIdx = table.getColumnIndex(between.getColumnName());
+        if (colIdx == -1 || !sameKind(table.getColumns()[colIdx], between.lowValue())) return 0;
+        if (between.highValue() < between.lowValue()) return 0;
+        if (const ColumnStats* columnStats = columnStatistics(table, between.getColumnName())) {
+            const double fraction = columnStats->fractionBelow(between.highValue()) + columnStats->fractionEqual(between.highValue()) -
+                                    columnStats->fractionBelow(between.lowValue());
+            return std::clamp(fraction, 0.0, 1.0);
+        }
+        return defaultBetweenSelectivity;
+    }
+
+    std::size_t evaluationCost(const Expression* expr) {
+        auto logical = dynamic_cast<const LogicalExpression*>(expr);
+        if (!logical) return 1;
+        return evaluationCost(logical->getLeft()) + (logical->getRight() ? evaluationCost(logical->getRight()) : 0);
+    }
+
+    void flattenChain(std::unique_ptr<Expression>& node, const std::string& op, std::vector<std::unique_ptr<Expression>>& operands) {
+        auto logical = dynamic_cast<LogicalExpression*>(node.get());
+        if (logical && logical->getOperator() == op) {
+            flattenChain(logical->leftOperand(), op, operands);
+            flattenChain(logical->rightOperand(), op, operands);
+            node.reset();
+            return;
+        }
+        operands.push_back(std::move(node));
+    }
+
+    double pathCost(double tableRows, double matchedRows, std::size_t probes) {
+        return probes * std::log2(tableRows + 1) + matchedRows * indexRowCost;
+    }
+    void collectConjuncts(const Expression* expr, std::vector<const Expression*>& conjuncts) {
+        if (!expr) return;
+        if (auto logical = dynamic_cast<const LogicalExpression*>(expr); logical && logical->getOperator() == "AND") {
+            collectConjuncts(logical->getLeft(), conjuncts);
+            collectConjuncts(logical->getRight(), conjuncts);
+            return;
+        }
+        conjuncts.push_back(expr);
+    }
+
+    double likeSelectivity(const Table& table, const LikeExpression& like) {
+        const int colIdx = table.getColumnIndex(like.getColumnName());
+        if (colIdx == -1 || table.getColumns()[colIdx].type == DataType::DOUBLE) return 0;
+        const std::string& pattern = like.getPattern();
+        if (!hasWildcards(pattern)) return valueSelectivity(table, like.getColumnName(), "=", Value(pattern, DataType::STRING));
+        const std::string_view prefix = likePrefix(pattern);
+        const ColumnStats* columnStats = columnStatistics(table, like.getColumnName());
+        if (!columnStats || prefix.empty()) return defaultLikeSelectivity;
+        // The rows in [prefix, successor), of which the pattern keeps some.
+        const std::optional<std::string> successor = prefixSuccessor(prefix);
+        const double below = columnStats->fractionBelow(Value(std::string(prefix), DataType::STRING));
+        const double upTo = successor ? columnStats->fractionBelow(Value(*successor, DataType::STRING)) : 1.0;
+        return std::clamp(upTo - below, 0.0, 1.0);
+    }
+
+    KeyRange equalRange(const Value& value) {
+        if (value.type != DataType::DOUBLE) return {value, value, true, true};
+        // Double equality is tolerant (see Value::epsilon), so probe the whole tolerance window.
+        return {Value(value.numValue - Value::epsilon), Value(value.numValue + Value::epsilon), false, false};
+    }
+
+    KeyRange comparisonRange(const ComparisonExpression& predicate) {
+        const Value& value = predicate.operand();
+        const std::string& op = predicate.getOperator();
+        if (op == "=") return equalRange(value);
+        if (op == ">") return {value, std::nullopt, false, false};
+        if (op == ">=") return {value, std::nullopt, true, false};
+        if (op == "<") return {std::nullopt, value, false, false};
+        return {std::nullopt, value, false, true};
+    }
+
+    // One probe per listed value, ascending. Tolerance windows of doubles closer than
+    // 2 * epsilon overlap and are merged, so no row is found twice.
+    std::vector<KeyRange> inRanges(const InExpression& in) {
+        std::vector<KeyRange> ranges;
+        for (const auto& value : in.values()) {
+            KeyRange range = equalRange(value);
+            if (!ranges.empty() && value.type == DataType::DOUBLE && !(ranges.back().high->numValue < range.low->numValue)) {
+                ranges.back().high = range.high;
+            } else {
+                ranges.push_back(std::move(range));
+            }
+        }
+        return ranges;
+    }
+
+    // A LIKE with a literal prefix scans [prefix, successor) of the column's ordered index (a
+    // pattern without wildcards is a plain lookup). Otherwise a trigram index narrows the rows
+    // down to those holding every trigram of the pattern's fragments.
+    std::optional<AccessPath> likeAccess(const Table& table, const LikeExpression& like) {
+        AccessPath access;
+        access.predicate = &like;
+        access.column = like.getColumnName();
+        const std::string& pattern = like.getPattern();
+        const std::string_view prefix = likePrefix(pattern);
+        const double tableRows = table.getRows().size();
+        access.estimatedRows = likeSelectivity(table, like) * tableRows;
+
+        if (table.getIndex(access.column) && !prefix.empty()) {
+            const Value low(std::string(prefix), DataType::STRING);
+            if (!hasWildcards(pattern)) {
+                access.kind = AccessKind::INDEX_LOOKUP;
+                access.ranges = {{low, low, true, true}};
+            } else {
+                access.kind = AccessKind::INDEX_RANGE;
+                const std::optional<std::string> successor = prefixSuccessor(prefix);
+                access.ranges = {{low, successor ? std::optional<Value>(Value(*successor, DataType::STRING)) : std::nullopt, true, false}};
+            }
+            access.cost = pathCost(tableRows, access.estimatedRows, 1);
+            return access;
+        }
+
+        if (!table.getTrigramIndex(access.column)) return std::nullopt;
+        for (std::string_view fragment : likeFragments(pattern)) {
+            const std::vector<uint32_t> trigrams = TrigramIndex::trigramsOf(fragment);
+            access.trigrams.insert(access.trigrams.end(), trigrams.begin(), trigrams.end());
+        }
+        std::ranges::sort(access.trigrams);
+        const auto duplicates = std::ranges::unique(access.trigrams);
+        access.trigrams.erase(duplicates.begin(), duplicates.end());
+        if (access.trigrams.empty()) return std::nullopt;
+        access.kind = AccessKind::TRIGRAM_SEARCH;
+        access.cost = pathCost(tableRows, access.estimatedRows, access.trigrams.size());
+        return access;
+    }
+
+    // The index access a conjunct allows, or none when its column is not indexed or the
+    // conjunct is not a comparison (other than !=), an IN list, a BETWEEN or a LIKE.
+    std::optional<AccessPath> indexAccess(const Table& table, const Expression* conjunct) {
+        AccessPath access;
+        access.predicate = conjunct;
+        double selectivity = 0;
+        const Value* sample = nullptr;
+        if (auto comparison = dynamic_cast<const ComparisonExpression*>(conjunct)) {
+            if (comparison->getOperator() == "!=") return std::nullopt;
+            access.kind = comparison->getOperator() == "=" ? AccessKind::INDEX_LOOKUP : AccessKind::INDEX_RANGE;
+            access.column = comparison->getColumnName();
+            access.ranges = {comparisonRange(*comparison)};
+            selectivity = valueSelectivity(table, access.column, comparison->getOperator(), comparison->operand());
+            sample = &comparison->operand();
+        } else if (auto in = dynamic_cast<const InExpression*>(conjunct)) {
+            access.kind = AccessKind::INDEX_MULTI_LOOKUP;
+            access.column = in->getColumnName();
+            access.ranges = inRanges(*in);
+            selectivity = inSelectivity(table, *in);
+            sample = &in->values().front();
+        } else if (auto between = dynamic_cast<const BetweenExpression*>(conjunct)) {
+            access.kind = AccessKind::INDEX_RANGE;
+            access.column = between->getColumnName();
+            access.ranges = {{between->lowValue(), between->highValue(), true, true}};
+            selectivity = betweenSelectivity(table, *between);
+            sample = &between->lowValue();
+        } else if (auto like = dynamic_cast<const LikeExpression*>(conjunct)) {
+            return likeAccess(table, *like);
+        } else {
+            return std::nullopt;
+        }
+        // A value of another type never compares equal or ordered to the column, so the index cannot help.
+        if (!table.getIndex(access.column) || !sameKind(table.getColumns()[table.getColumnIndex(access.column)], *sample)) {
+            return std::nullopt;
+        }
+        const double tableRows = table.getRows().size();
+        access.estimatedRows = selectivity * tableRows;
+        access.cost = pathCost(tableRows, access.estimatedRows, access.ranges.size());
+        return access;
+    }
+
+    // Rows in the access path's key ranges, in key order, or the candidates of a trigram search.
+    std::vector<std::size_t> probeIndex(const Table& table, const AccessPath& access) {
+        if (access.kind == AccessKind::TRIGRAM_SEARCH) return table.getTrigramIndex(access.column)->candidates(access.trigrams);
+        const ColumnIndex& index = *table.getIndex(access.column);
+        std::vector<std::size_t> ids;
+        for (const auto& range : access.ranges) {
+            const std::vector<std::size_t> found = index.findRange(range.low ? &*range.low : nullptr, range.lowInclusive,
+                                                                   range.high ? &*range.high : nullptr, range.highInclusive);
+            if (ids.empty()) ids = found;
+            else ids.insert(ids.end(), found.begin(), found.end());
+        }
+        return ids;
+    }
+
+    // True when the index the access path probes holds every column the query reads, as its key
+    // or among its INCLUDE columns.
+    bool indexCovers(const Table& table, const AccessPath& access, const std::vector<std::string>& columnNames,
+                     const Expression* where, const std::string& orderByColumn) {
+        if (access.kind == AccessKind::FULL_SCAN || access.kind == AccessKind::TRIGRAM_SEARCH) return false;
+        const std::string& keyColumn = access.column;
+        std::set<std::string> available = {keyColumn};
+        for (std::size_t colIdx : table.getIndex(keyColumn)->getIncluded()) available.insert(table.getColumns()[colIdx].name);
+
+        std::vector<std::string> needed;
+        where->collectColumns(needed);
+        for (const auto& name : columnNames) {
+            if (name == "*") {
+                for (const auto& column : table.getColumns()) needed.push_back(column.name);
+            } else if (table.getColumnIndex(name) != -1) {
+                needed.push_back(name);
+            }
+        }
+        if (table.getColumnIndex(orderByColumn) != -1) needed.push_back(orderByColumn);
+        return std::ranges::all_of(needed, [&](const std::string& name) { return available.contains(name); });
+    }
+
+    std::vector<int> displayColumns(const Table& table, const std::vector<std::string>& columnNames) {
+        std::vector<int> columnsToDisplay;
+        if (columnNames.size() == 1 && columnNames[0] == "*") {
+            for (std::size_t i = 0; i < table.getColumns().size(); i++) {
+                columnsToDisplay.push_back(i);
+            }
+        } else {
+            for (const auto& name : columnNames) {
+                int idx = table.getColumnIndex(name);
+                if (idx != -1) columnsToDisplay.push_back(idx);
+            }
+        }
+        return columnsToDisplay;
+    }
+
+    void removeDuplicates(ResultSet& results, OperatorStats* distinct) {
+        OperatorTimer timer(distinct);
+        distinct->rowsIn = results.rows.size();
+        std::set<Row> seenRows;
+        std::erase_if(results.rows, [&](const Row& row) {
+            if (!seenRows.insert(row).second) return true;
+            distinct->bytesAllocated += approximateBytes(row) + 4 * sizeof(void*);
+            return false;
+        });
+        distinct->rowsOut = results.rows.size();
+    }
+
+    // Entries come out of the index in key order and are unpacked into one scratch row, which the
+    // filter and the projection read as if it were the table's row. Filtering and projecting
+    // happen during the walk, so their time counts towards the scan.
+    ResultSet executeIndexOnly(const Table& table, const std::vector<int>& columnsToDisplay, const Expression* where,
+                               const std::string& orderByColumn, QueryPlan& plan) {
+        const ColumnIndex& index = *table.getIndex(plan.access.column);
+        const std::size_t keyColumn = table.getColumnIndex(plan.access.column);
+
+        Row entry;
+        for (const auto& column : table.getColumns()) {
+            entry.values.push_back(column.type == DataType::DOUBLE ? Value(0.0) : Value("", column.type));
+        }
+
+        ResultSet results;
+        for (int colIdx : columnsToDisplay) {
+            results.columns.push_back({table.getColumns()[colIdx].name, table.getColumns()[colIdx].type});
+        }
+        OperatorStats& scan = plan.operators.front();
+        OperatorStats* filter = plan.find("Filter");
+        OperatorStats* project = plan.find("Project");
+        OperatorStats* sort = plan.find("Sort");
+        const int sortColIdx = sort ? table.getColumnIndex(orderByColumn) : -1;
+        std::vector<Value> sortKeys;
+        {
+            OperatorTimer timer(&scan);
+            auto visit = [&] {
+                scan.rowsIn++;
+                if (!where->evaluate(entry, table)) return;
+                Row& projection = results.rows.emplace_back();
+                projection.values.reserve(columnsToDisplay.size());
+                for (int colIdx : columnsToDisplay) {
+                    projection.values.push_back(entry.values[colIdx]);
+                }
+                project->bytesAllocated += approximateBytes(projection);
+                if (sort) sortKeys.push_back(entry.values[sortColIdx]);
+            };
+            for (const auto& range : plan.access.ranges) {
+                index.scanRange(range.low ? &*range.low : nullptr, range.lowInclusive, range.high ? &*range.high : nullptr,
+                                range.highInclusive, keyColumn, entry, visit);
+            }
+            scan.indexProbes = plan.access.ranges.size();
+            scan.rowsOut = filter->rowsIn = scan.rowsIn;
+            filter->rowsOut = project->rowsIn = project->rowsOut = results.rows.size();
+            project->bytesAllocated += results.rows.capacity() * sizeof(Row);
+        }
+
+        if (sort) {
+            OperatorTimer timer(sort);
+            std::vector<std::size_t> order(results.rows.size());
+            std::iota(order.begin(), order.end(), 0);
+            std::ranges::sort(order, [&](std::size_t a, std::size_t b) { return sortKeys[a] < sortKeys[b]; });
+            std::vector<Row> sorted;
+            sorted.reserve(order.size());
+            for (std::size_t i : order) sorted.push_back(std::move(results.rows[i]));
+            results.rows = std::move(sorted);
+            sort->rowsIn = sort->rowsOut = results.rows.size();
+        }
+        if (OperatorStats* distinct = plan.find("Distinct")) removeDuplicates(results, distinct);
+        return results;
+    }
+
+    std::string accessDetail(const Expression* where, const AccessPath& access) {
+        if (access.kind == AccessKind::FULL_SCAN) {
+            return where ? "filter: " + where->toString() : "";
+        }
+        const char* index = access.kind == AccessKind::TRIGRAM_SEARCH ? " trigram index: " : " index: ";
+        return "using " + access.column + index + access.predicate->toString();
+    }
+
+    bool mayMatchPartition(const PartitionScheme& scheme, std::size_t partition, const Expression* expr) {
+        if (auto comparison = dynamic_cast<const ComparisonExpression*>(expr)) {
+            return comparison->getColumnName() != scheme.column ||
+                   scheme.mayHold(partition, comparison->getOperator(), comparison->operand());
+        }
+        if (auto in = dynamic_cast<const InExpression*>(expr)) {
+            return in->getColumnName() != scheme.column || std::ranges::any_of(in->values(), [&](const Value& value) {
+                return scheme.mayHold(partition, "=", value);
+            });
+        }
+        if (auto between = dynamic_cast<const BetweenExpression*>(expr)) {
+            return between->getColumnName() != scheme.column || (scheme.mayHold(partition, ">=", between->lowValue()) &&
+                                                                 scheme.mayHold(partition, "<=", between->highValue()));
+        }
+        if (auto like = dynamic_cast<const LikeExpression*>(expr)) {
+            const std::string_view prefix = likePrefix(like->getPattern());
+            if (like->getColumnName() != scheme.column || prefix.empty()) return true;
+            const std::optional<std::string> successor = prefixSuccessor(prefix);
+            return scheme.mayHold(partition, ">=", Value(std::string(prefix), DataType::STRING)) &&
+                   (!successor || scheme.mayHold(partition, "<", Value(*successor, DataType::STRING)));
+        }
+        if (auto logical = dynamic_cast<const LogicalExpression*>(expr)) {
+            if (logical->getOperator() == "AND") {
+                return mayMatchPartition(scheme, partition, logical->getLeft()) &&
+                       mayMatchPartition(scheme, partition, logical->getRight());
+            }
+            if (logical->getOperator() == "OR") {
+                return mayMatchPartition(scheme, partition, logical->getLeft()) ||
+                       mayMatchPartition(scheme, partition, logical->getRight());
+            }
+        }
+        return true;
+    }
+
+    void addAccess(QueryPlan& plan, const Table& table, Expression* where);
+
+    // Every surviving partition chooses its own access path, from its own indexes and statistics.
+    void addPartitionAccess(QueryPlan& plan, const Table& table, Expression* where) {
+        plan.partitions = prunePartitions(table, where);
+        std::string detail = std::to_string(plan.partitions.size()) + " of " + std::to_string(table.getPartitions().size()) +
+                             " partitions";
+        double estimatedRows = 0;
+        for (std::size_t partition : plan.partitions) {
+            QueryPlan& partitionPlan = plan.partitionPlans.emplace_back();
+            addAccess(partitionPlan, table.getPartitions()[partition], where);
+            estimatedRows += partitionPlan.operators.back().estimatedRows;
+            detail += (partition == plan.partitions.front() ? ": p" : ", p") + std::to_string(partition) + " " +
+                      partitionPlan.operators.front().name;
+        }
+        if (where) detail += "; filter: " + where->toString();
+        plan.add("Partition Scan", detail).estimatedRows = estimatedRows;
+    }
+
+    void addAccess(QueryPlan& plan, const Table& table, Expression* where) {
+        if (table.isPartitioned()) {
+            addPartitionAccess(plan, table, where);
+            return;
+        }
+        orderPredicates(where, table);
+        plan.access = chooseAccessPath(table, where);
+        const double matchingRows = estimateSelectivity(table, where) * table.getRows().size();
+        switch (plan.access.kind) {
+            case AccessKind::FULL_SCAN:
+                plan.add("Seq Scan", accessDetail(where, plan.access));
+                break;
+            case AccessKind::INDEX_LOOKUP:
+                plan.add("Index Lookup", accessDetail(where, plan.access));
+                break;
+            case AccessKind::INDEX_MULTI_LOOKUP:
+                plan.add("Index Multi-Lookup", accessDetail(where, plan.access));
+                break;
+            case AccessKind::INDEX_RANGE:
+                plan.add("Index Range Scan", accessDetail(where, plan.access));
+                break;
+            case AccessKind::TRIGRAM_SEARCH:
+                plan.add("Trigram Index Scan", accessDetail(where, plan.access));
+                break;
+        }
+        plan.operators.back().estimatedRows =
+            plan.access.kind == AccessKind::FULL_SCAN ? matchingRows : plan.access.estimatedRows;
+        if (plan.access.kind != AccessKind::FULL_SCAN) {
+            plan.add("Filter", where->toString()).estimatedRows = matchingRows;
+        }
+    }
+}
+
+OperatorStats &QueryPlan::add(std::string name, std::string detail) {
+    OperatorStats& stats = operators.emplace_back();
+    stats.name = std::move(name);
+    stats.detail = std::move(detail);
+    return stats;
+}
+
+OperatorStats *QueryPlan::find(const std::string &name) {
+    for (auto& op : operators) {
+        if (op.name == name) return &op;
+    }
+    return nullptr;
+}
+
+double estimateSelectivity(const Table &table, const Expression *expr) {
+    if (!expr) return 1;
+    if (auto comparison = dynamic_cast<const ComparisonExpression*>(expr)) {
+        return valueSelectivity(table, comparison->getColumnName(), comparison->getOperator(), comparison->operand());
+    }
+    if (auto in = dynamic_cast<const InExpression*>(expr)) return inSelectivity(table, *in);
+    if (auto between = dynamic_cast<const BetweenExpression*>(expr)) return betweenSelectivity(table, *between);
+    if (auto like = dynamic_cast<const LikeExpression*>(expr)) return likeSelectivity(table, *like);
+    if (auto logical = dynamic_cast<const LogicalExpression*>(expr)) {
+        const double left = estimateSelectivity(table, logical->getLeft());
+        if (logical->getOperator() == "NOT") return 1 - left;
+        const double right = estimateSelectivity(table, logical->getRight());
+        if (logical->getOperator() == "AND") return left * right;
+        return left + right - left * right;
+    }
+    return 0.5;
+}
+
+void orderPredicates(Expression *where, const Table &table) {
+    auto logical = dynamic_cast<LogicalExpression*>(where);
+    if (!logical) return;
+    const std::string op = logical->getOperator();
+    if (op == "NOT") {
+        orderPredicates(logical->leftOperand().get(), table);
+        return;
+    }
+
+    std::vector<std::unique_ptr<Expression>> operands;
+    flattenChain(logical->leftOperand(), op, operands);
+    flattenChain(logical->rightOperand(), op, operands);
+
+    // An AND chain stops at the first false operand and an OR chain at the first true one:
+    // evaluate first the operands with the best chance of stopping per unit of work.
+    std::vector<std::pair<double, std::unique_ptr<Expression>>> ranked;
+    for (auto& operand : operands) {
+        orderPredicates(operand.get(), table);
+        const double selectivity = estimateSelectivity(table, operand.get());
+        const double stopChance = op == "AND" ? 1 - selectivity : selectivity;
+        ranked.emplace_back(stopChance / evaluationCost(operand.get()), std::move(operand));
+    }
+    std::ranges::stable_sort(ranked, std::greater<>(), [](const auto& entry) { return entry.first; });
+
+    logical->leftOperand() = std::move(ranked.front().second);
+    for (std::size_t i = 1; i + 1 < ranked.size(); i++) {
+        logical->leftOperand() = std::make_unique<LogicalExpression>(op, std::move(logical->leftOperand()),
+                                                                     std::move(ranked[i].second));
+    }
+    logical->rightOperand() = std::move(ranked.back().second);
+}
+
+AccessPath chooseAccessPath(const Table &table, const Expression *where) {
+    std::vector<const Expression*> conjuncts;
+    collectConjuncts(where, conjuncts);
+
+    const double tableRows = table.getRows().size();
+    const bool costBased = table.getStatistics() != nullptr;
+
+    AccessPath best;
+    best.estimatedRows = tableRows;
+    best.cost = tableRows * seqRowCost;
+    // Without statistics: a lookup over a multi-lookup over a range scan over a trigram search,
+    // the first of each kind.
+    auto precedence = [](AccessKind kind) {
+        return kind == AccessKind::FULL_SCAN ? std::numeric_limits<int>::max() : static_cast<int>(kind);
+    };
+    for (const Expression* conjunct : conjuncts) {
+        std::optional<AccessPath> candidate = indexAccess(table, conjunct);
+        if (!candidate) continue;
+
+        if (costBased) {
+            if (candidate->cost < best.cost) best = std::move(*candidate);
+        } else if (candidate->kind == AccessKind::INDEX_LOOKUP) {
+            return std::move(*candidate);
+        } else if (precedence(candidate->kind) < precedence(best.kind)) {
+            best = std::move(*candidate);
+        }
+    }
+    return best;
+}
+
+std::vector<std::size_t> prunePartitions(const Table &table, const Expression *where) {
+    std::vector<std::size_t> partitions;
+    for (std::size_t p = 0; p < table.getPartitions().size(); p++) {
+        if (!where || mayMatchPartition(table.getPartitioning(), p, where)) partitions.push_back(p);
+    }
+    return partitions;
+}
+
+QueryPlan planSelect(const Table &table, const std::vector<std::string> &columnNames, Expression *where,
+                     const std::string &orderByColumn, bool isDistinct) {
+    QueryPlan plan;
+    plan.statement = "Select";
+    plan.tableName = table.getName();
+    addAccess(plan, table, where);
+    if (!table.isPartitioned() && indexCovers(table, plan.access, columnNames, where, orderByColumn)) {
+        plan.access.indexOnly = true;
+        plan.operators.front().name = "Index Only Scan";
+    }
+
+    // An index-only scan already delivers its rows in key order.
+    const bool keyOrdered = plan.access.indexOnly && orderByColumn == plan.access.column;
+    if (!orderByColumn.empty() && table.getColumnIndex(orderByColumn) != -1 && !keyOrdered) {
+        plan.add("Sort", orderByColumn);
+    }
+    std::string projection;
+    for (const auto& name : columnNames) {
+        projection += (projection.empty() ? "" : ", ") + name;
+    }
+    plan.add("Project", projection);
+    if (isDistinct) plan.add("Distinct", "");
+    return plan;
+}
+
+QueryPlan planRemove(const Table &table, Expression *where) {
+    QueryPlan plan;
+    plan.statement = "Remove";
+    plan.tableName = table.getName();
+    addAccess(plan, table, where);
+    plan.add("Delete", "");
+    return plan;
+}
+
+QueryPlan planUpdate(const Table &table, Expression *where, const std::vector<Assignment> &assignments) {
+    QueryPlan plan;
+    plan.statement = "Update";
+    plan.tableName = table.getName();
+    addAccess(plan, table, where);
+    std::string assigned;
+    for (const auto& assignment : assignments) {
+        assigned += (assigned.empty() ? "" : ", ") + table.getColumns()[assignment.column].name;
+    }
+    plan.add("Update", assigned);
+    return plan;
+}
+
+std::vector<std::size_t> findMatchingRows(const Table &table, const Expression *where, QueryPlan &plan) {
+    const auto& rows = table.getRows();
+    std::vector<std::size_t> ids;
+
+    if (plan.access.kind == AccessKind::FULL_SCAN) {
+        OperatorStats& scan = plan.operators.front();
+        OperatorTimer timer(&scan);
+        for (std::size_t block = 0; block < table.getBlockCount(); block++) {
+            if (where && !where->mayMatchBlock(table, block)) {
+                scan.blocksSkipped++;
+                continue;
+            }
+            const std::size_t end = std::min(rows.size(), (block + 1) * Table::blockSize);
+            for (std::size_t i = block * Table::blockSize; i < end; i++) {
+                if (!where || where->evaluate(rows[i], table)) ids.push_back(i);
+            }
+            scan.rowsIn += end - block * Table::blockSize;
+        }
+        scan.rowsOut = ids.size();
+        scan.bytesAllocated = ids.capacity() * sizeof(std::size_t);
+        return ids;
+    }
+
+    {
+        OperatorStats& probe = plan.operators.front();
+        OperatorTimer timer(&probe);
+        ids = probeIndex(table, plan.access);
+        std::ranges::sort(ids);
+        probe.indexProbes = plan.access.kind == AccessKind::TRIGRAM_SEARCH ? plan.access.trigrams.size() : plan.access.ranges.size();
+        probe.rowsIn = ids.size();
+        probe.rowsOut = ids.size();
+        probe.bytesAllocated = ids.capacity() * sizeof(std::size_t);
+    }
+
+    OperatorStats* filter = plan.find("Filter");
+    OperatorTimer timer(filter);
+    filter->rowsIn = ids.size();
+    std::erase_if(ids, [&](std::size_t id) { return !where->evaluate(rows[id], table); });
+    filter->rowsOut = ids.size();
+    return ids;
+}
+
+std::vector<std::vector<std::size_t>> findPartitionMatches(const Table &table, const Expression *where, QueryPlan &plan) {
+    OperatorStats& scan = plan.operators.front();
+    std::vector<std::vector<std::size_t>> matches;
+    matches.reserve(plan.partitions.size());
+    for (std::size_t i = 0; i < plan.partitions.size(); i++) {
+        QueryPlan& partitionPlan = plan.partitionPlans[i];
+        matches.push_back(findMatchingRows(table.getPartitions()[plan.partitions[i]], where, partitionPlan));
+        scan.rowsIn += partitionPlan.operators.front().rowsIn;
+        scan.rowsOut += matches.back().size();
+        for (const auto& op : partitionPlan.operators) {
+            scan.seconds += op.seconds;
+            scan.indexProbes += op.indexProbes;
+            scan.blocksSkipped += op.blocksSkipped;
+            scan.bytesAllocated += op.bytesAllocated;
+        }
+    }
+    return matches;
+}
+
+ResultSet executeSelect(const Table &table, const std::vector<std::string> &columnNames, const Expression *where,
+                        const std::string &orderByColumn, QueryPlan &plan) {
+    const std::vector<int> columnsToDisplay = displayColumns(table, columnNames);
+    if (plan.access.indexOnly) return executeIndexOnly(table, columnsToDisplay, where, orderByColumn, plan);
+
+    // The matching rows wherever they are stored: in the table, or in the partitions that survived pruning.
+    std::vector<const Row*> matched;
+    if (table.isPartitioned()) {
+        const auto matches = findPartitionMatches(table, where, plan);
+        for (std::size_t i = 0; i < matches.size(); i++) {
+            const auto& rows = table.getPartitions()[plan.partitions[i]].getRows();
+            for (std::size_t id : matches[i]) matched.push_back(&rows[id]);
+        }
+    } else {
+        const auto& rows = table.getRows();
+        const std::vector<std::size_t> ids = findMatchingRows(table, where, plan);
+        matched.reserve(ids.size());
+        for (std::size_t id : ids) matched.push_back(&rows[id]);
+    }
+
+    if (OperatorStats* sort = plan.find("Sort")) {
+        OperatorTimer timer(sort);
+        const int sortColIdx = table.getColumnIndex(orderByColumn);
+        std::ranges::sort(matched, [&](const Row* a, const Row* b) {
+            return a->values[sortColIdx] < b->values[sortColIdx];
+        });
+        sort->rowsIn = sort->rowsOut = matched.size();
+    }
+
+    ResultSet results;
+    for (int colIdx : columnsToDisplay) {
+        results.columns.push_back({table.getColumns()[colIdx].name, table.getColumns()[colIdx].type});
+    }
+
+    {
+        OperatorStats* project = plan.find("Project");
+        OperatorTimer timer(project);
+        results.rows.reserve(matched.size());
+        for (const Row* row : matched) {
+            Row& projection = results.rows.emplace_back();
+            projection.values.reserve(columnsToDisplay.size());
+            for (int colIdx : columnsToDisplay) {
+                projection.values.push_back(row->values[colIdx]);
+            }
+            project->bytesAllocated += approximateBytes(projection);
+        }
+        project->rowsIn = matched.size();
+        project->rowsOut = results.rows.size();
+        project->bytesAllocated += results.rows.capacity() * sizeof(Row);
+    }
+
+    if (OperatorStats* distinct = plan.find("Distinct")) removeDuplicates(results, distinct);
+    return results;
+}
+
+std::size_t approximateBytes(const Row &row) {
+    std::size_t bytes = sizeof(Row) + row.values.capacity() * sizeof(Value);
+    for (const auto& value : row.values) {
+        if (value.strValue.capacity() > std::string().capacity()) bytes += value.strValue.capacity() + 1;
+    }
+    return bytes;
+}
+
+void printPlan(std::ostream &out, const QueryPlan &plan) {
+    out << plan.statement << " on " << plan.tableName << "\n";
+
+    std::size_t indent = 0;
+    for (auto it = plan.operators.rbegin(); it != plan.operators.rend(); ++it) {
+        out << std::string(indent, ' ') << "-> " << it->name;
+        if (!it->detail.empty()) out << " (" << it->detail << ")";
+        if (it->estimatedRows >= 0) out << " [est. rows=" << std::llround(it->estimatedRows) << "]";
+        if (plan.analyzed) {
+            char timing[32];
+            std::snprintf(timing, sizeof(timing), "%.3f", it->seconds * 1000);
+            out << "  [time=" << timing << " ms, rows in=" << it->rowsIn << ", rows out=" << it->rowsOut
+                << ", index probes=" << it->indexProbes << ", blocks skipped=" << it->blocksSkipped
+                << ", bytes=" << it->bytesAllocated << "]";
+        }
+        out << "\n";
+        indent += 3;
+    }
+}
\ No newline at end of file
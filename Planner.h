@@ -0,0 +1,107 @@
+#ifndef PROEKT_PLANNER_H
+#define PROEKT_PLANNER_H
+
+#include <chrono>
+#include <optional>
+#include <ostream>
+#include "Expression.h"
+#include "ResultSet.h"
+
+enum class AccessKind { FULL_SCAN, INDEX_LOOKUP, INDEX_MULTI_LOOKUP, INDEX_RANGE, TRIGRAM_SEARCH };
+
+// An interval of index keys; an absent bound leaves that side open.
+struct KeyRange {
+    std::optional<Value> low, high;
+    bool lowInclusive = false, highInclusive = false;
+};
+
+// Where candidate rows come from: a scan of the whole table, or the index on `column` probed
+// for the key ranges one conjunct of the WHERE clause allows (several for an IN list, ascending
+// and disjoint), or the trigram index on `column` probed for the trigrams of a LIKE pattern.
+// Candidates of an index probe are re-checked by a Filter.
+// An index-only probe reads every column the query needs from a covering index (keys and
+// INCLUDE values) and never touches the rows.
+struct AccessPath {
+    AccessKind kind = AccessKind::FULL_SCAN;
+    const Expression* predicate = nullptr;
+    std::string column;
+    std::vector<KeyRange> ranges;
+    std::vector<uint32_t> trigrams; // TRIGRAM_SEARCH only, distinct
+    bool indexOnly = false;
+    double estimatedRows = 0; // rows the access path produces, before any Filter
+    double cost = 0;          // in units of one sequential row visit
+};
+
+struct OperatorStats {
+    std::string name;
+    std::string detail;
+    double seconds = 0;
+    std::size_t rowsIn = 0;
+    std::size_t rowsOut = 0;
+    std::size_t indexProbes = 0;
+    std::size_t blocksSkipped = 0; // zone-map blocks a scan never visited
+    std::size_t bytesAllocated = 0; // heap bytes of the operator's output, estimated from container capacities
+    double estimatedRows = -1;      // planner's output estimate, negative when the operator has none
+};
+
+// Operators in execution order: the access path first, the operator producing the final output last.
+struct QueryPlan {
+    std::string statement;
+    std::string tableName;
+    AccessPath access;
+    std::vector<OperatorStats> operators;
+    bool analyzed = false;
+    // A partitioned table is planned partition by partition: the partitions left after pruning,
+    // ascending, and the plan of each in the same order. `operators` then starts with a single
+    // Partition Scan that adds up their counters.
+    std::vector<std::size_t> partitions;
+    std::vector<QueryPlan> partitionPlans;
+
+    OperatorStats& add(std::string name, std::string detail);
+    OperatorStats* find(const std::string& name);
+};
+
+// Adds the wall time of its scope to an operator.
+class OperatorTimer {
+    OperatorStats* stats;
+    std::chrono::steady_clock::time_point start;
+
+public:
+    explicit OperatorTimer(OperatorStats* stats) : stats(stats), start(std::chrono::steady_clock::now()) {}
+    ~OperatorTimer() {
+        if (stats) stats->seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+};
+
+// Fraction of the table's rows expected to satisfy `expr`, from ANALYZE statistics when the
+// table has them and from fixed guesses otherwise.
+double estimateSelectivity(const Table& table, const Expression* expr);
+
+// Reorders the operands of every AND/OR chain so the ones most likely to decide the result
+// cheaply are evaluated first.
+void orderPredicates(Expression* where, const Table& table);
+
+// Without statistics an index is always preferred (equality over ranges); with them the cheapest
+// of a full scan and every indexable conjunct wins.
+AccessPath chooseAccessPath(const Table& table, const Expression* where);
+
+// Partitions of a partitioned table that may hold rows satisfying `where`, ascending.
+std::vector<std::size_t> prunePartitions(const Table& table, const Expression* where);
+
+// Planning reorders `where` in place (see orderPredicates).
+QueryPlan planSelect(const Table& table, const std::vector<std::string>& columnNames, Expression* where,
+                     const std::string& orderByColumn, bool isDistinct);
+QueryPlan planRemove(const Table& table, Expression* where);
+QueryPlan planUpdate(const Table& table, Expression* where, const std::vector<Assignment>& assignments);
+
+// Ids of the rows satisfying `where`, ascending, produced through the plan's access path.
+std::vector<std::size_t> findMatchingRows(const Table& table, const Expression* where, QueryPlan& plan);
+// For a partitioned table: the matching rows of each partition in plan.partitions, in that order.
+std::vector<std::vector<std::size_t>> findPartitionMatches(const Table& table, const Expression* where, QueryPlan& plan);
+ResultSet executeSelect(const Table& table, const std::vector<std::string>& columnNames, const Expression* where,
+                        const std::string& orderByColumn, QueryPlan& plan);
+
+std::size_t approximateBytes(const Row& row);
+void printPlan(std::ostream& out, const QueryPlan& plan);
+
+#endif //PROEKT_PLANNER_H
\ No newline at end of file
@@ -0,0 +1,79 @@
+#include "Protocol.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <sys/socket.h>
+
+void appendFrame(std::string &buffer, std::string_view payload) {
+    if (payload.size() > maxFrameSize) {
+        throw std::length_error("Frame too large");
+    }
+    const auto len = static_cast<uint32_t>(payload.size());
+    const char header[frameHeaderSize] = {
+        static_cast<char>(len >> 24), static_cast<char>(len >> 16),
+        static_cast<char>(len >> 8), static_cast<char>(len)
+    };
+    buffer.append(header, frameHeaderSize);
+    buffer.append(payload);
+}
+
+bool extractFrame(const std::string &buffer, std::size_t &offset, std::string &payload) {
+    if (buffer.size() - offset < frameHeaderSize) return false;
+
+    uint32_t len = 0;
+    for (std::size_t i = 0; i < frameHeaderSize; i++) {
+        len = (len << 8) | static_cast<uint8_t>(buffer[offset + i]);
+    }
+    if (len > maxFrameSize) {
+        throw std::length_error("Frame too large");
+    }
+    if (buffer.size() - offset - frameHeaderSize < len) return false;
+
+    payload.assign(buffer, offset + frameHeaderSize, len);
+    offset += frameHeaderSize + len;
+    return true;
+}
+
+void sendFrame(int fd, std::string_view payload) {
+    std::string frame;
+    appendFrame(frame, payload);
+
+    std::size_t sent = 0;
+    while (sent < frame.size()) {
+        ssize_t n = ::send(fd, frame.data() + sent, frame.size() - sent, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            throw std::runtime_error(std::string("send failed: ") + std::strerror(errno));
+        }
+        sent += static_cast<std::size_t>(n);
+    }
+}
+
+bool receiveFrame(int fd, std::string &payload) {
+    std::string buffer;
+    std::size_t offset = 0;
+    char chunk[64 * 1024];
+
+    while (!extractFrame(buffer, offset, payload)) {
+        // Never read past the current frame: the bytes after it belong to the next call.
+        std::size_t want = frameHeaderSize;
+        if (buffer.size() >= frameHeaderSize) {
+            uint32_t len = 0;
+            for (std::size_t i = 0; i < frameHeaderSize; i++) {
+                len = (len << 8) | static_cast<uint8_t>(buffer[i]);
+            }
+            want += len;
+        }
+        std::size_t toRead = std::min(sizeof(chunk), want - buffer.size());
+
+        ssize_t n = ::recv(fd, chunk, toRead, 0);
+        if (n == 0) return false;
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            throw std::runtime_error(std::string("recv failed: ") + std::strerror(errno));
+        }
+        buffer.append(chunk, static_cast<std::size_t>(n));
+    }
+    return true;
+}
\ No newline at end of file
@@ -0,0 +1,19 @@
+#ifndef PROEKT_PROTOCOL_H
+#define PROEKT_PROTOCOL_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// Wire format shared by the server and the client: every message is a 4-byte big-endian
+// payload length followed by the payload (a statement on the way in, its output on the way out).
+constexpr std::size_t frameHeaderSize = sizeof(uint32_t);
+constexpr std::size_t maxFrameSize = 64 * 1024 * 1024;
+
+void appendFrame(std::string& buffer, std::string_view payload);
+bool extractFrame(const std::string& buffer, std::size_t& offset, std::string& payload);
+
+void sendFrame(int fd, std::string_view payload);
+bool receiveFrame(int fd, std::string& payload);
+
+#endif //PROEKT_PROTOCOL_H
\ No newline at end of file
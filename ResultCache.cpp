@@ -0,0 +1,82 @@
+#include "ResultCache.h"
+
+void ResultCache::erase(std::list<Entry>::iterator entry) {
+    bytes -= entry->bytes;
+    lookup.erase(entry->key);
+    entries.erase(entry);
+}
+
+bool ResultCache::isEnabled() const {
+    return budget > 0;
+}
+
+std::shared_ptr<const ResultSet> ResultCache::find(const std::string &key, uint64_t tableVersion) {
+    auto it = lookup.find(key);
+    if (it == lookup.end()) {
+        ++misses;
+        return nullptr;
+    }
+    if (it->second->tableVersion != tableVersion) {
+        // Computed before the table last changed.
+        erase(it->second);
+        ++misses;
+        return nullptr;
+    }
+    entries.splice(entries.begin(), entries, it->second);
+    ++hits;
+    return it->second->result;
+}
+
+void ResultCache::put(const std::string &key, uint64_t tableVersion, const ResultSet &result) {
+    const std::size_t entryBytes = resultBytes(result) + 2 * key.size();
+    if (entryBytes > budget) return;
+
+    if (auto it = lookup.find(key); it != lookup.end()) erase(it->second);
+    entries.push_front({key, tableVersion, std::make_shared<const ResultSet>(result), entryBytes});
+    lookup[key] = entries.begin();
+    bytes += entryBytes;
+
+    while (bytes > budget) erase(std::prev(entries.end()));
+}
+
+void ResultCache::setBudget(std::size_t newBudget) {
+    budget = newBudget;
+    while (bytes > budget) erase(std::prev(entries.end()));
+}
+
+void ResultCache::clear() {
+    entries.clear();
+    lookup.clear();
+    bytes = 0;
+}
+
+std::size_t ResultCache::size() const {
+    return entries.size();
+}
+
+std::size_t ResultCache::getBytes() const {
+    return bytes;
+}
+
+std::size_t ResultCache::getBudget() const {
+    return budget;
+}
+
+std::size_t ResultCache::getHits() const {
+    return hits;
+}
+
+std::size_t ResultCache::getMisses() const {
+    return misses;
+}
+
+std::size_t ResultCache::resultBytes(const ResultSet &result) {
+    std::size_t total = sizeof(ResultSet) + result.columns.capacity() * sizeof(ResultColumn) +
+                        result.rows.capacity() * sizeof(Row);
+    for (const auto& column : result.columns) total += stringHeapBytes(column.name);
+    for (const auto& row : result.rows) {
+        total += row.values.capacity() * sizeof(Value);
+        for (const auto& value : row.values) total += stringHeapBytes(value.strValue);
+    }
+    return total;
+}
\ No newline at end of file
@@ -0,0 +1,48 @@
+#ifndef PROEKT_RESULTCACHE_H
+#define PROEKT_RESULTCACHE_H
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include "ResultSet.h"
+
+// LRU of SELECT results keyed by normalized query text. Each entry remembers the version of the
+// table it was computed from; a lookup against any other version is a miss, so results never
+// outlive a write. Entries are evicted from the least recently used end to stay within `budget`
+// bytes; a budget of 0 disables the cache.
+class ResultCache {
+    struct Entry {
+        std::string key;
+        uint64_t tableVersion;
+        std::shared_ptr<const ResultSet> result;
+        std::size_t bytes;
+    };
+
+    std::list<Entry> entries; // most recently used first
+    std::unordered_map<std::string, std::list<Entry>::iterator> lookup;
+    std::size_t budget;
+    std::size_t bytes = 0;
+    std::size_t hits = 0;
+    std::size_t misses = 0;
+
+    void erase(std::list<Entry>::iterator entry);
+
+public:
+    explicit ResultCache(std::size_t budget = 0) : budget(budget) {}
+
+    bool isEnabled() const;
+    std::shared_ptr<const ResultSet> find(const std::string& key, uint64_t tableVersion);
+    void put(const std::string& key, uint64_t tableVersion, const ResultSet& result);
+    void setBudget(std::size_t budget);
+    void clear();
+    std::size_t size() const;
+    std::size_t getBytes() const;
+    std::size_t getBudget() const;
+    std::size_t getHits() const;
+    std::size_t getMisses() const;
+
+    static std::size_t resultBytes(const ResultSet& result);
+};
+
+#endif //PROEKT_RESULTCACHE_H
\ No newline at end of file
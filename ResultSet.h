@@ -0,0 +1,21 @@
+#ifndef PROEKT_RESULTSET_H
+#define PROEKT_RESULTSET_H
+
+#include "Data.h"
+
+struct ResultColumn {
+    std::string name;
+    DataType type;
+};
+
+// Typed output of a SELECT: the projected columns and the rows, in result order.
+struct ResultSet {
+    std::vector<ResultColumn> columns;
+    std::vector<Row> rows;
+
+    std::size_t size() const { return rows.size(); }
+    bool empty() const { return rows.empty(); }
+    const Value& at(const std::size_t row, const std::size_t column) const { return rows.at(row).values.at(column); }
+};
+
+#endif //PROEKT_RESULTSET_H
\ No newline at end of file
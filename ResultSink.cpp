@@ -0,0 +1,195 @@
+#include "ResultSink.h"
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include "Csv.h"
+#include "Lexer.h"
+
+namespace {
+    template <typename T>
+    void appendRaw(std::string& buffer, T value) {
+        char bytes[sizeof(T)];
+        std::memcpy(bytes, &value, sizeof(T));
+        buffer.append(bytes, sizeof(T));
+    }
+
+    void appendJsonString(std::string& buffer, const std::string& text) {
+        buffer += '"';
+        for (char c : text) {
+            switch (c) {
+                case '"': buffer += "\\\""; break;
+                case '\\': buffer += "\\\\"; break;
+                case '\n': buffer += "\\n"; break;
+                case '\r': buffer += "\\r"; break;
+                case '\t': buffer += "\\t"; break;
+                default:
+                    if (static_cast<unsigned char>(c) < 0x20) {
+                        char escape[8];
+                        std::snprintf(escape, sizeof(escape), "\\u%04x", c);
+                        buffer += escape;
+                    } else {
+                        buffer += c;
+                    }
+            }
+        }
+        buffer += '"';
+    }
+}
+
+OutputFormat parseOutputFormat(const std::string &name) {
+    if (equalsIgnoreCase(name, "TABLE")) return OutputFormat::TABLE;
+    if (equalsIgnoreCase(name, "CSV")) return OutputFormat::CSV;
+    if (equalsIgnoreCase(name, "JSON")) return OutputFormat::JSON;
+    if (equalsIgnoreCase(name, "BINARY")) return OutputFormat::BINARY;
+    throw std::runtime_error("Unknown output format: " + name);
+}
+
+ResultSink::ResultSink(std::ostream &out) : out(out) {
+    buffer.reserve(bufferSize);
+}
+
+ResultSink::~ResultSink() = default;
+
+void ResultSink::flushIfFull() {
+    if (buffer.size() >= bufferSize) flush();
+}
+
+void ResultSink::flush() {
+    out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    buffer.clear();
+}
+
+void ResultSink::write(const ResultSet &result) {
+    begin(result.columns);
+    for (const auto& r : result.rows) {
+        row(r);
+    }
+    end(result.rows.size());
+}
+
+void TableSink::begin(const std::vector<ResultColumn> &columns) {
+    widths.clear();
+    for (const auto& col : columns) {
+        buffer += '|';
+        buffer += col.name;
+        widths.push_back(col.name.length());
+    }
+    buffer += "|\n";
+    for (std::size_t width : widths) {
+        buffer.append(width + 1, '-');
+    }
+    buffer += '\n';
+}
+
+void TableSink::row(const Row &row) {
+    for (std::size_t i = 0; i < row.values.size(); i++) {
+        std::string text = row.values[i].toString();
+        buffer += '|';
+        if (text.size() < widths[i]) buffer.append(widths[i] - text.size(), ' ');
+        buffer += text;
+    }
+    buffer += "|\n";
+    flushIfFull();
+}
+
+void TableSink::end(std::size_t rowCount) {
+    buffer += "Total " + std::to_string(rowCount) + " row" + (rowCount == 1 ? "" : "s") + " selected\n";
+    flush();
+}
+
+void CsvSink::begin(const std::vector<ResultColumn> &resultColumns) {
+    columns = resultColumns;
+    for (std::size_t i = 0; i < columns.size(); i++) {
+        if (i > 0) buffer += ',';
+        appendCsvField(buffer, Value(columns[i].name), DataType::STRING);
+    }
+    buffer += '\n';
+}
+
+void CsvSink::row(const Row &row) {
+    for (std::size_t i = 0; i < row.values.size(); i++) {
+        if (i > 0) buffer += ',';
+        appendCsvField(buffer, row.values[i], columns[i].type);
+    }
+    buffer += '\n';
+    flushIfFull();
+}
+
+void CsvSink::end(std::size_t) {
+    flush();
+}
+
+void JsonLinesSink::begin(const std::vector<ResultColumn> &columns) {
+    keys.clear();
+    for (const auto& col : columns) {
+        std::string key;
+        appendJsonString(key, col.name);
+        keys.push_back(key + ':');
+    }
+}
+
+void JsonLinesSink::row(const Row &row) {
+    buffer += '{';
+    for (std::size_t i = 0; i < row.values.size(); i++) {
+        if (i > 0) buffer += ',';
+        buffer += keys[i];
+        const Value& value = row.values[i];
+        if (value.type != DataType::DOUBLE) {
+            appendJsonString(buffer, value.strValue);
+        } else if (!std::isfinite(value.numValue)) {
+            buffer += "null";
+        } else {
+            char digits[32];
+            auto [end, ec] = std::to_chars(digits, digits + sizeof(digits), value.numValue);
+            buffer.append(digits, end);
+        }
+    }
+    buffer += "}\n";
+    flushIfFull();
+}
+
+void JsonLinesSink::end(std::size_t) {
+    flush();
+}
+
+void BinarySink::begin(const std::vector<ResultColumn> &columns) {
+    types.clear();
+    buffer += "FMIR";
+    appendRaw(buffer, static_cast<uint32_t>(columns.size()));
+    for (const auto& col : columns) {
+        appendRaw(buffer, static_cast<uint8_t>(col.type));
+        appendRaw(buffer, static_cast<uint32_t>(col.name.size()));
+        buffer += col.name;
+        types.push_back(col.type);
+    }
+}
+
+void BinarySink::row(const Row &row) {
+    appendRaw(buffer, static_cast<uint8_t>(1));
+    for (std::size_t i = 0; i < row.values.size(); i++) {
+        if (types[i] == DataType::DOUBLE) {
+            appendRaw(buffer, row.values[i].numValue);
+        } else {
+            appendRaw(buffer, static_cast<uint32_t>(row.values[i].strValue.size()));
+            buffer += row.values[i].strValue;
+        }
+    }
+    flushIfFull();
+}
+
+void BinarySink::end(std::size_t rowCount) {
+    appendRaw(buffer, static_cast<uint8_t>(0));
+    appendRaw(buffer, static_cast<uint64_t>(rowCount));
+    flush();
+}
+
+std::unique_ptr<ResultSink> makeSink(OutputFormat format, std::ostream &out) {
+    switch (format) {
+        case OutputFormat::TABLE: return std::make_unique<TableSink>(out);
+        case OutputFormat::CSV: return std::make_unique<CsvSink>(out);
+        case OutputFormat::JSON: return std::make_unique<JsonLinesSink>(out);
+        case OutputFormat::BINARY: return std::make_unique<BinarySink>(out);
+    }
+    throw std::runtime_error("Unknown output format");
+}
\ No newline at end of file
@@ -0,0 +1,86 @@
+#ifndef PROEKT_RESULTSINK_H
+#define PROEKT_RESULTSINK_H
+
+#include <memory>
+#include <ostream>
+#include "ResultSet.h"
+
+enum class OutputFormat { TABLE, CSV, JSON, BINARY };
+
+OutputFormat parseOutputFormat(const std::string& name);
+
+// Formats results into a large in-memory buffer and hands it to the stream in big writes,
+// never flushing the stream per row.
+class ResultSink {
+    std::ostream& out;
+
+protected:
+    static constexpr std::size_t bufferSize = 64 * 1024;
+    std::string buffer;
+
+    void flushIfFull();
+
+public:
+    explicit ResultSink(std::ostream& out);
+    virtual ~ResultSink();
+    ResultSink(const ResultSink&) = delete;
+    ResultSink& operator=(const ResultSink&) = delete;
+
+    virtual void begin(const std::vector<ResultColumn>& columns) = 0;
+    virtual void row(const Row& row) = 0;
+    virtual void end(std::size_t rowCount) = 0;
+
+    void write(const ResultSet& result);
+    void flush();
+};
+
+// The interactive |col|col| layout, each value right-aligned to its column name.
+class TableSink : public ResultSink {
+    std::vector<std::size_t> widths;
+
+public:
+    using ResultSink::ResultSink;
+    void begin(const std::vector<ResultColumn>& columns) override;
+    void row(const Row& row) override;
+    void end(std::size_t rowCount) override;
+};
+
+// RFC 4180 style CSV with a header line, the same dialect IMPORT/EXPORT use.
+class CsvSink : public ResultSink {
+    std::vector<ResultColumn> columns;
+
+public:
+    using ResultSink::ResultSink;
+    void begin(const std::vector<ResultColumn>& columns) override;
+    void row(const Row& row) override;
+    void end(std::size_t rowCount) override;
+};
+
+// One JSON object per row, keyed by column name.
+class JsonLinesSink : public ResultSink {
+    std::vector<std::string> keys;
+
+public:
+    using ResultSink::ResultSink;
+    void begin(const std::vector<ResultColumn>& columns) override;
+    void row(const Row& row) override;
+    void end(std::size_t rowCount) override;
+};
+
+// Compact little-endian encoding:
+//   "FMIR" u32 columnCount { u8 type, u32 nameLength, name }...
+//   { u8 1, values... }... u8 0, u64 rowCount
+// where a DOUBLE value is 8 raw bytes and STRING/DATE values are u32 length + bytes.
+class BinarySink : public ResultSink {
+    std::vector<DataType> types;
+
+public:
+    using ResultSink::ResultSink;
+    void begin(const std::vector<ResultColumn>& columns) override;
+    void row(const Row& row) override;
+    void end(std::size_t rowCount) override;
+};
+
+std::unique_ptr<ResultSink> makeSink(OutputFormat format, std::ostream& out);
+
+#endif //PROEKT_RESULTSINK_H
\ No newline at end of file
@@ -0,0 +1,307 @@
+#include "Server.h"
+#include "Commands.h"
+#include "Protocol.h"
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+    std::runtime_error systemError(const std::string& what) {
+        return std::runtime_error(what + ": " + std::strerror(errno));
+    }
+
+    void setNonBlocking(int fd) {
+        int flags = fcntl(fd, F_GETFL, 0);
+        if (flags < 0 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0) {
+            throw systemError("fcntl failed");
+        }
+    }
+}
+
+Server::Server(Database &db, ServerConfig config) : db(db), config(std::move(config)) {
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (epollFd < 0) throw systemError("epoll_create1 failed");
+
+    wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wakeFd < 0) throw systemError("eventfd failed");
+
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.fd = wakeFd;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeFd, &ev);
+
+    openListener();
+    db.setGroupCommit(true);
+}
+
+Server::~Server() {
+    try {
+        db.setGroupCommit(false);
+    } catch (const std::exception &e) {
+        std::cerr << "Final flush failed: " << e.what() << std::endl;
+    }
+    for (auto &fd : connections | std::views::keys) {
+        close(fd);
+    }
+    if (listenFd >= 0) close(listenFd);
+    if (wakeFd >= 0) close(wakeFd);
+    if (epollFd >= 0) close(epollFd);
+    if (!config.unixSocketPath.empty()) unlink(config.unixSocketPath.c_str());
+}
+
+void Server::openListener() {
+    if (!config.unixSocketPath.empty()) {
+        sockaddr_un addr{};
+        if (config.unixSocketPath.size() >= sizeof(addr.sun_path)) {
+            throw std::runtime_error("Socket path too long: " + config.unixSocketPath);
+        }
+        addr.sun_family = AF_UNIX;
+        std::strcpy(addr.sun_path, config.unixSocketPath.c_str());
+
+        listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (listenFd < 0) throw systemError("socket failed");
+        unlink(config.unixSocketPath.c_str());
+        if (bind(listenFd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+            throw systemError("bind to " + config.unixSocketPath + " failed");
+        }
+    } else {
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(config.port);
+        if (inet_pton(AF_INET, config.host.c_str(), &addr.sin_addr) != 1) {
+            throw std::runtime_error("Invalid listen address: " + config.host);
+        }
+
+        listenFd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (listenFd < 0) throw systemError("socket failed");
+        int reuse = 1;
+        setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+        if (bind(listenFd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+            throw systemError("bind to " + config.host + ":" + std::to_string(config.port) + " failed");
+        }
+    }
+
+    if (listen(listenFd, SOMAXCONN) < 0) throw systemError("listen failed");
+    setNonBlocking(listenFd);
+
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.fd = listenFd;
+    if (epoll_ctl(epollFd, EPOLL_CTL_ADD, listenFd, &ev) < 0) throw systemError("epoll_ctl failed");
+}
+
+uint16_t Server::getPort() const {
+    sockaddr_in addr{};
+    socklen_t len = sizeof(addr);
+    if (!config.unixSocketPath.empty() || getsockname(listenFd, reinterpret_cast<sockaddr*>(&addr), &len) < 0) {
+        return 0;
+    }
+    return ntohs(addr.sin_port);
+}
+
+void Server::run() {
+    running = true;
+    epoll_event events[64];
+
+    while (running) {
+        int ready = epoll_wait(epollFd, events, 64, -1);
+        if (ready < 0) {
+            if (errno == EINTR) continue;
+            throw systemError("epoll_wait failed");
+        }
+
+        for (int e = 0; e < ready; e++) {
+            const int fd = events[e].data.fd;
+            const uint32_t flags = events[e].events;
+
+            if (fd == listenFd) {
+                acceptConnections();
+                continue;
+            }
+            if (fd == wakeFd) {
+                uint64_t counter;
+                while (read(wakeFd, &counter, sizeof(counter)) > 0) {}
+                continue;
+            }
+
+            if (flags & (EPOLLIN | EPOLLHUP | EPOLLERR)) {
+                auto it = connections.find(fd);
+                if (it != connections.end()) handleReadable(it->second);
+            }
+            if (flags & EPOLLOUT) {
+                auto it = connections.find(fd);
+                if (it != connections.end()) handleWritable(it->second);
+            }
+        }
+        flushAndReply();
+    }
+}
+
+void Server::flushAndReply() {
+    // Group commit: everything the clients of this wakeup committed goes to disk in one write,
+    // and nobody hears back before it is durable. If the write fails, their replies would claim
+    // changes that are not on disk, so each is answered with the error instead.
+    std::string failure;
+    try {
+        db.flush();
+    } catch (const std::exception &e) {
+        std::cerr << "Flush failed: " << e.what() << std::endl;
+        failure = e.what();
+    }
+
+    std::vector<int> ready;
+    ready.swap(pendingReplies);
+    for (int fd : ready) {
+        auto it = connections.find(fd);
+        if (it == connections.end()) continue;
+        Connection& conn = it->second;
+        if (!failure.empty() && conn.heldReplies > 0) {
+            conn.output.resize(conn.durableOutput);
+            for (std::size_t i = 0; i < conn.heldReplies; i++) {
+                appendFrame(conn.output, "Error: changes could not be written to disk: " + failure + "\n");
+            }
+        }
+        conn.durableOutput = conn.output.size();
+        conn.heldReplies = 0;
+        handleWritable(conn);
+    }
+}
+
+void Server::stop() {
+    running = false;
+    uint64_t one = 1;
+    [[maybe_unused]] auto written = write(wakeFd, &one, sizeof(one));
+}
+
+void Server::acceptConnections() {
+    while (true) {
+        int fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR) continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                std::cerr << "accept failed: " << std::strerror(errno) << std::endl;
+            }
+            return;
+        }
+
+        epoll_event ev{};
+        ev.events = EPOLLIN;
+        ev.data.fd = fd;
+        if (epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+            close(fd);
+            continue;
+        }
+        Connection& conn = connections[fd];
+        conn.fd = fd;
+        conn.session = std::make_unique<Session>(db, statementCache);
+    }
+}
+
+void Server::handleReadable(Connection &conn) {
+    const int fd = conn.fd;
+    char chunk[64 * 1024];
+    bool peerClosed = false; // the peer shut down its write side; it may still read our replies
+    bool failed = false;
+
+    while (true) {
+        ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+        if (n > 0) {
+            conn.input.append(chunk, static_cast<std::size_t>(n));
+            continue;
+        }
+        if (n == 0) {
+            peerClosed = true;
+        } else if (errno == EINTR) {
+            continue;
+        } else if (errno != EAGAIN && errno != EWOULDBLOCK) {
+            failed = true;
+        }
+        break;
+    }
+
+    try {
+        std::string statement;
+        while (!conn.closing && extractFrame(conn.input, conn.inputOffset, statement)) {
+            std::ostringstream out;
+            if (!processCommand(*conn.session, statement, out)) {
+                conn.closing = true;
+            }
+            appendFrame(conn.output, out.str());
+            conn.heldReplies++;
+        }
+    } catch (const std::exception &e) {
+        std::cerr << "Dropping client " << fd << ": " << e.what() << std::endl;
+        closeConnection(fd);
+        return;
+    }
+    conn.input.erase(0, conn.inputOffset);
+    conn.inputOffset = 0;
+
+    if (failed) {
+        closeConnection(fd);
+        return;
+    }
+    if (peerClosed && !conn.closing) {
+        // Nothing more will arrive: stop watching for input (an EOF stays readable) and close
+        // once the replies to what was sent have drained.
+        conn.closing = true;
+        epoll_event ev{};
+        ev.data.fd = fd;
+        epoll_ctl(epollFd, EPOLL_CTL_MOD, fd, &ev);
+    }
+    pendingReplies.push_back(fd);
+}
+
+void Server::handleWritable(Connection &conn) {
+    const int fd = conn.fd;
+
+    while (conn.outputOffset < conn.durableOutput) {
+        ssize_t n = send(fd, conn.output.data() + conn.outputOffset,
+                         conn.durableOutput - conn.outputOffset, MSG_NOSIGNAL);
+        if (n >= 0) {
+            conn.outputOffset += static_cast<std::size_t>(n);
+            continue;
+        }
+        if (errno == EINTR) continue;
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            if (!conn.wantsWrite) {
+                epoll_event ev{};
+                ev.events = conn.closing ? EPOLLOUT : EPOLLIN | EPOLLOUT;
+                ev.data.fd = fd;
+                epoll_ctl(epollFd, EPOLL_CTL_MOD, fd, &ev);
+                conn.wantsWrite = true;
+            }
+            return;
+        }
+        closeConnection(fd);
+        return;
+    }
+
+    conn.output.erase(0, conn.durableOutput);
+    conn.outputOffset = 0;
+    conn.durableOutput = 0;
+    if (conn.output.empty() && conn.closing) {
+        closeConnection(fd);
+        return;
+    }
+    if (conn.wantsWrite) {
+        epoll_event ev{};
+        if (!conn.closing) ev.events = EPOLLIN;
+        ev.data.fd = fd;
+        epoll_ctl(epollFd, EPOLL_CTL_MOD, fd, &ev);
+        conn.wantsWrite = false;
+    }
+}
+
+void Server::closeConnection(int fd) {
+    epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+    close(fd);
+    connections.erase(fd);
+}
\ No newline at end of file
@@ -0,0 +1,58 @@
+#ifndef PROEKT_SERVER_H
+#define PROEKT_SERVER_H
+
+#include <atomic>
+#include <map>
+#include "Session.h"
+
+struct ServerConfig {
+    std::string unixSocketPath; // when set, listen on this Unix domain socket instead of TCP
+    std::string host = "127.0.0.1";
+    uint16_t port = 5432;
+};
+
+class Server {
+    struct Connection {
+        int fd = -1;
+        std::string input;
+        std::size_t inputOffset = 0;
+        std::string output;
+        std::size_t outputOffset = 0;
+        // Replies past `durableOutput` wait for the next group flush; if it fails, each of the
+        // `heldReplies` frames there is replaced by an error.
+        std::size_t durableOutput = 0;
+        std::size_t heldReplies = 0;
+        bool wantsWrite = false;
+        bool closing = false;
+        std::unique_ptr<Session> session;
+    };
+
+    Database& db;
+    StatementCache statementCache;
+    ServerConfig config;
+    int listenFd = -1;
+    int epollFd = -1;
+    int wakeFd = -1;
+    std::atomic<bool> running = false;
+    std::map<int, Connection> connections;
+    std::vector<int> pendingReplies; // connections with output held back until the next group flush
+
+    void openListener();
+    void acceptConnections();
+    void handleReadable(Connection& conn);
+    void handleWritable(Connection& conn);
+    void closeConnection(int fd);
+    void flushAndReply();
+
+public:
+    Server(Database& db, ServerConfig config);
+    ~Server();
+    Server(const Server&) = delete;
+    Server& operator=(const Server&) = delete;
+
+    void run();
+    void stop();
+    uint16_t getPort() const;
+};
+
+#endif //PROEKT_SERVER_H
\ No newline at end of file
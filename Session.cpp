@@ -0,0 +1,133 @@
+#include "Session.h"
+#include "Parser.h"
+
+std::shared_ptr<Statement> Session::parseCached(std::span<const Token> tokens) {
+    const std::string key = normalizeStatement(tokens);
+    if (auto statement = cache.find(key, db.getSchemaVersion())) {
+        return statement;
+    }
+
+    auto statement = parseStatement(db, tokens, true);
+    if (!statement) throw std::runtime_error("Cannot prepare: " + key);
+    cache.put(key, statement);
+    return statement;
+}
+
+namespace {
+    // Attributes the writes of one statement to the session's transaction.
+    class ActiveTransaction {
+        Database& db;
+
+    public:
+        ActiveTransaction(Database& db, TransactionId id) : db(db) { db.setActiveTransaction(id); }
+        ~ActiveTransaction() { db.setActiveTransaction(0); }
+    };
+}
+
+Session::~Session() {
+    if (transaction) db.rollbackTransaction(transaction);
+}
+
+Database &Session::getDatabase() const {
+    return db;
+}
+
+std::shared_ptr<Statement> Session::prepare(const std::string &sql) {
+    return parseCached(tokenize(sql));
+}
+
+bool Session::execute(Statement &statement, const std::vector<Value> &parameters) {
+    if (statement.schemaVersion != db.getSchemaVersion()) {
+        throw std::runtime_error("Prepared statement is out of date, prepare it again");
+    }
+    statement.bind(parameters);
+    ActiveTransaction active(db, transaction);
+    auto sink = makeSink(outputFormat, std::cout);
+    return executeStatement(db, statement, *sink);
+}
+
+ResultSet Session::query(Statement &statement, const std::vector<Value> &parameters) {
+    if (statement.kind != StatementKind::SELECT) {
+        throw std::runtime_error("Only SELECT statements return a result set");
+    }
+    if (statement.schemaVersion != db.getSchemaVersion()) {
+        throw std::runtime_error("Prepared statement is out of date, prepare it again");
+    }
+    statement.bind(parameters);
+    ActiveTransaction active(db, transaction);
+    return db.select(statement.tableName, statement.columnNames, statement.where, statement.orderByColumn,
+                     statement.isDistinct);
+}
+
+ResultSet Session::query(const std::string &sql, const std::vector<Value> &parameters) {
+    return query(*prepare(sql), parameters);
+}
+
+void Session::prepareNamed(const std::string &name, std::string text) {
+    auto statement = parseCached(tokenize(text));
+    prepared[name] = {std::move(text), std::move(statement)};
+}
+
+bool Session::executeNamed(const std::string &name, std::span<const Token> literals) {
+    auto it = prepared.find(name);
+    if (it == prepared.end()) {
+        throw std::runtime_error("Prepared statement " + name + " does not exists");
+    }
+    Prepared& entry = it->second;
+    if (entry.statement->schemaVersion != db.getSchemaVersion()) {
+        entry.statement = parseCached(tokenize(entry.text));
+    }
+
+    const auto& types = entry.statement->parameters.types;
+    if (literals.size() != types.size()) {
+        throw std::runtime_error("Expected " + std::to_string(types.size()) + " parameters, got " +
+                                 std::to_string(literals.size()));
+    }
+    std::vector<Value> values;
+    values.reserve(literals.size());
+    for (std::size_t i = 0; i < literals.size(); i++) {
+        try {
+            values.push_back(Parser::parseValue(literals[i], types[i]));
+        } catch (const std::logic_error&) {
+            throw std::runtime_error("Parameter " + std::to_string(i + 1) + " must be " + dataTypeToString(types[i]));
+        }
+    }
+    return execute(*entry.statement, values);
+}
+
+void Session::deallocate(const std::string &name) {
+    if (!prepared.erase(name)) {
+        throw std::runtime_error("Prepared statement " + name + " does not exists");
+    }
+}
+
+void Session::begin() {
+    if (transaction) throw std::runtime_error("Transaction already in progress");
+    transaction = db.beginTransaction();
+}
+
+void Session::commit() {
+    if (!transaction) throw std::runtime_error("No transaction in progress");
+    TransactionId id = transaction;
+    transaction = 0;
+    db.commitTransaction(id);
+}
+
+void Session::rollback() {
+    if (!transaction) throw std::runtime_error("No transaction in progress");
+    TransactionId id = transaction;
+    transaction = 0;
+    db.rollbackTransaction(id);
+}
+
+bool Session::inTransaction() const {
+    return transaction != 0;
+}
+
+void Session::setOutputFormat(OutputFormat format) {
+    outputFormat = format;
+}
+
+OutputFormat Session::getOutputFormat() const {
+    return outputFormat;
+}
\ No newline at end of file
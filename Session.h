@@ -0,0 +1,48 @@
+#ifndef PROEKT_SESSION_H
+#define PROEKT_SESSION_H
+
+#include "StatementCache.h"
+
+// Per-client state: the statements it has prepared by name and its open transaction, if any.
+// Parsed plans are shared through the cache.
+class Session {
+    struct Prepared {
+        std::string text; // re-lexed when the schema changes under the statement
+        std::shared_ptr<Statement> statement;
+    };
+
+    Database& db;
+    StatementCache& cache;
+    std::map<std::string, Prepared> prepared;
+    TransactionId transaction = 0;
+    OutputFormat outputFormat = OutputFormat::TABLE;
+
+    std::shared_ptr<Statement> parseCached(std::span<const Token> tokens);
+
+public:
+    Session(Database& db, StatementCache& cache) : db(db), cache(cache) {}
+    ~Session();
+    Session(const Session&) = delete;
+    Session& operator=(const Session&) = delete;
+
+    Database& getDatabase() const;
+
+    std::shared_ptr<Statement> prepare(const std::string& sql);
+    bool execute(Statement& statement, const std::vector<Value>& parameters = {});
+    ResultSet query(Statement& statement, const std::vector<Value>& parameters = {});
+    ResultSet query(const std::string& sql, const std::vector<Value>& parameters = {});
+
+    void prepareNamed(const std::string& name, std::string text);
+    bool executeNamed(const std::string& name, std::span<const Token> literals);
+    void deallocate(const std::string& name);
+
+    void begin();
+    void commit();
+    void rollback();
+    bool inTransaction() const;
+
+    void setOutputFormat(OutputFormat format);
+    OutputFormat getOutputFormat() const;
+};
+
+#endif //PROEKT_SESSION_H
\ No newline at end of file
@@ -0,0 +1,453 @@
+#include "Statement.h"
+#include <cmath>
+#include "Parser.h"
+
+namespace {
+    // Orders keywords case-insensitively so a token can be looked up without an upper-case copy.
+    struct KeywordLess {
+        using is_transparent = void;
+        bool operator()(std::string_view a, std::string_view b) const {
+            return std::ranges::lexicographical_compare(a, b, [](char x, char y) {
+                return std::toupper(static_cast<unsigned char>(x)) < std::toupper(static_cast<unsigned char>(y));
+            });
+        }
+    };
+
+    const std::set<std::string_view, KeywordLess> keywords = {
+        "CREATETABLE", "DROPTABLE", "LISTTABLES", "TABLEINFO", "INSERT", "INTO", "REMOVE", "UPDATE", "SET", "SELECT", "FROM",
+        "WHERE", "AND", "OR", "NOT", "IN", "BETWEEN", "LIKE", "ORDER", "BY", "DISTINCT", "DEFAULT", "AUTOINCREMENT",
+        "INDEX", "INCLUDE", "BLOOM", "TRIGRAM", "ON", "IMPORT", "EXPORT", "TO", "FORMAT", "EXPLAIN", "ANALYZE", "STATS",
+        "SETLIMIT", "SETCACHE", "PARTITION", "ADDPARTITION", "DROPPARTITION", "QUIT", "EXIT"
+    };
+
+    const Token& requireToken(std::span<const Token> tokens, std::size_t pos, const char* what) {
+        if (pos >= tokens.size()) throw std::runtime_error(std::string("Expected ") + what);
+        return tokens[pos];
+    }
+
+    // PARTITION BY RANGE(col) (bound, ...) or PARTITION BY HASH(col) count
+    void parsePartitionClause(Statement& st, std::span<const Token> tokens) {
+        const char* syntax = "Expected PARTITION BY RANGE(col) (bound, ...) or PARTITION BY HASH(col) count";
+        if (tokens.size() < 7 || !tokens[1].is("BY") || tokens[3] != "(" || tokens[5] != ")") throw std::runtime_error(syntax);
+
+        PartitionScheme& scheme = st.partitioning;
+        scheme.column = tokens[4].str();
+        auto col = std::ranges::find(st.columns, scheme.column, &Column::name);
+        if (col == st.columns.end()) throw std::runtime_error("Unknown partition column: " + scheme.column);
+
+        if (tokens[2].is("HASH")) {
+            scheme.kind = PartitionKind::HASH;
+            if (tokens.size() != 7 || tokens[6].kind != TokenKind::NUMBER) throw std::runtime_error(syntax);
+            const double count = parseNumber(tokens[6].text);
+            if (count < 1 || count != std::trunc(count)) throw std::runtime_error("HASH partitioning needs a whole number of partitions");
+            scheme.count = static_cast<std::size_t>(count);
+        } else if (tokens[2].is("RANGE")) {
+            scheme.kind = PartitionKind::RANGE;
+            if (tokens[6] != "(" || tokens.back() != ")") throw std::runtime_error(syntax);
+            for (std::size_t i = 7; i + 1 < tokens.size(); i++) {
+                if (tokens[i] != ",") scheme.bounds.push_back(Parser::parseValue(tokens[i], col->type));
+            }
+        } else {
+            throw std::runtime_error(syntax);
+        }
+    }
+
+    void parseCreateTable(Statement& st, std::span<const Token> tokens) {
+        st.tableName = requireToken(tokens, 1, "table name").str();
+
+        size_t i = 3;
+        while (i + 2 < tokens.size() && tokens[i] != ")") {
+            const std::string colName = tokens[i++].str();
+            if (tokens[i++] != ":") throw std::runtime_error("Expected ':'");
+
+            DataType type = Parser::parseDataType(tokens[i++].text);
+
+            Column col(colName, type);
+            if (i < tokens.size() && tokens[i] != "," && tokens[i] != ")") {
+                const Token& attr = tokens[i];
+
+                if (attr.is("DEFAULT") && i + 1 < tokens.size()) {
+                    i++;
+                    col.hasDefault = true;
+                    col.defaultValue = Parser::parseValue(tokens[i++], col.type);
+                }
+
+                if (attr.is("AUTOINCREMENT")) {
+                    col.autoIncrement = true;
+                    i++;
+                }
+            }
+            st.columns.push_back(col);
+
+            if (i < tokens.size() && tokens[i] == ",") i++;
+        }
+
+        // Trailing clauses: INDEX ON col [INCLUDE (col, ...)], BLOOM ON col and TRIGRAM ON col, in
+        // any order and number, then an optional PARTITION BY.
+        i++;
+        while (i + 2 < tokens.size()) {
+            const Token& clause = tokens[i];
+            if (!clause.is("INDEX") && !clause.is("BLOOM") && !clause.is("TRIGRAM")) break;
+            const std::string_view targetCol = tokens[i + 2].text;
+            i += 3;
+            std::vector<std::string> include;
+            if (clause.is("INDEX") && i < tokens.size() && tokens[i].is("INCLUDE")) {
+                if (requireToken(tokens, i + 1, "( after INCLUDE") != "(") throw std::runtime_error("Expected ( after INCLUDE");
+                for (i += 2; requireToken(tokens, i, ") after INCLUDE columns") != ")"; i++) {
+                    if (tokens[i] != ",") include.push_back(tokens[i].str());
+                }
+                i++;
+            }
+            for (auto& col : st.columns) {
+                if (col.name != targetCol) continue;
+                if (clause.is("INDEX")) {
+                    col.indexed = true;
+                    col.include = include;
+                } else if (clause.is("BLOOM")) {
+                    col.bloomFilter = true;
+                } else {
+                    col.trigramIndex = true;
+                }
+            }
+        }
+        if (i < tokens.size() && tokens[i].is("PARTITION")) parsePartitionClause(st, tokens.subspan(i));
+    }
+
+    void parseInsert(Statement& st, Database& db, std::span<const Token> tokens, bool allowPlaceholders) {
+        if (tokens.size() < 3) throw std::runtime_error("Expected INSERT INTO table {(values)}");
+        st.tableName = tokens[2].str();
+
+        size_t i = 4;
+        while (i < tokens.size() && tokens[i] != "}") {
+            if (tokens[i] == "(") {
+                Row row;
+                i++;
+                while (i < tokens.size() && tokens[i] != ")") {
+                    if (tokens[i] == ",") {
+                        i++;
+                        continue;
+                    }
+
+                    const Token& valToken = tokens[i++];
+
+                    if (valToken.kind == TokenKind::PLACEHOLDER) {
+                        if (!allowPlaceholders) throw std::runtime_error("Placeholders are only allowed in prepared statements");
+                        if (!db.hasTable(st.tableName)) throw std::runtime_error("Table " + st.tableName + " does not exists");
+                        const auto& columns = db.getTable(st.tableName).getColumns();
+                        if (row.values.size() >= columns.size()) throw std::runtime_error("Column size mismatch");
+
+                        std::size_t param = st.parameters.add(columns[row.values.size()].type);
+                        st.rowSlots.push_back({st.rows.size(), row.values.size(), param});
+                        row.values.push_back(st.parameters.values[param]);
+                    } else if (valToken.is("DEFAULT")) {
+                        Value defaultMarker;
+                        defaultMarker.strValue = "__INTERNAL_DEFAULT__";
+                        row.values.push_back(defaultMarker);
+                    } else if (valToken.kind == TokenKind::NUMBER) {
+                        row.values.emplace_back(parseNumber(valToken.text));
+                    } else {
+                        row.values.emplace_back(std::string(unquote(valToken)));
+                    }
+                }
+
+                st.rows.emplace_back(row);
+            }
+            i++;
+        }
+    }
+
+    // IMPORT table FROM 'file.csv' / EXPORT table TO 'file.csv'
+    void parseTransfer(Statement& st, std::span<const Token> tokens, std::string_view command, std::string_view direction) {
+        if (tokens.size() != 4 || !tokens[2].is(direction)) {
+            throw std::runtime_error("Expected " + std::string(command) + " table " + std::string(direction) + " 'file'");
+        }
+        st.tableName = tokens[1].str();
+        st.filePath = unquote(tokens[3]);
+    }
+
+    const Table& requireTable(Database& db, const std::string& tableName) {
+        if (!db.hasTable(tableName)) {
+            throw std::runtime_error("Table " + tableName + " does not exists");
+        }
+        return db.getTable(tableName);
+    }
+
+    // ADDPARTITION table bound / DROPPARTITION table key
+    void parsePartitionCommand(Statement& st, Database& db, std::span<const Token> tokens, std::string_view command) {
+        if (tokens.size() != 3) throw std::runtime_error("Expected " + std::string(command) + " table value");
+        st.tableName = tokens[1].str();
+        const Table& table = requireTable(db, st.tableName);
+        if (!table.isPartitioned()) throw std::runtime_error("Table " + st.tableName + " is not partitioned");
+        const int keyIdx = table.getColumnIndex(table.getPartitioning().column);
+        st.partitionKey = Parser::parseValue(tokens[2], table.getColumns()[keyIdx].type);
+    }
+
+    void parseRemove(Statement& st, Database& db, std::span<const Token> tokens, Parameters* parameters) {
+        size_t i = 1;
+
+        if (i < tokens.size() && tokens[i].is("FROM")) i++;
+
+        if (i >= tokens.size()) throw std::runtime_error("Expected table name after REMOVE");
+        st.tableName = tokens[i++].str();
+        const Table& table = requireTable(db, st.tableName);
+
+        if (i < tokens.size() && tokens[i].is("WHERE")) {
+            i++;
+            st.where = Parser::parseWhereExpression(tokens, i, table, parameters);
+        }
+    }
+
+    // UPDATE table SET col = value [, col = value ...] [WHERE ...]
+    void parseUpdate(Statement& st, Database& db, std::span<const Token> tokens, Parameters* parameters) {
+        if (tokens.size() < 4 || !tokens[2].is("SET")) {
+            throw std::runtime_error("Expected UPDATE table SET col = value");
+        }
+        st.tableName = tokens[1].str();
+        const Table& table = requireTable(db, st.tableName);
+
+        size_t i = 3;
+        while (i < tokens.size() && !tokens[i].is("WHERE")) {
+            if (i + 2 >= tokens.size() || tokens[i + 1] != "=") throw std::runtime_error("Expected col = value after SET");
+            const std::string colName = tokens[i].str();
+            const int colIdx = table.getColumnIndex(colName);
+            if (colIdx == -1) throw std::runtime_error("Unknown column: " + colName);
+            const DataType type = table.getColumns()[colIdx].type;
+
+            const Token& valToken = tokens[i + 2];
+            if (valToken.kind == TokenKind::PLACEHOLDER) {
+                if (!parameters) throw std::runtime_error("Placeholders are only allowed in prepared statements");
+                std::size_t param = parameters->add(type);
+                st.assignmentSlots.push_back({st.assignments.size(), param});
+                st.assignments.push_back({static_cast<std::size_t>(colIdx), parameters->values[param]});
+            } else {
+                st.assignments.push_back({static_cast<std::size_t>(colIdx), Parser::parseValue(valToken, type)});
+            }
+            i += 3;
+            if (i < tokens.size() && tokens[i] == ",") i++;
+        }
+
+        if (i < tokens.size()) {
+            i++;
+            st.where = Parser::parseWhereExpression(tokens, i, table, parameters);
+        }
+    }
+
+    void parseSelect(Statement& st, Database& db, std::span<const Token> tokens, Parameters* parameters) {
+        size_t i = 1;
+
+        if (i < tokens.size() && tokens[i].is("DISTINCT")) {
+            st.isDistinct = true;
+            i++;
+        }
+
+        while (i < tokens.size() && !tokens[i].is("FROM")) {
+            if (tokens[i] != ",") {
+                st.columnNames.push_back(tokens[i].str());
+            }
+            i++;
+        }
+
+        i++;
+        if (i >= tokens.size()) throw std::runtime_error("Expected table name after FROM");
+        st.tableName = tokens[i++].str();
+        const Table& table = requireTable(db, st.tableName);
+
+        while (i < tokens.size()) {
+            const Token& keyword = tokens[i];
+
+            if (keyword.is("WHERE")) {
+                i++;
+                st.where = Parser::parseWhereExpression(tokens, i, table, parameters);
+            } else if (keyword.is("ORDER")) {
+                i += 2;
+                if (i >= tokens.size()) throw std::runtime_error("Expected column after ORDER BY");
+                st.orderByColumn = tokens[i++].str();
+            } else if (keyword.is("DISTINCT")) {
+                i++;
+            } else {
+                throw std::runtime_error("Unexpected token: " + keyword.str());
+            }
+        }
+    }
+}
+
+void Statement::bind(const std::vector<Value> &values) {
+    if (values.size() != parameters.types.size()) {
+        throw std::runtime_error("Expected " + std::to_string(parameters.types.size()) + " parameters, got " +
+                                 std::to_string(values.size()));
+    }
+    for (std::size_t i = 0; i < values.size(); i++) {
+        const DataType expected = parameters.types[i];
+        if ((expected == DataType::DOUBLE) != (values[i].type == DataType::DOUBLE)) {
+            throw std::runtime_error("Parameter " + std::to_string(i + 1) + " must be " + dataTypeToString(expected));
+        }
+        parameters.values[i] = values[i];
+        parameters.values[i].type = expected;
+    }
+    parameters.generation++;
+    for (const auto& slot : rowSlots) {
+        rows[slot.row].values[slot.column] = parameters.values[slot.parameter];
+    }
+    for (const auto& slot : assignmentSlots) {
+        assignments[slot.assignment].value = parameters.values[slot.parameter];
+    }
+}
+
+std::string normalizeStatement(std::span<const Token> tokens) {
+    std::string normalized;
+    for (const auto& token : tokens) {
+        if (!normalized.empty()) normalized += ' ';
+        auto keyword = token.kind == TokenKind::WORD ? keywords.find(token.text) : keywords.end();
+        normalized += keyword != keywords.end() ? *keyword : token.text;
+    }
+    return normalized;
+}
+
+std::shared_ptr<Statement> parseStatement(Database &db, std::span<const Token> tokens, bool allowPlaceholders) {
+    if (tokens.empty()) return nullptr;
+
+    auto st = std::make_shared<Statement>();
+    st->schemaVersion = db.getSchemaVersion();
+    Parameters* parameters = allowPlaceholders ? &st->parameters : nullptr;
+    const Token& cmd = tokens[0];
+
+    if (cmd.is("EXPLAIN")) {
+        const bool analyze = tokens.size() > 1 && tokens[1].is("ANALYZE");
+        auto explained = parseStatement(db, tokens.subspan(analyze ? 2 : 1), allowPlaceholders);
+        if (!explained || (explained->kind != StatementKind::SELECT && explained->kind != StatementKind::REMOVE &&
+                           explained->kind != StatementKind::UPDATE)) {
+            throw std::runtime_error("EXPLAIN supports only SELECT, REMOVE and UPDATE");
+        }
+        explained->explain = true;
+        explained->analyze = analyze;
+        return explained;
+    }
+
+    if (cmd.is("CREATETABLE")) {
+        st->kind = StatementKind::CREATE_TABLE;
+        parseCreateTable(*st, tokens);
+    } else if (cmd.is("DROPTABLE")) {
+        st->kind = StatementKind::DROP_TABLE;
+        st->tableName = requireToken(tokens, 1, "table name").str();
+    } else if (cmd.is("LISTTABLES")) {
+        st->kind = StatementKind::LIST_TABLES;
+    } else if (cmd.is("TABLEINFO")) {
+        st->kind = StatementKind::TABLE_INFO;
+        st->tableName = requireToken(tokens, 1, "table name").str();
+    } else if (cmd.is("ANALYZE")) {
+        st->kind = StatementKind::ANALYZE;
+        st->tableName = requireToken(tokens, 1, "table name").str();
+    } else if (cmd.is("INSERT")) {
+        st->kind = StatementKind::INSERT;
+        parseInsert(*st, db, tokens, allowPlaceholders);
+    } else if (cmd.is("REMOVE")) {
+        st->kind = StatementKind::REMOVE;
+        parseRemove(*st, db, tokens, parameters);
+    } else if (cmd.is("UPDATE")) {
+        st->kind = StatementKind::UPDATE;
+        parseUpdate(*st, db, tokens, parameters);
+    } else if (cmd.is("SELECT")) {
+        st->kind = StatementKind::SELECT;
+        parseSelect(*st, db, tokens, parameters);
+    } else if (cmd.is("IMPORT")) {
+        st->kind = StatementKind::IMPORT;
+        parseTransfer(*st, tokens, "IMPORT", "FROM");
+    } else if (cmd.is("EXPORT")) {
+        st->kind = StatementKind::EXPORT;
+        parseTransfer(*st, tokens, "EXPORT", "TO");
+    } else if (cmd.is("STATS")) {
+        st->kind = StatementKind::STATS;
+    } else if (cmd.is("SETLIMIT")) {
+        st->kind = StatementKind::SET_LIMIT;
+        if (tokens.size() != 2 && tokens.size() != 3) throw std::runtime_error("Expected SETLIMIT [table] bytes");
+        if (tokens.size() == 3) st->tableName = tokens[1].str();
+        st->byteCount = parseByteSize(tokens.back().text);
+    } else if (cmd.is("SETCACHE")) {
+        st->kind = StatementKind::SET_CACHE;
+        st->byteCount = parseByteSize(requireToken(tokens, 1, "cache size in bytes").text);
+    } else if (cmd.is("ADDPARTITION")) {
+        st->kind = StatementKind::ADD_PARTITION;
+        parsePartitionCommand(*st, db, tokens, "ADDPARTITION");
+    } else if (cmd.is("DROPPARTITION")) {
+        st->kind = StatementKind::DROP_PARTITION;
+        parsePartitionCommand(*st, db, tokens, "DROPPARTITION");
+    } else if (cmd.is("QUIT") || cmd.is("EXIT")) {
+        st->kind = StatementKind::QUIT;
+    } else {
+        return nullptr;
+    }
+    return st;
+}
+
+bool executeStatement(Database &db, const Statement &st, ResultSink &sink) {
+    switch (st.kind) {
+        case StatementKind::CREATE_TABLE:
+            db.createTable(st.tableName, st.columns, st.partitioning);
+            break;
+        case StatementKind::DROP_TABLE:
+            db.dropTable(st.tableName);
+            break;
+        case StatementKind::LIST_TABLES:
+            db.listTables();
+            break;
+        case StatementKind::TABLE_INFO:
+            db.tableInfo(st.tableName);
+            break;
+        case StatementKind::ANALYZE:
+            db.analyze(st.tableName);
+            break;
+        case StatementKind::INSERT: {
+            std::vector<Row> rows = st.rows;
+            db.insert(st.tableName, rows);
+            break;
+        }
+        case StatementKind::REMOVE:
+            if (st.explain) {
+                printPlan(std::cout, db.explainRemove(st.tableName, st.where, st.analyze));
+                break;
+            }
+            db.remove(st.tableName, st.where);
+            break;
+        case StatementKind::UPDATE:
+            if (st.explain) {
+                printPlan(std::cout, db.explainUpdate(st.tableName, st.assignments, st.where, st.analyze));
+                break;
+            }
+            db.update(st.tableName, st.assignments, st.where);
+            break;
+        case StatementKind::SELECT:
+            if (st.explain) {
+                printPlan(std::cout, db.explainSelect(st.tableName, st.columnNames, st.where, st.orderByColumn,
+                                                      st.isDistinct, st.analyze));
+                break;
+            }
+            sink.write(db.select(st.tableName, st.columnNames, st.where, st.orderByColumn, st.isDistinct));
+            break;
+        case StatementKind::IMPORT:
+            db.importCsv(st.tableName, st.filePath);
+            break;
+        case StatementKind::EXPORT:
+            db.exportCsv(st.tableName, st.filePath);
+            break;
+        case StatementKind::STATS:
+            db.stats();
+            break;
+        case StatementKind::SET_LIMIT:
+            if (st.tableName.empty()) db.setMemoryLimit(st.byteCount);
+            else db.setTableMemoryLimit(st.tableName, st.byteCount);
+            break;
+        case StatementKind::SET_CACHE:
+            db.setResultCacheBudget(st.byteCount);
+            break;
+        case StatementKind::ADD_PARTITION:
+            db.addPartition(st.tableName, st.partitionKey);
+            break;
+        case StatementKind::DROP_PARTITION:
+            db.dropPartition(st.tableName, st.partitionKey);
+            break;
+        case StatementKind::QUIT:
+            std::cout << "Goodbye" << std::endl;
+            return false;
+    }
+    return true;
+}
\ No newline at end of file
@@ -0,0 +1,51 @@
+#ifndef PROEKT_STATEMENT_H
+#define PROEKT_STATEMENT_H
+
+#include "Database.h"
+#include "Lexer.h"
+#include "ResultSink.h"
+
+enum class StatementKind { CREATE_TABLE, DROP_TABLE, LIST_TABLES, TABLE_INFO, ANALYZE, INSERT, REMOVE, UPDATE, SELECT, IMPORT, EXPORT, STATS, SET_LIMIT, SET_CACHE, ADD_PARTITION, DROP_PARTITION, QUIT };
+
+// A fully parsed command. Prepared statements keep one of these alive between executions;
+// `?` placeholders live in `parameters` and are rebound before every run.
+struct Statement {
+    StatementKind kind = StatementKind::QUIT;
+    std::string tableName;
+    std::vector<Column> columns;
+    PartitionScheme partitioning; // CREATETABLE ... PARTITION BY
+    std::vector<Row> rows;
+    std::vector<std::string> columnNames;
+    std::unique_ptr<Expression> where;
+    std::vector<Assignment> assignments; // UPDATE ... SET
+    std::string orderByColumn;
+    bool isDistinct = false;
+    std::string filePath;
+    std::size_t byteCount = 0; // SETLIMIT [table] bytes (no table: the global limit), SETCACHE bytes
+    Value partitionKey;        // ADDPARTITION table bound, DROPPARTITION table key
+    bool explain = false; // EXPLAIN prints the plan instead of the result
+    bool analyze = false; // EXPLAIN ANALYZE also runs it and reports per-operator counters
+
+    Parameters parameters;
+    struct RowSlot { std::size_t row; std::size_t column; std::size_t parameter; };
+    std::vector<RowSlot> rowSlots; // placeholders inside INSERT rows
+    struct AssignmentSlot { std::size_t assignment; std::size_t parameter; };
+    std::vector<AssignmentSlot> assignmentSlots; // placeholders in UPDATE ... SET
+    uint64_t schemaVersion = 0;
+
+    Statement() = default;
+    Statement(const Statement&) = delete;
+    Statement& operator=(const Statement&) = delete;
+
+    void bind(const std::vector<Value>& values);
+};
+
+std::string normalizeStatement(std::span<const Token> tokens);
+
+// Parses the tokens of a single command. Placeholders are rejected unless `allowPlaceholders` is set.
+std::shared_ptr<Statement> parseStatement(Database& db, std::span<const Token> tokens, bool allowPlaceholders = false);
+
+// Runs a parsed statement, sending any result set to `sink`. Returns false when the statement ends the session.
+bool executeStatement(Database& db, const Statement& statement, ResultSink& sink);
+
+#endif //PROEKT_STATEMENT_H
\ No newline at end of file
@@ -0,0 +1,54 @@
+#include "StatementCache.h"
+
+std::shared_ptr<Statement> StatementCache::find(const std::string &key, uint64_t schemaVersion) {
+    auto it = lookup.find(key);
+    if (it == lookup.end()) {
+        ++misses;
+        return nullptr;
+    }
+    if (it->second->statement->schemaVersion != schemaVersion) {
+        // Parsed against tables that have since been created or dropped.
+        entries.erase(it->second);
+        lookup.erase(it);
+        ++misses;
+        return nullptr;
+    }
+    entries.splice(entries.begin(), entries, it->second);
+    ++hits;
+    return it->second->statement;
+}
+
+void StatementCache::put(const std::string &key, std::shared_ptr<Statement> statement) {
+    if (capacity == 0) return;
+
+    if (auto it = lookup.find(key); it != lookup.end()) {
+        it->second->statement = std::move(statement);
+        entries.splice(entries.begin(), entries, it->second);
+        return;
+    }
+
+    entries.push_front({key, std::move(statement)});
+    lookup[key] = entries.begin();
+
+    if (entries.size() > capacity) {
+        lookup.erase(entries.back().key);
+        entries.pop_back();
+    }
+}
+
+void StatementCache::clear() {
+    entries.clear();
+    lookup.clear();
+}
+
+std::size_t StatementCache::size() const {
+    return entries.size();
+}
+
+std::size_t StatementCache::getHits() const {
+    return hits;
+}
+
+std::size_t StatementCache::getMisses() const {
+    return misses;
+}
\ No newline at end of file
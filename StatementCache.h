@@ -0,0 +1,32 @@
+#ifndef PROEKT_STATEMENTCACHE_H
+#define PROEKT_STATEMENTCACHE_H
+
+#include <list>
+#include <unordered_map>
+#include "Statement.h"
+
+// LRU of parsed statements keyed by normalized statement text, shared by all sessions of a database.
+class StatementCache {
+    struct Entry {
+        std::string key;
+        std::shared_ptr<Statement> statement;
+    };
+
+    std::list<Entry> entries; // most recently used first
+    std::unordered_map<std::string, std::list<Entry>::iterator> lookup;
+    std::size_t capacity;
+    std::size_t hits = 0;
+    std::size_t misses = 0;
+
+public:
+    explicit StatementCache(std::size_t capacity = 256) : capacity(capacity) {}
+
+    std::shared_ptr<Statement> find(const std::string& key, uint64_t schemaVersion);
+    void put(const std::string& key, std::shared_ptr<Statement> statement);
+    void clear();
+    std::size_t size() const;
+    std::size_t getHits() const;
+    std::size_t getMisses() const;
+};
+
+#endif //PROEKT_STATEMENTCACHE_H
\ No newline at end of file
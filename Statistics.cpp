@@ -0,0 +1,161 @@
+#include "Statistics.h"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include "Table.h"
+
+namespace {
+    void writeValue(std::ostream& out, const Value& value) {
+        uint8_t type = static_cast<uint8_t>(value.type);
+        out.write(reinterpret_cast<char*>(&type), sizeof(type));
+        if (value.type == DataType::DOUBLE) {
+            out.write(reinterpret_cast<const char*>(&value.numValue), sizeof(value.numValue));
+        } else {
+            uint32_t strLen = value.strValue.length();
+            out.write(reinterpret_cast<char*>(&strLen), sizeof(strLen));
+            out.write(value.strValue.c_str(), strLen);
+        }
+    }
+
+    Value readValue(std::istream& in) {
+        uint8_t type;
+        in.read(reinterpret_cast<char*>(&type), sizeof(type));
+        if (static_cast<DataType>(type) == DataType::DOUBLE) {
+            double num;
+            in.read(reinterpret_cast<char*>(&num), sizeof(num));
+            return Value(num);
+        }
+        uint32_t strLen;
+        in.read(reinterpret_cast<char*>(&strLen), sizeof(strLen));
+        std::string str(strLen, ' ');
+        in.read(&str[0], strLen);
+        return Value(str, static_cast<DataType>(type));
+    }
+}
+
+void DistinctSketch::add(const Value &value) {
+    uint64_t hash;
+    if (value.type == DataType::DOUBLE) {
+        hash = mixHash(std::hash<double>{}(value.numValue == 0 ? 0.0 : value.numValue));
+    } else {
+        hash = mixHash(std::hash<std::string>{}(value.strValue));
+    }
+    const std::size_t slot = hash >> (64 - precision);
+    const uint8_t rank = std::countl_zero((hash << precision) | (uint64_t(1) << (precision - 1))) + 1;
+    registers[slot] = std::max(registers[slot], rank);
+}
+
+uint64_t DistinctSketch::estimate() const {
+    constexpr double m = 1 << precision;
+    double sum = 0;
+    std::size_t empty = 0;
+    for (uint8_t reg : registers) {
+        sum += std::ldexp(1.0, -reg);
+        if (reg == 0) empty++;
+    }
+    double estimate = (0.7213 / (1 + 1.079 / m)) * m * m / sum;
+    if (estimate <= 2.5 * m && empty > 0) {
+        estimate = m * std::log(m / empty); // linear counting is more accurate for small cardinalities
+    }
+    return static_cast<uint64_t>(std::llround(estimate));
+}
+
+double ColumnStats::fractionEqual(const Value &value) const {
+    if (distinctCount == 0 || value < min || max < value) return 0;
+    return 1.0 / distinctCount;
+}
+
+double ColumnStats::fractionBelow(const Value &value) const {
+    if (bounds.size() < 2 || !(bounds.front() < value)) return 0;
+    if (bounds.back() < value) return 1;
+
+    const std::size_t buckets = bounds.size() - 1;
+    std::size_t bucket = std::upper_bound(bounds.begin(), bounds.end(), value) - bounds.begin() - 1;
+    bucket = std::min(bucket, buckets - 1);
+
+    const Value& low = bounds[bucket];
+    const Value& high = bounds[bucket + 1];
+    double within = 0.5; // non-numeric buckets cannot be interpolated
+    if (value.type == DataType::DOUBLE && high.numValue > low.numValue) {
+        within = (value.numValue - low.numValue) / (high.numValue - low.numValue);
+    }
+    return std::clamp((bucket + within) / buckets, 0.0, 1.0);
+}
+
+TableStats analyzeTable(const Table &table, std::size_t histogramBuckets) {
+    TableStats stats;
+    const auto& rows = table.getRows();
+    stats.rowCount = rows.size();
+
+    for (std::size_t c = 0; c < table.getColumns().size(); c++) {
+        ColumnStats& column = stats.columns[table.getColumns()[c].name];
+        if (rows.empty()) continue;
+
+        DistinctSketch sketch;
+        std::vector<Value> sorted;
+        sorted.reserve(rows.size());
+        for (const auto& row : rows) {
+            sketch.add(row.values[c]);
+            sorted.push_back(row.values[c]);
+        }
+        std::ranges::sort(sorted);
+
+        column.distinctCount = std::clamp<uint64_t>(sketch.estimate(), 1, rows.size());
+        column.min = sorted.front();
+        column.max = sorted.back();
+
+        const std::size_t buckets = std::min(histogramBuckets, sorted.size());
+        for (std::size_t b = 0; b < buckets; b++) {
+            column.bounds.push_back(sorted[b * sorted.size() / buckets]);
+        }
+        column.bounds.push_back(sorted.back());
+    }
+    return stats;
+}
+
+void writeTableStats(std::ostream &out, const TableStats &stats) {
+    out.write(reinterpret_cast<const char*>(&stats.rowCount), sizeof(stats.rowCount));
+    uint32_t colCount = stats.columns.size();
+    out.write(reinterpret_cast<char*>(&colCount), sizeof(colCount));
+
+    for (const auto& [colName, column] : stats.columns) {
+        uint32_t nameLen = colName.length();
+        out.write(reinterpret_cast<char*>(&nameLen), sizeof(nameLen));
+        out.write(colName.c_str(), nameLen);
+        out.write(reinterpret_cast<const char*>(&column.distinctCount), sizeof(column.distinctCount));
+        writeValue(out, column.min);
+        writeValue(out, column.max);
+
+        uint32_t boundCount = column.bounds.size();
+        out.write(reinterpret_cast<char*>(&boundCount), sizeof(boundCount));
+        for (const auto& bound : column.bounds) {
+            writeValue(out, bound);
+        }
+    }
+}
+
+TableStats readTableStats(std::istream &in) {
+    TableStats stats;
+    in.read(reinterpret_cast<char*>(&stats.rowCount), sizeof(stats.rowCount));
+    uint32_t colCount;
+    in.read(reinterpret_cast<char*>(&colCount), sizeof(colCount));
+
+    for (uint32_t c = 0; c < colCount && in; c++) {
+        uint32_t nameLen;
+        in.read(reinterpret_cast<char*>(&nameLen), sizeof(nameLen));
+        std::string colName(nameLen, ' ');
+        in.read(&colName[0], nameLen);
+
+        ColumnStats& column = stats.columns[colName];
+        in.read(reinterpret_cast<char*>(&column.distinctCount), sizeof(column.distinctCount));
+        column.min = readValue(in);
+        column.max = readValue(in);
+
+        uint32_t boundCount;
+        in.read(reinterpret_cast<char*>(&boundCount), sizeof(boundCount));
+        for (uint32_t b = 0; b < boundCount && in; b++) {
+            column.bounds.push_back(readValue(in));
+        }
+    }
+    return stats;
+}
\ No newline at end of file
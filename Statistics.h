@@ -0,0 +1,46 @@
+#ifndef PROEKT_STATISTICS_H
+#define PROEKT_STATISTICS_H
+
+#include <array>
+#include <cstdint>
+#include <istream>
+#include <map>
+#include <ostream>
+#include "Data.h"
+
+// HyperLogLog sketch with 2^12 registers (~1.6% standard error) for distinct-value counts.
+class DistinctSketch {
+    static constexpr int precision = 12;
+    std::array<uint8_t, 1 << precision> registers{};
+
+public:
+    void add(const Value& value);
+    uint64_t estimate() const;
+};
+
+struct ColumnStats {
+    uint64_t distinctCount = 0;
+    Value min;
+    Value max;
+    std::vector<Value> bounds; // equi-depth histogram: bucket i holds the values in [bounds[i], bounds[i + 1]]
+
+    // Estimated fractions of the analyzed rows; both are clamped to [0, 1].
+    double fractionEqual(const Value& value) const;
+    double fractionBelow(const Value& value) const; // strictly less than `value`
+};
+
+// Collected by ANALYZE. Estimates are fractions of `rowCount` and are scaled to the
+// table's current size, so they stay usable (if less exact) as the table changes.
+struct TableStats {
+    uint64_t rowCount = 0;
+    std::map<std::string, ColumnStats> columns;
+};
+
+class Table;
+
+TableStats analyzeTable(const Table& table, std::size_t histogramBuckets = 32);
+
+void writeTableStats(std::ostream& out, const TableStats& stats);
+TableStats readTableStats(std::istream& in);
+
+#endif //PROEKT_STATISTICS_H
\ No newline at end of file
@@ -0,0 +1,538 @@
+#include "Storage.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <iterator>
+#include <unistd.h>
+#include <sstream>
+#include <unordered_map>
+#include "Compression.h"
+
+namespace {
+    constexpr char databaseMagic[8] = {'F', 'M', 'I', 'S', 'Q', 'L', 'D', 'B'};
+    constexpr char tableMagic[8] = {'F', 'M', 'I', 'S', 'Q', 'L', 'T', 'B'};
+    constexpr std::size_t headerSize = sizeof(databaseMagic) + sizeof(uint32_t) + sizeof(uint64_t);
+
+    enum class ColumnEncoding : uint8_t {
+        RAW_DOUBLE,     // 8 bytes per value
+        INT_DELTA,      // zigzag varint of the first value, then of each difference (monotonic ids, timestamps)
+        INT_FRAME,      // zigzag varint of the minimum, then varint of each value minus it
+        PLAIN_STRING,   // varint length + bytes per value
+        DICTIONARY_RLE  // distinct strings once, then (dictionary index, run length) varint pairs
+    };
+
+    uint64_t zigzag(int64_t value) {
+        return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+    }
+
+    int64_t unzigzag(uint64_t value) {
+        return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+    }
+
+    std::size_t varintSize(uint64_t value) {
+        std::size_t size = 1;
+        while (value >= 0x80) {
+            value >>= 7;
+            size++;
+        }
+        return size;
+    }
+
+    class ByteWriter {
+    public:
+        std::string bytes;
+
+        void u8(uint8_t value) { bytes.push_back(static_cast<char>(value)); }
+
+        void varint(uint64_t value) {
+            while (value >= 0x80) {
+                bytes.push_back(static_cast<char>(value | 0x80));
+                value >>= 7;
+            }
+            bytes.push_back(static_cast<char>(value));
+        }
+
+        void raw(const void* data, std::size_t size) { bytes.append(static_cast<const char*>(data), size); }
+
+        void string(const std::string& value) {
+            varint(value.size());
+            bytes.append(value);
+        }
+    };
+
+    class ByteReader {
+        std::string_view bytes;
+        std::size_t pos = 0;
+
+        void require(std::size_t count) const {
+            if (count > bytes.size() - pos) throw std::runtime_error("Database file is corrupted or invalid (truncated data)!");
+        }
+
+    public:
+        explicit ByteReader(std::string_view bytes) : bytes(bytes) {}
+
+        uint8_t u8() {
+            require(1);
+            return static_cast<uint8_t>(bytes[pos++]);
+        }
+
+        uint64_t varint() {
+            uint64_t value = 0;
+            for (int shift = 0; shift < 64; shift += 7) {
+                const uint8_t byte = u8();
+                value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+                if (!(byte & 0x80)) return value;
+            }
+            throw std::runtime_error("Database file is corrupted or invalid (bad varint)!");
+        }
+
+        void raw(void* data, std::size_t size) {
+            require(size);
+            std::memcpy(data, bytes.data() + pos, size);
+            pos += size;
+        }
+
+        std::string string() {
+            const uint64_t size = varint();
+            require(size);
+            std::string value(bytes.substr(pos, size));
+            pos += size;
+            return value;
+        }
+    };
+
+    bool isIntegral(double value) {
+        return value == std::trunc(value) && std::abs(value) <= 9007199254740992.0 && !(value == 0 && std::signbit(value));
+    }
+
+    void encodeDoubles(ByteWriter& out, const std::vector<double>& values) {
+        const bool integral = std::ranges::all_of(values, isIntegral);
+        std::size_t deltaSize = SIZE_MAX;
+        std::size_t frameSize = SIZE_MAX;
+        int64_t min = 0;
+        if (integral && !values.empty()) {
+            min = static_cast<int64_t>(*std::ranges::min_element(values));
+            deltaSize = frameSize = varintSize(zigzag(min));
+            int64_t previous = 0;
+            for (double value : values) {
+                const auto current = static_cast<int64_t>(value);
+                deltaSize += varintSize(zigzag(current - previous));
+                frameSize += varintSize(static_cast<uint64_t>(current - min));
+                previous = current;
+            }
+        }
+
+        const std::size_t rawSize = values.size() * sizeof(double);
+        if (rawSize <= deltaSize && rawSize <= frameSize) {
+            out.u8(static_cast<uint8_t>(ColumnEncoding::RAW_DOUBLE));
+            out.raw(values.data(), rawSize);
+        } else if (deltaSize <= frameSize) {
+            out.u8(static_cast<uint8_t>(ColumnEncoding::INT_DELTA));
+            int64_t previous = 0;
+            for (double value : values) {
+                const auto current = static_cast<int64_t>(value);
+                out.varint(zigzag(current - previous));
+                previous = current;
+            }
+        } else {
+            out.u8(static_cast<uint8_t>(ColumnEncoding::INT_FRAME));
+            out.varint(zigzag(min));
+            for (double value : values) {
+                out.varint(static_cast<uint64_t>(static_cast<int64_t>(value) - min));
+            }
+        }
+    }
+
+    void encodeStrings(ByteWriter& out, const std::vector<const std::string*>& values) {
+        std::unordered_map<std::string_view, uint64_t> dictionary;
+        std::vector<const std::string*> entries;
+        std::vector<std::pair<uint64_t, uint64_t>> runs;
+        std::size_t plainSize = 0;
+        std::size_t dictionarySize = 0;
+
+        for (const std::string* value : values) {
+            plainSize += varintSize(value->size()) + value->size();
+            auto [it, inserted] = dictionary.try_emplace(*value, entries.size());
+            if (inserted) {
+                entries.push_back(value);
+                dictionarySize += varintSize(value->size()) + value->size();
+            }
+            if (!runs.empty() && runs.back().first == it->second) {
+                runs.back().second++;
+            } else {
+                runs.emplace_back(it->second, 1);
+            }
+        }
+        dictionarySize += varintSize(entries.size()) + varintSize(runs.size());
+        for (const auto& [entry, length] : runs) {
+            dictionarySize += varintSize(entry) + varintSize(length);
+        }
+
+        if (plainSize <= dictionarySize) {
+            out.u8(static_cast<uint8_t>(ColumnEncoding::PLAIN_STRING));
+            for (const std::string* value : values) out.string(*value);
+            return;
+        }
+        out.u8(static_cast<uint8_t>(ColumnEncoding::DICTIONARY_RLE));
+        out.varint(entries.size());
+        for (const std::string* entry : entries) out.string(*entry);
+        out.varint(runs.size());
+        for (const auto& [entry, length] : runs) {
+            out.varint(entry);
+            out.varint(length);
+        }
+    }
+
+    void decodeColumn(ByteReader& in, std::vector<Row>& rows, std::size_t column, DataType type) {
+        const auto encoding = static_cast<ColumnEncoding>(in.u8());
+        switch (encoding) {
+            case ColumnEncoding::RAW_DOUBLE:
+                for (auto& row : rows) {
+                    double value;
+                    in.raw(&value, sizeof(value));
+                    row.values[column] = Value(value);
+                }
+                return;
+            case ColumnEncoding::INT_DELTA: {
+                int64_t previous = 0;
+                for (auto& row : rows) {
+                    previous += unzigzag(in.varint());
+                    row.values[column] = Value(static_cast<double>(previous));
+                }
+                return;
+            }
+            case ColumnEncoding::INT_FRAME: {
+                const int64_t min = unzigzag(in.varint());
+                for (auto& row : rows) {
+                    row.values[column] = Value(static_cast<double>(min + static_cast<int64_t>(in.varint())));
+                }
+                return;
+            }
+            case ColumnEncoding::PLAIN_STRING:
+                for (auto& row : rows) {
+                    row.values[column] = Value(in.string(), type);
+                }
+                return;
+            case ColumnEncoding::DICTIONARY_RLE: {
+                std::vector<std::string> entries(in.varint());
+                for (auto& entry : entries) entry = in.string();
+                const uint64_t runCount = in.varint();
+                std::size_t row = 0;
+                for (uint64_t r = 0; r < runCount; r++) {
+                    const uint64_t entry = in.varint();
+                    const uint64_t length = in.varint();
+                    if (entry >= entries.size() || length > rows.size() - row) {
+                        throw std::runtime_error("Database file is corrupted or invalid (bad dictionary run)!");
+                    }
+                    for (uint64_t i = 0; i < length; i++) {
+                        rows[row++].values[column] = Value(entries[entry], type);
+                    }
+                }
+                if (row != rows.size()) throw std::runtime_error("Database file is corrupted or invalid (bad dictionary run)!");
+                return;
+            }
+        }
+        throw std::runtime_error("Database file is corrupted or invalid (unknown column encoding)!");
+    }
+
+    void encodeTable(ByteWriter& out, const Table& table) {
+        out.string(table.getName());
+        out.varint(table.getColumns().size());
+        const auto counters = table.getAutoIncrementCounters();
+        for (const auto& col : table.getColumns()) {
+            out.string(col.name);
+            out.u8(static_cast<uint8_t>(col.type));
+            out.u8((col.indexed ? 1 : 0) | (col.autoIncrement ? 2 : 0) | (col.uniqueIndex ? 4 : 0) |
+                   (col.hasDefault ? 8 : 0) | (col.bloomFilter ? 16 : 0) | (col.include.empty() ? 0 : 32) |
+                   (col.trigramIndex ? 64 : 0));
+            if (col.autoIncrement) out.varint(counters.at(col.name));
+            if (!col.include.empty()) {
+                out.varint(col.include.size());
+                for (const auto& included : col.include) out.string(included);
+            }
+            if (col.hasDefault) {
+                if (col.type == DataType::DOUBLE) out.raw(&col.defaultValue.numValue, sizeof(double));
+                else out.string(col.defaultValue.strValue);
+            }
+        }
+
+        const auto& rows = table.getRows();
+        out.varint(rows.size());
+        for (std::size_t c = 0; c < table.getColumns().size(); c++) {
+            if (table.getColumns()[c].type == DataType::DOUBLE) {
+                std::vector<double> values;
+                values.reserve(rows.size());
+                for (const auto& row : rows) values.push_back(row.values[c].numValue);
+                encodeDoubles(out, values);
+            } else {
+                std::vector<const std::string*> values;
+                values.reserve(rows.size());
+                for (const auto& row : rows) values.push_back(&row.values[c].strValue);
+                encodeStrings(out, values);
+            }
+        }
+    }
+
+    Table decodeTable(ByteReader& in, double* indexSeconds = nullptr) {
+        const std::string tableName = in.string();
+        std::vector<Column> columns(in.varint());
+        std::map<std::string, uint32_t> counters;
+        for (auto& col : columns) {
+            col.name = in.string();
+            col.type = static_cast<DataType>(in.u8());
+            const uint8_t flags = in.u8();
+            col.indexed = (flags & 1) != 0;
+            col.autoIncrement = (flags & 2) != 0;
+            col.uniqueIndex = (flags & 4) != 0;
+            col.hasDefault = (flags & 8) != 0;
+            col.bloomFilter = (flags & 16) != 0;
+            col.trigramIndex = (flags & 64) != 0;
+            if (col.autoIncrement) counters[col.name] = in.varint();
+            if (flags & 32) {
+                col.include.resize(in.varint());
+                for (auto& included : col.include) included = in.string();
+            }
+            if (col.hasDefault) {
+                if (col.type == DataType::DOUBLE) {
+                    col.defaultValue = Value(0.0);
+                    in.raw(&col.defaultValue.numValue, sizeof(double));
+                } else {
+                    col.defaultValue = Value(in.string(), col.type);
+                }
+            }
+        }
+
+        Table table(tableName, columns);
+        for (const auto& [colName, counter] : counters) {
+            table.setAutoIncrementCounters(colName, counter);
+        }
+
+        std::vector<Row> rows(in.varint());
+        for (auto& row : rows) row.values.resize(columns.size());
+        for (std::size_t c = 0; c < columns.size(); c++) {
+            decodeColumn(in, rows, c, columns[c].type);
+        }
+        table.appendRows(std::move(rows), indexSeconds);
+        return table;
+    }
+    void encodeValue(ByteWriter& out, const Value& value) {
+        out.u8(static_cast<uint8_t>(value.type));
+        if (value.type == DataType::DOUBLE) out.raw(&value.numValue, sizeof(double));
+        else out.string(value.strValue);
+    }
+
+    Value decodeValue(ByteReader& in) {
+        const auto type = static_cast<DataType>(in.u8());
+        if (type != DataType::DOUBLE) return Value(in.string(), type);
+        double value;
+        in.raw(&value, sizeof(value));
+        return Value(value);
+    }
+
+    void encodeStatistics(ByteWriter& out, const Table& table) {
+        std::ostringstream stats(std::ios::binary);
+        if (table.getStatistics()) writeTableStats(stats, *table.getStatistics());
+        out.string(stats.str());
+    }
+
+    void decodeStatistics(ByteReader& in, Table& table) {
+        const std::string stats = in.string();
+        if (stats.empty()) return;
+        std::istringstream statsStream(stats, std::ios::binary);
+        table.setStatistics(readTableStats(statsStream));
+    }
+
+    std::vector<char> packFile(const char (&magic)[8], const std::string &payload) {
+        const std::string compressed = compressBlock(payload);
+        const uint64_t payloadSize = payload.size();
+
+        std::vector<char> file(headerSize + sizeof(payloadSize) + compressed.size());
+        std::memcpy(file.data(), magic, sizeof(magic));
+        std::memcpy(file.data() + sizeof(magic), &fileFormatVersion, sizeof(fileFormatVersion));
+        std::memcpy(file.data() + headerSize, &payloadSize, sizeof(payloadSize));
+        std::memcpy(file.data() + headerSize + sizeof(payloadSize), compressed.data(), compressed.size());
+
+        const uint64_t checksum = calculateChecksum(file.data() + headerSize, file.size() - headerSize);
+        std::memcpy(file.data() + sizeof(magic) + sizeof(uint32_t), &checksum, sizeof(checksum));
+        return file;
+    }
+
+    // Verifies the header and checksum and returns the file's version with its decompressed payload.
+    std::pair<uint32_t, std::string> unpackFile(const std::vector<char> &data, const char (&magic)[8], const std::string &what) {
+        if (data.size() < headerSize + sizeof(uint64_t) || std::memcmp(data.data(), magic, sizeof(magic)) != 0) {
+            throw std::runtime_error(what + " is corrupted or invalid (truncated header)!");
+        }
+        uint32_t version;
+        uint64_t storedChecksum;
+        uint64_t payloadSize;
+        std::memcpy(&version, data.data() + sizeof(magic), sizeof(version));
+        std::memcpy(&storedChecksum, data.data() + sizeof(magic) + sizeof(version), sizeof(storedChecksum));
+        std::memcpy(&payloadSize, data.data() + headerSize, sizeof(payloadSize));
+
+        if (calculateChecksum(data.data() + headerSize, data.size() - headerSize) != storedChecksum) {
+            throw std::runtime_error(what + " is corrupted or invalid (Checksum mismatch)!");
+        }
+        const std::size_t compressedStart = headerSize + sizeof(payloadSize);
+        return {version, decompressBlock(std::string_view(data.data() + compressedStart, data.size() - compressedStart), payloadSize)};
+    }
+}
+
+LoadReport &LoadReport::operator+=(const LoadReport &other) {
+    tables += other.tables;
+    rows += other.rows;
+    readSeconds += other.readSeconds;
+    decodeSeconds += other.decodeSeconds;
+    indexSeconds += other.indexSeconds;
+    return *this;
+}
+
+uint64_t calculateChecksum(const char* data, std::size_t size) {
+    uint64_t checksum = 0xFDDB0123456789AB;
+    for (std::size_t i = 0; i < size; i++) {
+        checksum = (checksum ^ static_cast<uint8_t>(data[i])) * 0xBF58476D1CE4E5B9;
+    }
+    return checksum;
+}
+
+bool isVersionedFile(const std::vector<char> &data) {
+    return data.size() >= sizeof(databaseMagic) && std::memcmp(data.data(), databaseMagic, sizeof(databaseMagic)) == 0;
+}
+
+std::vector<char> encodeCatalog(const Catalog &catalog) {
+    ByteWriter payload;
+    payload.varint(catalog.nextFileId);
+    payload.varint(catalog.tableFiles.size());
+    for (const auto& [tableName, fileId] : catalog.tableFiles) {
+        payload.string(tableName);
+        payload.varint(fileId);
+    }
+    return packFile(databaseMagic, payload.bytes);
+}
+
+DatabaseFile decodeDatabaseFile(const std::vector<char> &data) {
+    const auto [version, payload] = unpackFile(data, databaseMagic, "Database file");
+    ByteReader in(payload);
+    DatabaseFile file;
+
+    if (version == fileFormatVersion || version == 3) {
+        file.catalog.nextFileId = in.varint();
+        const uint64_t tableCount = in.varint();
+        for (uint64_t t = 0; t < tableCount; t++) {
+            const std::string tableName = in.string();
+            file.catalog.tableFiles[tableName] = in.varint();
+        }
+        return file;
+    }
+
+    if (version != 2) {
+        throw std::runtime_error("Unsupported database file version " + std::to_string(version));
+    }
+
+    // Version 2 kept every table in this one file.
+    file.singleFile = true;
+    const uint64_t tableCount = in.varint();
+    for (uint64_t t = 0; t < tableCount; t++) {
+        Table table = decodeTable(in);
+        const std::string tableName = table.getName();
+        file.tables[tableName] = std::move(table);
+    }
+
+    const uint64_t analyzedCount = in.varint();
+    for (uint64_t t = 0; t < analyzedCount; t++) {
+        const std::string tableName = in.string();
+        std::istringstream stats(in.string(), std::ios::binary);
+        if (file.tables.contains(tableName)) file.tables[tableName].setStatistics(readTableStats(stats));
+    }
+    return file;
+}
+
+std::vector<char> encodeTableFile(const Table &table) {
+    ByteWriter payload;
+    encodeTable(payload, table);
+    encodeStatistics(payload, table);
+
+    const PartitionScheme& scheme = table.getPartitioning();
+    payload.u8(static_cast<uint8_t>(scheme.kind));
+    if (table.isPartitioned()) {
+        payload.string(scheme.column);
+        payload.varint(scheme.bounds.size());
+        for (const auto& bound : scheme.bounds) encodeValue(payload, bound);
+        payload.varint(scheme.count);
+        for (const auto& partition : table.getPartitions()) {
+            encodeTable(payload, partition);
+            encodeStatistics(payload, partition);
+        }
+    }
+    return packFile(tableMagic, payload.bytes);
+}
+
+Table decodeTableFile(const std::vector<char> &data, LoadReport *report) {
+    const auto start = std::chrono::steady_clock::now();
+    double indexSeconds = 0;
+    const auto [version, payload] = unpackFile(data, tableMagic, "Table file");
+    if (version != fileFormatVersion && version != 3) {
+        throw std::runtime_error("Unsupported table file version " + std::to_string(version));
+    }
+    ByteReader in(payload);
+    Table table = decodeTable(in, &indexSeconds);
+    decodeStatistics(in, table);
+
+    // Version 3 files end here: no table was partitioned yet.
+    PartitionScheme scheme;
+    if (version != 3) scheme.kind = static_cast<PartitionKind>(in.u8());
+    if (scheme.kind != PartitionKind::NONE) {
+        scheme.column = in.string();
+        scheme.bounds.resize(in.varint());
+        for (auto& bound : scheme.bounds) bound = decodeValue(in);
+        scheme.count = in.varint();
+
+        Table partitioned(table.getName(), table.getColumns(), scheme);
+        for (const auto& [colName, counter] : table.getAutoIncrementCounters()) {
+            partitioned.setAutoIncrementCounters(colName, counter);
+        }
+        std::vector<Table> partitions;
+        for (std::size_t i = 0; i < scheme.partitionCount(); i++) {
+            partitions.push_back(decodeTable(in, &indexSeconds));
+            decodeStatistics(in, partitions.back());
+        }
+        partitioned.loadPartitions(std::move(partitions));
+        table = std::move(partitioned);
+    }
+    table.markClean();
+    if (report) {
+        report->indexSeconds += indexSeconds;
+        report->decodeSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() - indexSeconds;
+    }
+    return table;
+}
+
+std::vector<char> readFile(const std::string &path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) throw std::runtime_error("Cannot open file " + path);
+    return std::vector<char>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+void writeFileAtomically(const std::string &path, const std::vector<char> &data) {
+    const std::string temporaryPath = path + ".tmp";
+    const int fd = ::open(temporaryPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) throw std::runtime_error("Cannot write file " + temporaryPath);
+
+    std::size_t written = 0;
+    while (written < data.size()) {
+        const ssize_t n = ::write(fd, data.data() + written, data.size() - written);
+        if (n < 0) {
+            ::close(fd);
+            throw std::runtime_error("Cannot write file " + temporaryPath);
+        }
+        written += static_cast<std::size_t>(n);
+    }
+    const bool synced = ::fsync(fd) == 0;
+    ::close(fd);
+    if (!synced || std::rename(temporaryPath.c_str(), path.c_str()) != 0) {
+        throw std::runtime_error("Cannot replace file " + path);
+    }
+}
\ No newline at end of file
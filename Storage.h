@@ -0,0 +1,64 @@
+#ifndef PROEKT_STORAGE_H
+#define PROEKT_STORAGE_H
+
+#include <map>
+#include <vector>
+#include "Table.h"
+
+// Every file starts with an 8-byte magic | u32 version | u64 checksum of the rest | u64 payload
+// size, followed by the compressed payload (see compressBlock).
+//
+// Since format version 3 each table is kept in its own file. The database path holds only the catalog
+// ("FMISQLDB"): the next free file id and the file id of every table. A table file ("FMISQLTB")
+// holds the schema, the rows column by column, each column in the smallest of a few encodings,
+// and the ANALYZE statistics.
+// Version 4 ends a table file with its partition scheme and, for a partitioned table, each
+// partition's rows and statistics in the same layout, and lists the INCLUDE columns of covering
+// indexes after their column's flags (flag 64 marks a trigram index). Version 3 files lack
+// both and are otherwise the same.
+// Version 2 kept every table in the database file itself, and files from before versioning
+// start with a bare checksum; Database::loadFromDisk still reads both.
+constexpr uint32_t fileFormatVersion = 4;
+
+struct Catalog {
+    uint64_t nextFileId = 1;
+    std::map<std::string, uint64_t> tableFiles;
+};
+
+// What loading tables took (see Database::preloadTables). The phase times are summed over the
+// tables, so with several loader threads they add up to more than the wall time.
+struct LoadReport {
+    std::size_t tables = 0;
+    std::size_t rows = 0;
+    std::size_t threads = 0;
+    double wallSeconds = 0;
+    double readSeconds = 0;   // reading the table files
+    double decodeSeconds = 0; // checksums, decompression, rows, statistics and partitions
+    double indexSeconds = 0;  // sorting keys and merging them into the indexes
+
+    LoadReport& operator+=(const LoadReport& other);
+};
+
+// What the database path holds: a catalog, or for a version 2 file every table.
+struct DatabaseFile {
+    Catalog catalog;
+    std::map<std::string, Table> tables;
+    bool singleFile = false;
+};
+
+uint64_t calculateChecksum(const char* data, std::size_t size);
+bool isVersionedFile(const std::vector<char>& data);
+
+// The decoders throw std::runtime_error for a corrupted file or a version this build cannot read.
+std::vector<char> encodeCatalog(const Catalog& catalog);
+DatabaseFile decodeDatabaseFile(const std::vector<char>& data);
+std::vector<char> encodeTableFile(const Table& table);
+// `report`, when given, is credited with the decode and index time.
+Table decodeTableFile(const std::vector<char>& data, LoadReport* report = nullptr);
+
+std::vector<char> readFile(const std::string& path);
+// Writes to a temporary file, syncs it and renames it over `path`, so readers see either the old
+// file or the new one, never a partial write.
+void writeFileAtomically(const std::string& path, const std::vector<char>& data);
+
+#endif //PROEKT_STORAGE_H
\ No newline at end of file
@@ -1,14 +1,129 @@
 #include "Table.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <numeric>
+#include <set>
+#include <thread>
 
-Table::Table(std::string  name, const std::vector<Column>& columns) : name(std::move(name)), columns(columns) {
+namespace {
+    // Batches at least this large build their indexes in parallel; below it thread start-up
+    // costs more than it saves.
+    constexpr std::size_t parallelIndexRows = 1 << 15;
+
+    std::size_t rowStringBytes(const Row& row) {
+        std::size_t bytes = 0;
+        for (const auto& value : row.values) bytes += stringHeapBytes(value.strValue);
+        return bytes;
+    }
+
+    std::size_t blockSummaryBytes(const BlockSummary& block) {
+        std::size_t bytes = (block.min.capacity() + block.max.capacity()) * sizeof(Value) + block.mixedTypes.capacity() / 8 +
+                            block.blooms.capacity() * sizeof(BloomFilter);
+        for (std::size_t i = 0; i < block.min.size(); i++) {
+            bytes += stringHeapBytes(block.min[i].strValue) + stringHeapBytes(block.max[i].strValue) +
+                     block.blooms[i].memoryUsage();
+        }
+        return bytes;
+    }
+
+    std::size_t undoEntryBytes(const UndoEntry& entry) {
+        std::size_t bytes = sizeof(UndoEntry) + entry.oldCells.capacity() * sizeof(entry.oldCells[0]);
+        for (const auto& [rowIdx, row] : entry.removedRows) {
+            bytes += sizeof(std::pair<std::size_t, Row>) + row.values.capacity() * sizeof(Value) + rowStringBytes(row);
+        }
+        for (const auto& cell : entry.oldCells) bytes += stringHeapBytes(std::get<2>(cell).strValue);
+        if (entry.image) bytes += entry.image->getMemoryUsage().total();
+        return bytes;
+    }
+}
+
+Table::Table(std::string  name, const std::vector<Column>& columns, PartitionScheme partitioning)
+    : name(std::move(name)), columns(columns), partitioning(std::move(partitioning)) {
     for (const auto& col : columns) {
-        if (col.indexed) {
-            indices[col.name] = Index(col.uniqueIndex);
+        std::vector<std::size_t> included;
+        for (const auto& includeName : col.include) {
+            const int includeIdx = getColumnIndex(includeName);
+            if (includeIdx == -1) throw std::runtime_error("Unknown INCLUDE column: " + includeName);
+            if (!col.indexed || includeName == col.name) {
+                throw std::runtime_error("Column " + includeName + " cannot be included in an index on " + col.name);
+            }
+            if (std::ranges::find(included, includeIdx) == included.end()) included.push_back(includeIdx);
+        }
+        if (col.indexed && !isPartitioned()) {
+            indices[col.name] = ColumnIndex(col.type, col.uniqueIndex, std::move(included));
+        }
+        if (col.trigramIndex && col.type == DataType::DOUBLE) {
+            throw std::runtime_error("Column " + col.name + " cannot have a trigram index: it is not a String or Date column");
         }
+        if (col.trigramIndex && !isPartitioned()) trigramIndices[col.name];
         if (col.autoIncrement) {
             autoIncrementCounters[col.name] = 1;
         }
     }
+    if (!isPartitioned()) return;
+
+    const int keyIdx = getColumnIndex(this->partitioning.column);
+    if (keyIdx == -1) throw std::runtime_error("Unknown partition column: " + this->partitioning.column);
+    const auto& bounds = this->partitioning.bounds;
+    if (this->partitioning.kind == PartitionKind::RANGE) {
+        if (bounds.empty()) throw std::runtime_error("RANGE partitioning needs at least one bound");
+        for (std::size_t i = 0; i < bounds.size(); i++) {
+            if ((bounds[i].type == DataType::DOUBLE) != (columns[keyIdx].type == DataType::DOUBLE)) {
+                throw std::runtime_error("Partition bound " + bounds[i].toString() + " does not match the type of " + columns[keyIdx].name);
+            }
+            if (i > 0 && !(bounds[i - 1] < bounds[i])) throw std::runtime_error("Partition bounds must be ascending");
+        }
+    } else if (this->partitioning.count == 0) {
+        throw std::runtime_error("HASH partitioning needs at least one partition");
+    }
+    if (this->partitioning.partitionCount() > PartitionScheme::maxPartitions) {
+        throw std::runtime_error("A table can have at most " + std::to_string(PartitionScheme::maxPartitions) + " partitions");
+    }
+    partitions.assign(this->partitioning.partitionCount(), Table(this->name, columns));
+}
+
+Table::Table(const Table &other)
+    : name(other.name), columns(other.columns), indices(other.indices), trigramIndices(other.trigramIndices),
+      autoIncrementCounters(other.autoIncrementCounters), statistics(other.statistics), blocks(other.blocks),
+      blockBytes(other.blockBytes), dirty(other.dirty), version(other.version),
+      partitioning(other.partitioning), partitions(other.partitions) {
+    rows.reserve(other.rows.size());
+    for (const auto& row : other.rows) {
+        rows.emplace_back(row, &rowMemory->pool);
+        stringBytes += rowStringBytes(rows.back());
+    }
+}
+
+Table &Table::operator=(Table other) noexcept {
+    // Copy-and-swap: the old rows are released together with their pool when `other` dies.
+    swap(*this, other);
+    return *this;
+}
+
+void swap(Table &a, Table &b) noexcept {
+    using std::swap;
+    swap(a.name, b.name);
+    swap(a.columns, b.columns);
+    swap(a.rowMemory, b.rowMemory);
+    swap(a.rows, b.rows);
+    swap(a.stringBytes, b.stringBytes);
+    swap(a.indices, b.indices);
+    swap(a.trigramIndices, b.trigramIndices);
+    swap(a.autoIncrementCounters, b.autoIncrementCounters);
+    swap(a.statistics, b.statistics);
+    swap(a.blocks, b.blocks);
+    swap(a.blockBytes, b.blockBytes);
+    swap(a.dirty, b.dirty);
+    swap(a.version, b.version);
+    swap(a.partitioning, b.partitioning);
+    swap(a.partitions, b.partitions);
+    swap(a.undoLog, b.undoLog);
+}
+
+uint64_t Table::newVersion() {
+    static std::atomic<uint64_t> lastVersion{0};
+    return lastVersion.fetch_add(1, std::memory_order_relaxed) + 1;
 }
 
 int Table::getColumnIndex(const std::string &name) const {
@@ -21,8 +136,10 @@ int Table::getColumnIndex(const std::string &name) const {
 }
 
 
-void Table::insertRow(Row &row) {
-    Row finalRow;
+Row Table::completeRow(Row &&row) {
+    // Rows of a partitioned table only pass through on their way into a partition's pool.
+    Row finalRow(isPartitioned() ? std::pmr::get_default_resource() : &rowMemory->pool);
+    finalRow.values.reserve(columns.size());
     for (size_t i = 0; i < columns.size(); ++i) {
         const Column& col = columns[i];
 
@@ -40,29 +157,261 @@ void Table::insertRow(Row &row) {
                 finalRow.values.push_back(col.type == DataType::DOUBLE ? Value(0.0) : Value("", col.type));
             }
         } else {
-            finalRow.values.push_back(row.values[i]);
             if (col.autoIncrement && row.values[i].type == DataType::DOUBLE) {
                 if (row.values[i].numValue >= autoIncrementCounters[col.name]) {
                     autoIncrementCounters[col.name] = row.values[i].numValue + 1;
                 }
             }
+            finalRow.values.push_back(std::move(row.values[i]));
+        }
+    }
+    return finalRow;
+}
+
+void Table::summarizeRow(std::size_t rowIdx) {
+    const Row& row = rows[rowIdx];
+    if (rowIdx % blockSize == 0) {
+        BlockSummary& block = blocks.emplace_back(std::vector<Value>(row.values.begin(), row.values.end()),
+                                                  std::vector<Value>(row.values.begin(), row.values.end()),
+                                                  std::vector<bool>(row.values.size(), false));
+        for (std::size_t i = 0; i < columns.size(); i++) {
+            block.blooms.push_back(columns[i].bloomFilter ? BloomFilter(blockSize) : BloomFilter());
+            block.blooms[i].add(row.values[i]);
         }
+        blockBytes += blockSummaryBytes(block);
+        return;
+    }
+
+    BlockSummary& block = blocks.back();
+    for (std::size_t i = 0; i < row.values.size(); i++) {
+        widenBlock(block, i, row.values[i]);
+    }
+}
+
+void Table::widenBlock(BlockSummary &block, std::size_t colIdx, const Value &value) {
+    block.blooms[colIdx].add(value);
+    if ((value.type == DataType::DOUBLE) != (block.min[colIdx].type == DataType::DOUBLE)) {
+        block.mixedTypes[colIdx] = true;
+        return;
+    }
+    if (value < block.min[colIdx]) {
+        blockBytes += stringHeapBytes(value.strValue) - stringHeapBytes(block.min[colIdx].strValue);
+        block.min[colIdx] = value;
     }
+    if (block.max[colIdx] < value) {
+        blockBytes += stringHeapBytes(value.strValue) - stringHeapBytes(block.max[colIdx].strValue);
+        block.max[colIdx] = value;
+    }
+}
 
-    rows.push_back(finalRow);
+void Table::appendCompleted(Row &&row) {
+    dirty = true;
+    version = newVersion();
+    rows.push_back(std::move(row));
     const std::size_t rowIdx = rows.size() - 1;
+    stringBytes += rowStringBytes(rows[rowIdx]);
+    summarizeRow(rowIdx);
 
     for (std::size_t i = 0; i < columns.size(); i++) {
         if (columns[i].indexed) {
-            indices[columns[i].name].insert(finalRow.values[i], rowIdx);
+            indices[columns[i].name].insert(rows[rowIdx].values[i], rowIdx, &rows[rowIdx]);
+        }
+        if (columns[i].trigramIndex) {
+            trigramIndices[columns[i].name].insert(rows[rowIdx].values[i], rowIdx);
+        }
+    }
+}
+
+void Table::insertRow(Row row) {
+    if (isPartitioned()) {
+        std::vector<Row> batch;
+        batch.push_back(std::move(row));
+        appendToPartitions(std::move(batch));
+        return;
+    }
+    if (undoLog) logAppend(0, rows.size());
+    appendCompleted(completeRow(std::move(row)));
+}
+
+void Table::appendRows(std::vector<Row> &&batch, double *indexSeconds) {
+    if (batch.empty()) return;
+    if (isPartitioned()) {
+        appendToPartitions(std::move(batch));
+        return;
+    }
+    const std::size_t firstRow = rows.size();
+    if (undoLog) logAppend(0, firstRow);
+    const std::map<std::string, int> countersBefore = autoIncrementCounters;
+    rows.reserve(firstRow + batch.size());
+    for (auto& row : batch) {
+        rows.push_back(completeRow(std::move(row)));
+    }
+
+    // The new rows of each index in key order (stable, so equal keys stay in row order). Unique
+    // keys are checked against each other and the existing index before anything else changes;
+    // a bad batch is cut off again and leaves the table as it was.
+    struct PendingKeys {
+        ColumnIndex* index;
+        int colIdx;
+        const std::string* colName;
+        std::vector<std::size_t> order;
+        std::string duplicate; // error message for the first duplicate key found
+    };
+    std::vector<PendingKeys> pending;
+    for (auto& [colName, index] : indices) {
+        const int colIdx = getColumnIndex(colName);
+        if (colIdx != -1) pending.push_back({&index, colIdx, &colName, {}, {}});
+    }
+
+    // Every index reads the shared rows and writes only its own tree, so each can take a thread.
+    const auto indexStart = std::chrono::steady_clock::now();
+    const bool parallel = pending.size() > 1 && rows.size() - firstRow >= parallelIndexRows &&
+                          std::thread::hardware_concurrency() > 1;
+    auto forEachIndex = [&](auto work) {
+        if (!parallel) {
+            for (auto& keys : pending) work(keys);
+            return;
+        }
+        std::vector<std::exception_ptr> errors(pending.size());
+        std::vector<std::thread> threads;
+        for (std::size_t i = 0; i < pending.size(); i++) {
+            threads.emplace_back([&, i] {
+                try {
+                    work(pending[i]);
+                } catch (...) {
+                    errors[i] = std::current_exception();
+                }
+            });
+        }
+        for (auto& thread : threads) thread.join();
+        for (const auto& error : errors) {
+            if (error) std::rethrow_exception(error);
         }
+    };
+
+    forEachIndex([&](PendingKeys& keys) {
+        const int colIdx = keys.colIdx;
+        auto keyLess = [&](std::size_t a, std::size_t b) { return rows[a].values[colIdx] < rows[b].values[colIdx]; };
+        keys.order.reserve(rows.size() - firstRow);
+        for (std::size_t i = firstRow; i < rows.size(); i++) {
+            if (keys.index->accepts(rows[i].values[colIdx])) keys.order.push_back(i);
+        }
+        if (!std::ranges::is_sorted(keys.order, keyLess)) std::ranges::stable_sort(keys.order, keyLess);
+
+        if (!keys.index->getIsUnique()) return;
+        for (std::size_t i = 0; i < keys.order.size(); i++) {
+            const Value& key = rows[keys.order[i]].values[colIdx];
+            if ((i > 0 && !keyLess(keys.order[i - 1], keys.order[i])) || !keys.index->find(key).empty()) {
+                keys.duplicate = "Duplicate value " + key.toString() + " for unique column " + *keys.colName;
+                return;
+            }
+        }
+    });
+    for (const auto& keys : pending) {
+        if (keys.duplicate.empty()) continue;
+        rows.resize(firstRow);
+        autoIncrementCounters = countersBefore;
+        throw std::runtime_error(keys.duplicate);
+    }
+    double indexTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - indexStart).count();
+
+    dirty = true;
+    version = newVersion();
+    blocks.reserve((rows.size() + blockSize - 1) / blockSize);
+    for (std::size_t i = firstRow; i < rows.size(); i++) {
+        summarizeRow(i);
+        stringBytes += rowStringBytes(rows[i]);
+    }
+    const auto mergeStart = std::chrono::steady_clock::now();
+    forEachIndex([&](const PendingKeys& keys) {
+        std::vector<std::pair<const Value*, std::size_t>> entries;
+        entries.reserve(keys.order.size());
+        for (std::size_t rowIdx : keys.order) {
+            entries.emplace_back(&rows[rowIdx].values[keys.colIdx], rowIdx);
+        }
+        keys.index->insertSorted(entries, &rows);
+    });
+    for (auto& [colName, trigrams] : trigramIndices) {
+        const int colIdx = getColumnIndex(colName);
+        for (std::size_t i = firstRow; i < rows.size(); i++) trigrams.insert(rows[i].values[colIdx], i);
+    }
+    indexTime += std::chrono::duration<double>(std::chrono::steady_clock::now() - mergeStart).count();
+    if (indexSeconds) *indexSeconds += indexTime;
+}
+
+void Table::appendToPartitions(std::vector<Row> &&batch) {
+    const int keyIdx = getColumnIndex(partitioning.column);
+    const std::map<std::string, int> countersBefore = autoIncrementCounters;
+    std::vector<std::vector<Row>> routed(partitions.size());
+    for (auto& row : batch) {
+        Row complete = completeRow(std::move(row));
+        routed[partitioning.partitionOf(complete.values[keyIdx])].push_back(std::move(complete));
+    }
+
+    // Each partition only knows its own keys, so unique keys are checked against every partition
+    // here, before any of them changes. Equal partition keys always share a partition.
+    for (std::size_t colIdx = 0; colIdx < columns.size(); colIdx++) {
+        const Column& col = columns[colIdx];
+        if (!col.indexed || !col.uniqueIndex) continue;
+        std::set<Value> seen;
+        for (std::size_t p = 0; p < routed.size(); p++) {
+            for (const auto& row : routed[p]) {
+                const Value& key = row.values[colIdx];
+                if (!partitions[p].getIndex(col.name)->accepts(key)) continue;
+                bool taken = !seen.insert(key).second;
+                for (std::size_t q = 0; q < partitions.size() && !taken; q++) {
+                    if (static_cast<int>(colIdx) == keyIdx && q != p) continue;
+                    taken = !partitions[q].getIndex(col.name)->find(key).empty();
+                }
+                if (taken) {
+                    autoIncrementCounters = countersBefore;
+                    throw std::runtime_error("Duplicate value " + key.toString() + " for unique column " + col.name);
+                }
+            }
+        }
+    }
+
+    dirty = true;
+    for (std::size_t p = 0; p < routed.size(); p++) {
+        if (routed[p].empty()) continue;
+        if (undoLog) logAppend(p, partitions[p].rows.size());
+        partitions[p].appendRows(std::move(routed[p]));
     }
 }
 
 void Table::removeRow(std::size_t rowIdx) {
-    if (rowIdx >= rows.size()) return;
+    removeRows({rowIdx});
+}
+
+void Table::removeRows(const std::vector<std::size_t> &rowIdxs) {
+    // rowIdxs must be ascending; survivors are compacted in one pass and every index is rebuilt once.
+    if (undoLog) logRemoval(0, rows, rowIdxs);
+    std::size_t next = 0;
+    std::size_t write = 0;
+    for (std::size_t read = 0; read < rows.size(); read++) {
+        if (next < rowIdxs.size() && rowIdxs[next] == read) {
+            next++;
+            continue;
+        }
+        if (write != read) rows[write] = std::move(rows[read]);
+        write++;
+    }
+    if (write == rows.size()) return;
+    rows.resize(write);
+    dirty = true;
+    version = newVersion();
+    // Surviving rows shift into other blocks, so the zone maps are rebuilt along with the indexes.
+    rebuildDerived();
+}
 
-    rows.erase(rows.begin() + rowIdx);
+void Table::rebuildDerived() {
+    blocks.clear();
+    blockBytes = 0;
+    stringBytes = 0;
+    for (std::size_t i = 0; i < rows.size(); i++) {
+        summarizeRow(i);
+        stringBytes += rowStringBytes(rows[i]);
+    }
 
     for (auto& [colName, index] : indices) {
         index.clear();
@@ -71,16 +420,71 @@ void Table::removeRow(std::size_t rowIdx) {
         if (colIdx == -1) continue;
 
         for (std::size_t i = 0; i < rows.size(); i++) {
-            index.insert(rows[i].values[colIdx], i);
+            index.insert(rows[i].values[colIdx], i, &rows[i]);
+        }
+    }
+    for (auto& [colName, trigrams] : trigramIndices) {
+        trigrams.clear();
+        const int colIdx = getColumnIndex(colName);
+        for (std::size_t i = 0; i < rows.size(); i++) trigrams.insert(rows[i].values[colIdx], i);
+    }
+}
+
+void Table::updateRows(const std::vector<std::size_t> &rowIdxs, const std::vector<Assignment> &assignments) {
+    for (const auto& assignment : assignments) {
+        const Column& col = columns.at(assignment.column);
+        auto index = indices.find(col.name);
+        if (index == indices.end() || !index->second.getIsUnique() || rowIdxs.empty()) continue;
+
+        const std::vector<std::size_t> holders = index->second.find(assignment.value);
+        if (rowIdxs.size() > 1 || (!holders.empty() && holders.front() != rowIdxs.front())) {
+            throw std::runtime_error("Duplicate value " + assignment.value.toString() + " for unique column " + col.name);
+        }
+    }
+    if (rowIdxs.empty()) return;
+    if (undoLog) logUpdate(0, rows, rowIdxs, assignments);
+    dirty = true;
+    version = newVersion();
+
+    for (const auto& assignment : assignments) {
+        const Column& col = columns[assignment.column];
+        if (col.autoIncrement && assignment.value.type == DataType::DOUBLE &&
+            assignment.value.numValue >= autoIncrementCounters[col.name]) {
+            autoIncrementCounters[col.name] = assignment.value.numValue + 1;
+        }
+
+        auto index = indices.find(col.name);
+        auto trigrams = trigramIndices.find(col.name);
+        // Covering indexes holding the column among their INCLUDE values, with their key columns.
+        std::vector<std::pair<ColumnIndex*, std::size_t>> covering;
+        for (auto& [indexedName, other] : indices) {
+            if (std::ranges::find(other.getIncluded(), assignment.column) != other.getIncluded().end()) {
+                covering.emplace_back(&other, getColumnIndex(indexedName));
+            }
+        }
+        for (std::size_t rowIdx : rowIdxs) {
+            Value& cell = rows[rowIdx].values[assignment.column];
+            if (index != indices.end()) index->second.remove(cell, rowIdx);
+            if (trigrams != trigramIndices.end()) trigrams->second.remove(cell, rowIdx);
+            stringBytes -= stringHeapBytes(cell.strValue);
+            cell = assignment.value;
+            stringBytes += stringHeapBytes(cell.strValue);
+            if (index != indices.end()) index->second.insert(cell, rowIdx, &rows[rowIdx]);
+            if (trigrams != trigramIndices.end()) trigrams->second.insert(cell, rowIdx);
+            for (auto [other, keyIdx] : covering) {
+                other->updateIncluded(rows[rowIdx].values[keyIdx], rowIdx, assignment.column, cell);
+            }
+            // Bounds only ever widen: the old value may still be elsewhere in the block.
+            widenBlock(blocks[rowIdx / blockSize], assignment.column, cell);
         }
     }
 }
 
-std::vector<Column> Table::getColumns() const {
+const std::vector<Column>& Table::getColumns() const {
     return columns;
 }
 
-std::vector<Row> Table::getRows() const {
+const std::vector<Row>& Table::getRows() const {
     return rows;
 }
 
@@ -88,15 +492,57 @@ std::string Table::getName() const {
     return name;
 }
 
-std::size_t Table::getDataSize() const {
-    size_t size = 0;
-    for (const auto& row : rows) {
-        for (const auto& val : row.values) {
-            if (val.type == DataType::DOUBLE) size += sizeof(double);
-            else size += val.strValue.size();
+const ColumnIndex *Table::getIndex(const std::string &colName) const {
+    auto it = indices.find(colName);
+    return it == indices.end() ? nullptr : &it->second;
+}
+
+const TrigramIndex *Table::getTrigramIndex(const std::string &colName) const {
+    auto it = trigramIndices.find(colName);
+    return it == trigramIndices.end() ? nullptr : &it->second;
+}
+
+std::size_t Table::getBlockCount() const {
+    return blocks.size();
+}
+
+const BlockSummary &Table::getBlock(std::size_t blockIdx) const {
+    return blocks[blockIdx];
+}
+
+MemoryUsage Table::getMemoryUsage() const {
+    MemoryUsage usage;
+    usage.rowBytes = rows.capacity() * sizeof(Row) + (rowMemory ? rowMemory->tracker.getBytes() : 0);
+    usage.stringBytes = stringBytes;
+    for (const auto& [colName, index] : indices) {
+        usage.indexBytes += index.memoryUsage();
+    }
+    for (const auto& [colName, trigrams] : trigramIndices) {
+        usage.indexBytes += trigrams.memoryUsage();
+    }
+    usage.summaryBytes = blocks.capacity() * sizeof(BlockSummary) + blockBytes;
+    usage.undoBytes = undoLog ? undoLog->bytes : 0;
+    // A partitioned table's rows, indexes and zone maps are all in its partitions.
+    for (const auto& partition : partitions) usage += partition.getMemoryUsage();
+    return usage;
+}
+
+std::size_t Table::estimateAppendBytes(const std::vector<Row> &batch) const {
+    if (isPartitioned()) return partitions.front().estimateAppendBytes(batch);
+    // Per row: its slot in `rows`, a pooled array of every column, an entry in each index and
+    // one posting per trigram of each trigram-indexed value.
+    std::size_t bytes = batch.size() * (sizeof(Row) + columns.size() * sizeof(Value) +
+                                        indices.size() * (sizeof(std::string) + sizeof(std::size_t)));
+    for (const auto& row : batch) {
+        bytes += rowStringBytes(row);
+        for (const auto& [colName, trigrams] : trigramIndices) {
+            const int colIdx = getColumnIndex(colName);
+            if (colIdx < static_cast<int>(row.values.size()) && row.values[colIdx].strValue.size() > 2) {
+                bytes += (row.values[colIdx].strValue.size() - 2) * sizeof(std::size_t);
+            }
         }
     }
-    return size;
+    return bytes;
 }
 
 std::map<std::string, int> Table::getAutoIncrementCounters() const {
@@ -105,4 +551,291 @@ std::map<std::string, int> Table::getAutoIncrementCounters() const {
 
 void Table::setAutoIncrementCounters(const std::string &colName, const int &value) {
     autoIncrementCounters[colName] = value;
+    dirty = true;
+}
+
+const TableStats *Table::getStatistics() const {
+    return statistics ? &*statistics : nullptr;
+}
+
+void Table::setStatistics(TableStats stats) {
+    statistics = std::move(stats);
+    dirty = true;
+}
+
+bool Table::isDirty() const {
+    return dirty || std::ranges::any_of(partitions, &Table::isDirty);
+}
+
+void Table::markClean() {
+    dirty = false;
+    for (auto& partition : partitions) partition.markClean();
+}
+
+uint64_t Table::getVersion() const {
+    // Versions only grow, so the newest of the table's and its partitions' changes all of them.
+    uint64_t newest = version;
+    for (const auto& partition : partitions) newest = std::max(newest, partition.getVersion());
+    return newest;
+}
+
+bool Table::isPartitioned() const {
+    return partitioning.kind != PartitionKind::NONE;
+}
+
+const PartitionScheme &Table::getPartitioning() const {
+    return partitioning;
+}
+
+const std::vector<Table> &Table::getPartitions() const {
+    return partitions;
+}
+
+std::size_t Table::getRowCount() const {
+    std::size_t count = rows.size();
+    for (const auto& partition : partitions) count += partition.getRowCount();
+    return count;
+}
+
+void Table::removePartitionRows(std::size_t partition, const std::vector<std::size_t> &rowIdxs) {
+    if (undoLog) logRemoval(partition, partitions.at(partition).rows, rowIdxs);
+    partitions.at(partition).removeRows(rowIdxs);
+}
+
+void Table::updatePartitionRows(const std::vector<std::size_t> &partitionIdxs,
+                                const std::vector<std::vector<std::size_t>> &rowIdxs,
+                                const std::vector<Assignment> &assignments) {
+    std::vector<bool> holdsMatch(partitions.size(), false);
+    std::size_t matched = 0;
+    for (std::size_t i = 0; i < partitionIdxs.size(); i++) {
+        matched += rowIdxs[i].size();
+        if (!rowIdxs[i].empty()) holdsMatch.at(partitionIdxs[i]) = true;
+    }
+
+    for (const auto& assignment : assignments) {
+        const Column& col = columns.at(assignment.column);
+        if (col.name == partitioning.column) {
+            throw std::runtime_error("Cannot update partition column " + col.name + " of table " + name);
+        }
+        if (!col.indexed || !col.uniqueIndex || matched == 0) continue;
+
+        // One row may take the value if no other partition holds it; its own partition checks itself.
+        bool taken = matched > 1;
+        for (std::size_t q = 0; q < partitions.size() && !taken; q++) {
+            taken = !holdsMatch[q] && !partitions[q].getIndex(col.name)->find(assignment.value).empty();
+        }
+        if (taken) throw std::runtime_error("Duplicate value " + assignment.value.toString() + " for unique column " + col.name);
+    }
+
+    for (std::size_t i = 0; i < partitionIdxs.size(); i++) {
+        if (undoLog) logUpdate(partitionIdxs[i], partitions.at(partitionIdxs[i]).rows, rowIdxs[i], assignments);
+        partitions.at(partitionIdxs[i]).updateRows(rowIdxs[i], assignments);
+    }
+    for (const auto& assignment : assignments) {
+        const Column& col = columns[assignment.column];
+        if (matched > 0 && col.autoIncrement && assignment.value.type == DataType::DOUBLE &&
+            assignment.value.numValue >= autoIncrementCounters[col.name]) {
+            autoIncrementCounters[col.name] = assignment.value.numValue + 1;
+            dirty = true;
+        }
+    }
+}
+
+void Table::setPartitionStatistics(std::size_t partition, TableStats stats) {
+    partitions.at(partition).setStatistics(std::move(stats));
+}
+
+void Table::addPartition(const Value &bound) {
+    if (partitioning.kind != PartitionKind::RANGE) throw std::runtime_error("Table " + name + " is not RANGE partitioned");
+    if ((bound.type == DataType::DOUBLE) != (partitioning.bounds.front().type == DataType::DOUBLE)) {
+        throw std::runtime_error("Partition bound " + bound.toString() + " does not match the type of " + partitioning.column);
+    }
+    if (partitions.size() == PartitionScheme::maxPartitions) {
+        throw std::runtime_error("A table can have at most " + std::to_string(PartitionScheme::maxPartitions) + " partitions");
+    }
+    const std::size_t split = partitioning.partitionOf(bound);
+    if (split > 0 && !(partitioning.bounds[split - 1] < bound)) {
+        throw std::runtime_error("Partition bound " + bound.toString() + " already exists");
+    }
+
+    if (undoLog) logImage();
+    const int keyIdx = getColumnIndex(partitioning.column);
+    std::vector<Row> lowerRows;
+    std::vector<Row> upperRows;
+    for (const auto& row : partitions[split].getRows()) {
+        (row.values[keyIdx] < bound ? lowerRows : upperRows).emplace_back(row);
+    }
+    Table lower(name, columns);
+    Table upper(name, columns);
+    lower.appendRows(std::move(lowerRows));
+    upper.appendRows(std::move(upperRows));
+
+    partitions[split] = std::move(lower);
+    partitions.insert(partitions.begin() + split + 1, std::move(upper));
+    partitioning.bounds.insert(partitioning.bounds.begin() + split, bound);
+    dirty = true;
+    version = newVersion();
+}
+
+std::size_t Table::dropPartition(const Value &key) {
+    if (partitioning.kind != PartitionKind::RANGE) throw std::runtime_error("Table " + name + " is not RANGE partitioned");
+    if (partitions.size() == 1) throw std::runtime_error("The last partition of " + name + " cannot be dropped");
+
+    if (undoLog) logImage();
+    const std::size_t dropped = partitioning.partitionOf(key);
+    const std::size_t rowCount = partitions[dropped].getRowCount();
+    // Dropping the bound below the partition hands its range to the partition before it; the
+    // first partition has none, so the next one extends downwards instead.
+    partitioning.bounds.erase(partitioning.bounds.begin() + (dropped == 0 ? 0 : dropped - 1));
+    partitions.erase(partitions.begin() + dropped);
+    dirty = true;
+    version = newVersion();
+    return rowCount;
+}
+
+void Table::loadPartitions(std::vector<Table> loaded) {
+    if (loaded.size() != partitions.size()) {
+        throw std::runtime_error("Table " + name + " has " + std::to_string(partitions.size()) + " partitions, got " +
+                                 std::to_string(loaded.size()));
+    }
+    partitions = std::move(loaded);
+}
+
+void Table::beginUndoLog() {
+    undoLog = std::make_unique<UndoLog>();
+    undoLog->autoIncrementCounters = autoIncrementCounters;
+    undoLog->statistics = statistics;
+    undoLog->version = version;
+    undoLog->dirty = isDirty();
+    for (const auto& partition : partitions) {
+        undoLog->partitionStatistics.push_back(partition.statistics);
+        undoLog->partitionVersions.push_back(partition.version);
+    }
+}
+
+void Table::commitUndoLog() {
+    undoLog.reset();
+}
+
+void Table::rollbackUndoLog() {
+    if (!undoLog) return;
+    const std::unique_ptr<UndoLog> log = std::move(undoLog);
+    undo(*log);
+}
+
+Table Table::committedImage() const {
+    Table image(*this);
+    if (undoLog) image.undo(*undoLog);
+    return image;
+}
+
+bool Table::isCommittedDirty() const {
+    return undoLog ? undoLog->dirty : isDirty();
+}
+
+void Table::logAppend(std::size_t partition, std::size_t firstRow) {
+    // Appends right after one another take back together.
+    if (!undoLog->entries.empty() && undoLog->entries.back().kind == UndoKind::APPEND &&
+        undoLog->entries.back().partition == partition) {
+        return;
+    }
+    UndoEntry& entry = undoLog->entries.emplace_back();
+    entry.kind = UndoKind::APPEND;
+    entry.partition = partition;
+    entry.firstRow = firstRow;
+    undoLog->bytes += undoEntryBytes(entry);
+}
+
+void Table::logRemoval(std::size_t partition, const std::vector<Row> &from, const std::vector<std::size_t> &rowIdxs) {
+    if (rowIdxs.empty()) return;
+    UndoEntry entry;
+    entry.kind = UndoKind::REMOVE;
+    entry.partition = partition;
+    entry.removedRows.reserve(rowIdxs.size());
+    // Copied out of the table's pool, which a partition split or drop may release before the log.
+    for (std::size_t rowIdx : rowIdxs) {
+        entry.removedRows.emplace_back(rowIdx, Row(from[rowIdx], std::pmr::get_default_resource()));
+    }
+    undoLog->bytes += undoEntryBytes(entry);
+    undoLog->entries.push_back(std::move(entry));
+}
+
+void Table::logUpdate(std::size_t partition, const std::vector<Row> &from, const std::vector<std::size_t> &rowIdxs,
+                      const std::vector<Assignment> &assignments) {
+    if (rowIdxs.empty()) return;
+    UndoEntry entry;
+    entry.kind = UndoKind::UPDATE;
+    entry.partition = partition;
+    entry.oldCells.reserve(rowIdxs.size() * assignments.size());
+    for (const auto& assignment : assignments) {
+        for (std::size_t rowIdx : rowIdxs) {
+            entry.oldCells.emplace_back(rowIdx, assignment.column, from[rowIdx].values[assignment.column]);
+        }
+    }
+    undoLog->bytes += undoEntryBytes(entry);
+    undoLog->entries.push_back(std::move(entry));
+}
+
+void Table::logImage() {
+    UndoEntry entry;
+    entry.kind = UndoKind::IMAGE;
+    entry.image = std::make_unique<const Table>(*this);
+    undoLog->bytes += undoEntryBytes(entry);
+    undoLog->entries.push_back(std::move(entry));
+}
+
+void Table::undo(const UndoLog &log) {
+    // Rows go back entry by entry; the zone maps and indexes of each table whose rows changed are
+    // rebuilt once at the end.
+    std::vector<bool> changed(std::max<std::size_t>(partitions.size(), 1), false);
+    for (auto entry = log.entries.rbegin(); entry != log.entries.rend(); ++entry) {
+        if (entry->kind == UndoKind::IMAGE) {
+            *this = *entry->image;
+            changed.assign(std::max<std::size_t>(partitions.size(), 1), false);
+            continue;
+        }
+        (isPartitioned() ? partitions.at(entry->partition) : *this).undoRows(*entry);
+        changed[entry->partition] = true;
+    }
+    for (std::size_t p = 0; p < changed.size(); p++) {
+        if (changed[p]) (isPartitioned() ? partitions[p] : *this).rebuildDerived();
+    }
+
+    autoIncrementCounters = log.autoIncrementCounters;
+    statistics = log.statistics;
+    version = log.version;
+    for (std::size_t p = 0; p < partitions.size(); p++) {
+        partitions[p].statistics = log.partitionStatistics[p];
+        partitions[p].version = log.partitionVersions[p];
+    }
+    if (log.dirty) {
+        dirty = true;
+    } else {
+        markClean();
+    }
+}
+
+void Table::undoRows(const UndoEntry &entry) {
+    if (entry.kind == UndoKind::APPEND) {
+        rows.resize(entry.firstRow);
+    } else if (entry.kind == UndoKind::REMOVE) {
+        std::vector<Row> merged;
+        merged.reserve(rows.size() + entry.removedRows.size());
+        auto removed = entry.removedRows.begin();
+        std::size_t kept = 0;
+        while (kept < rows.size() || removed != entry.removedRows.end()) {
+            if (removed != entry.removedRows.end() && removed->first == merged.size()) {
+                merged.emplace_back(removed->second, &rowMemory->pool);
+                ++removed;
+            } else {
+                merged.push_back(std::move(rows[kept++]));
+            }
+        }
+        rows = std::move(merged);
+    } else if (entry.kind == UndoKind::UPDATE) {
+        for (auto cell = entry.oldCells.rbegin(); cell != entry.oldCells.rend(); ++cell) {
+            const auto& [rowIdx, colIdx, value] = *cell;
+            rows[rowIdx].values[colIdx] = value;
+        }
+    }
 }
\ No newline at end of file
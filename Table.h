@@ -2,29 +2,179 @@
 #define PROEKT_TABLE_H
 
 #include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <optional>
+#include <tuple>
 #include <utility>
+#include "BloomFilter.h"
 #include "Index.h"
+#include "Memory.h"
+#include "Partition.h"
+#include "Statistics.h"
+#include "TrigramIndex.h"
+
+// Min/max of every column over one block of consecutive rows (a zone map). Scans skip blocks
+// whose bounds show that no row can satisfy the predicate.
+struct BlockSummary {
+    std::vector<Value> min;
+    std::vector<Value> max;
+    std::vector<bool> mixedTypes; // the column holds both numbers and strings here, so min/max are not bounds
+    std::vector<BloomFilter> blooms; // one per column; empty (always "maybe") unless Column::bloomFilter
+};
+
+// One `col = value` of an UPDATE; `column` is the column's position in the table.
+struct Assignment {
+    std::size_t column;
+    Value value;
+};
+
+class Table;
+
+enum class UndoKind { APPEND, REMOVE, UPDATE, IMAGE };
+
+// One change recorded in an undo log. Row positions are those at the time of the change, so
+// entries are undone newest first.
+struct UndoEntry {
+    UndoKind kind = UndoKind::APPEND;
+    std::size_t partition = 0;                             // of a partitioned table, the partition changed
+    std::size_t firstRow = 0;                              // APPEND: rows from here on are new
+    std::vector<std::pair<std::size_t, Row>> removedRows;  // REMOVE: ascending positions before the removal
+    std::vector<std::tuple<std::size_t, std::size_t, Value>> oldCells; // UPDATE: row, column and the value it had
+    std::unique_ptr<const Table> image;                    // IMAGE: the whole table before a partition split or drop
+};
+
+// What a transaction changed in a table since its first write, and the small state it had then.
+struct UndoLog {
+    std::vector<UndoEntry> entries;
+    std::map<std::string, int> autoIncrementCounters;
+    std::optional<TableStats> statistics;
+    std::vector<std::optional<TableStats>> partitionStatistics;
+    uint64_t version = 0;
+    std::vector<uint64_t> partitionVersions;
+    bool dirty = false;
+    std::size_t bytes = 0; // what the entries hold, counted as they are added
+};
 
 class Table {
     std::string name;
     std::vector<Column> columns;
+    // Value arrays of all rows come from this pool: rows of one table share a size class, so
+    // allocation is a free-list pop and deleted rows' memory is reused instead of fragmenting
+    // the heap. The pool takes its chunks through `tracker`, which counts them. Declared before
+    // `rows`, which must be destroyed first.
+    struct RowMemory {
+        TrackingResource tracker;
+        std::pmr::unsynchronized_pool_resource pool{&tracker};
+    };
+    std::unique_ptr<RowMemory> rowMemory = std::make_unique<RowMemory>();
     std::vector<Row> rows;
-    std::map<std::string, Index> indices; //column name -> index
+    std::size_t stringBytes = 0; // heap buffers of the string values in `rows`
+    std::map<std::string, ColumnIndex> indices; //column name -> index
+    std::map<std::string, TrigramIndex> trigramIndices;
     std::map<std::string, int> autoIncrementCounters;
+    std::optional<TableStats> statistics; // set by ANALYZE
+    std::vector<BlockSummary> blocks;     // blocks[i] covers rows [i * blockSize, (i + 1) * blockSize)
+    std::size_t blockBytes = 0;           // bounds and Bloom filters of `blocks`, kept as they change
+    bool dirty = true;                    // changed since it was last read from or written to disk
+    uint64_t version = newVersion();      // see getVersion
+    // A partitioned table keeps its rows, indexes and zone maps in `partitions`, one table per
+    // partition of the scheme, and only the schema and auto-increment counters itself.
+    PartitionScheme partitioning;
+    std::vector<Table> partitions;
+    std::unique_ptr<UndoLog> undoLog; // set while a transaction writes the table; copies leave it behind
+
+    static uint64_t newVersion();
+
+    Row completeRow(Row&& row);
+    void appendToPartitions(std::vector<Row>&& batch);
+    void appendCompleted(Row&& row);
+    void summarizeRow(std::size_t rowIdx);
+    void widenBlock(BlockSummary& block, std::size_t colIdx, const Value& value);
+    // Zone maps, string bytes and indexes recomputed from `rows`.
+    void rebuildDerived();
+    void logAppend(std::size_t partition, std::size_t firstRow);
+    void logRemoval(std::size_t partition, const std::vector<Row>& from, const std::vector<std::size_t>& rowIdxs);
+    void logUpdate(std::size_t partition, const std::vector<Row>& from, const std::vector<std::size_t>& rowIdxs,
+                   const std::vector<Assignment>& assignments);
+    void logImage();
+    void undo(const UndoLog& log);
+    void undoRows(const UndoEntry& entry);
 
 public:
+    static constexpr std::size_t blockSize = 1024;
+
     Table() = default;
-    Table(std::string  name, const std::vector<Column>& columns);
+    // Throws std::runtime_error for a partition scheme that does not fit the columns.
+    Table(std::string  name, const std::vector<Column>& columns, PartitionScheme partitioning = {});
+    Table(const Table& other);
+    Table(Table&& other) noexcept = default;
+    Table& operator=(Table other) noexcept;
+    friend void swap(Table& a, Table& b) noexcept;
 
     int getColumnIndex(const std::string& name) const;
-    void insertRow(Row& row);
+    void insertRow(Row row);
+    // Bulk path for multi-row INSERT, loading and imports: completes every row, checks unique
+    // constraints for the whole batch at once (throwing before anything is appended) and merges
+    // each index's sorted keys in a single pass. A large batch builds its indexes on one thread
+    // each; `indexSeconds`, when given, is credited with the time spent on them.
+    void appendRows(std::vector<Row>&& batch, double* indexSeconds = nullptr);
     void removeRow(std::size_t rowIdx);
-    std::vector<Column> getColumns() const;
-    std::vector<Row> getRows() const;
+    void removeRows(const std::vector<std::size_t>& rowIdxs);
+    // Overwrites the assigned columns of the given rows in place. Only the indexes of assigned
+    // columns are touched; a unique-index conflict throws before anything is changed.
+    void updateRows(const std::vector<std::size_t>& rowIdxs, const std::vector<Assignment>& assignments);
+    const std::vector<Column>& getColumns() const;
+    const std::vector<Row>& getRows() const;
     std::string getName() const;
-    std::size_t getDataSize() const;
+    const ColumnIndex* getIndex(const std::string& colName) const;
+    const TrigramIndex* getTrigramIndex(const std::string& colName) const;
+    std::size_t getBlockCount() const;
+    const BlockSummary& getBlock(std::size_t blockIdx) const;
+    // Adds up byte counts kept as rows, zone maps and index nodes change; no row or block is walked.
+    MemoryUsage getMemoryUsage() const;
+    // Rough bytes `batch` will take once appended: rows, values, strings and index entries.
+    std::size_t estimateAppendBytes(const std::vector<Row>& batch) const;
     std::map<std::string, int> getAutoIncrementCounters() const;
     void setAutoIncrementCounters(const std::string& colName, const int& value);
+    const TableStats* getStatistics() const;
+    void setStatistics(TableStats stats);
+    bool isDirty() const;
+    void markClean();
+    // Identifies the rows as they are now: a new table and every write take a version no table
+    // has had before, while copies (such as undo images) keep theirs. Cached results compare it.
+    uint64_t getVersion() const;
+
+    // Partitioning. Inserts route every row to its partition; unique columns are checked across
+    // all partitions. Row ids of the partition methods are positions within that partition.
+    bool isPartitioned() const;
+    const PartitionScheme& getPartitioning() const;
+    const std::vector<Table>& getPartitions() const;
+    // Rows of the table, of all partitions when it is partitioned.
+    std::size_t getRowCount() const;
+    void removePartitionRows(std::size_t partition, const std::vector<std::size_t>& rowIdxs);
+    // `rowIdxs[i]` are rows of partition `partitionIdxs[i]`. The partition column cannot be assigned.
+    void updatePartitionRows(const std::vector<std::size_t>& partitionIdxs, const std::vector<std::vector<std::size_t>>& rowIdxs,
+                             const std::vector<Assignment>& assignments);
+    void setPartitionStatistics(std::size_t partition, TableStats stats);
+    // RANGE only. Splits the partition holding `bound` there (only that partition's rows move).
+    void addPartition(const Value& bound);
+    // RANGE only. Discards the partition holding `key` with all its rows, without scanning them or
+    // touching any other partition; its neighbour takes over its range. Returns the rows dropped.
+    std::size_t dropPartition(const Value& key);
+    // Installs partitions read from disk, one for every partition of the scheme.
+    void loadPartitions(std::vector<Table> loaded);
+
+    // Transactions. While the undo log is on, every write records only what it overwrites: the
+    // rows appended, the rows removed and the old values of updated cells (partition splits and
+    // drops, being rare, keep a copy of the table). Nothing is copied up front.
+    void beginUndoLog();
+    void commitUndoLog(); // forgets the log, keeping the changes
+    void rollbackUndoLog();
+    // The table as it was when the log began: a copy with the log undone, for readers outside
+    // the transaction. isCommittedDirty() is its isDirty() without building it.
+    Table committedImage() const;
+    bool isCommittedDirty() const;
 };
 
 #endif //PROEKT_TABLE_H
\ No newline at end of file
@@ -0,0 +1,81 @@
+#include "TrigramIndex.h"
+#include <algorithm>
+#include <iterator>
+
+namespace {
+    // A node holds the key, the vector and the next pointer.
+    constexpr std::size_t nodeBytes = sizeof(void*) + sizeof(uint32_t) + sizeof(std::vector<std::size_t>);
+}
+
+std::vector<uint32_t> TrigramIndex::trigramsOf(std::string_view text) {
+    std::vector<uint32_t> trigrams;
+    for (std::size_t i = 0; i + 3 <= text.size(); i++) {
+        trigrams.push_back(static_cast<uint32_t>(static_cast<unsigned char>(text[i])) << 16 |
+                           static_cast<uint32_t>(static_cast<unsigned char>(text[i + 1])) << 8 |
+                           static_cast<unsigned char>(text[i + 2]));
+    }
+    std::ranges::sort(trigrams);
+    const auto duplicates = std::ranges::unique(trigrams);
+    trigrams.erase(duplicates.begin(), duplicates.end());
+    return trigrams;
+}
+
+void TrigramIndex::insert(const Value &value, std::size_t rowIdx) {
+    if (value.type == DataType::DOUBLE) return;
+    for (uint32_t trigram : trigramsOf(value.strValue)) {
+        auto [posting, added] = postings.try_emplace(trigram);
+        std::vector<std::size_t>& rows = posting->second;
+        const std::size_t capacity = rows.capacity();
+        // Appends come in row order; only updates land in the middle of a list.
+        if (rows.empty() || rows.back() < rowIdx) {
+            rows.push_back(rowIdx);
+        } else if (auto it = std::ranges::lower_bound(rows, rowIdx); *it != rowIdx) {
+            rows.insert(it, rowIdx);
+        }
+        postingBytes += (added ? nodeBytes : 0) + (rows.capacity() - capacity) * sizeof(std::size_t);
+    }
+}
+
+void TrigramIndex::remove(const Value &value, std::size_t rowIdx) {
+    if (value.type == DataType::DOUBLE) return;
+    for (uint32_t trigram : trigramsOf(value.strValue)) {
+        auto posting = postings.find(trigram);
+        if (posting == postings.end()) continue;
+        std::vector<std::size_t>& rows = posting->second;
+        auto it = std::ranges::lower_bound(rows, rowIdx);
+        if (it != rows.end() && *it == rowIdx) rows.erase(it);
+        if (rows.empty()) {
+            postingBytes -= nodeBytes + rows.capacity() * sizeof(std::size_t);
+            postings.erase(posting);
+        }
+    }
+}
+
+void TrigramIndex::clear() {
+    postings.clear();
+    postingBytes = 0;
+}
+
+std::vector<std::size_t> TrigramIndex::candidates(const std::vector<uint32_t> &trigrams) const {
+    std::vector<const std::vector<std::size_t>*> lists;
+    for (uint32_t trigram : trigrams) {
+        auto posting = postings.find(trigram);
+        if (posting == postings.end()) return {};
+        lists.push_back(&posting->second);
+    }
+    if (lists.empty()) return {};
+    std::ranges::sort(lists, {}, &std::vector<std::size_t>::size);
+
+    std::vector<std::size_t> result = *lists.front();
+    std::vector<std::size_t> next;
+    for (std::size_t i = 1; i < lists.size() && !result.empty(); i++) {
+        next.clear();
+        std::ranges::set_intersection(result, *lists[i], std::back_inserter(next));
+        result.swap(next);
+    }
+    return result;
+}
+
+std::size_t TrigramIndex::memoryUsage() const {
+    return postings.bucket_count() * sizeof(void*) + postingBytes;
+}
\ No newline at end of file
@@ -0,0 +1,33 @@
+#ifndef PROEKT_TRIGRAMINDEX_H
+#define PROEKT_TRIGRAMINDEX_H
+
+#include <cstdint>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "Data.h"
+
+// Maps every three-byte substring (trigram) of a string column to the ascending ids of the rows
+// whose value contains it. A row can only match a LIKE pattern if its value holds every trigram
+// of the pattern's literal fragments, so intersecting their posting lists yields the candidate
+// rows, which are then checked against the pattern itself. Values shorter than three bytes have
+// no trigrams and are never candidates; neither are patterns without a fragment that long.
+class TrigramIndex {
+    std::unordered_map<uint32_t, std::vector<std::size_t>> postings;
+    // Nodes and row arrays of `postings`, kept up to date as lists grow and shrink (a copy, whose
+    // lists are trimmed, keeps the original's count as an upper bound).
+    std::size_t postingBytes = 0;
+
+public:
+    // The distinct trigrams of `text`, ascending.
+    static std::vector<uint32_t> trigramsOf(std::string_view text);
+
+    void insert(const Value& value, std::size_t rowIdx);
+    void remove(const Value& value, std::size_t rowIdx);
+    void clear();
+    // Rows holding all of `trigrams`, ascending; the shortest posting lists are intersected first.
+    std::vector<std::size_t> candidates(const std::vector<uint32_t>& trigrams) const;
+    std::size_t memoryUsage() const;
+};
+
+#endif //PROEKT_TRIGRAMINDEX_H
\ No newline at end of file
@@ -0,0 +1,274 @@
+#include <chrono>
+#include <filesystem>
+#include <functional>
+#include <random>
+#include "Session.h"
+
+// Benchmarks of the core engine paths over synthetic tables of increasing size.
+// Usage: bench [--scales 1000,10000,100000] [--seed N] [--output results.json]
+// Every run with the same seed and scales generates the same data.
+
+struct BenchConfig {
+    std::vector<std::size_t> scales = {1000, 10000, 100000};
+    uint64_t seed = 42;
+    std::string outputPath;
+};
+
+struct BenchResult {
+    std::string name;
+    std::size_t rows;
+    std::size_t operations;
+    double seconds;
+};
+
+class NullBuffer : public std::streambuf {
+protected:
+    int overflow(int c) override { return c; }
+    std::streamsize xsputn(const char*, std::streamsize n) override { return n; }
+};
+
+std::vector<Column> benchColumns() {
+    std::vector<Column> cols;
+    cols.emplace_back("ID", DataType::DOUBLE, true, true);
+    cols.back().autoIncrement = true;
+    cols.emplace_back("Category", DataType::DOUBLE, true);
+    cols.emplace_back("Score", DataType::DOUBLE);
+    cols.emplace_back("Name", DataType::STRING);
+    cols.emplace_back("Created", DataType::DATE);
+    return cols;
+}
+
+// Rows with ascending IDs, 100 categories, uniform scores in [0, 1e6), short names and dates spread over ten years.
+std::vector<Row> generateRows(std::size_t count, uint64_t seed) {
+    std::mt19937_64 rng(seed);
+    std::uniform_int_distribution<int> category(0, 99);
+    std::uniform_real_distribution<double> score(0, 1e6);
+    std::uniform_int_distribution<int> year(2015, 2024), month(1, 12), day(1, 28);
+
+    std::vector<Row> rows(count);
+    char date[16];
+    for (std::size_t i = 0; i < count; i++) {
+        std::snprintf(date, sizeof(date), "%04d-%02d-%02d", year(rng), month(rng), day(rng));
+        rows[i].values = {
+            Value(static_cast<double>(i + 1)), Value(static_cast<double>(category(rng))), Value(score(rng)),
+            Value("user" + std::to_string(rng() % 100000)), Value(date, DataType::DATE)
+        };
+    }
+    return rows;
+}
+
+double timeIt(const std::function<void()>& work) {
+    auto start = std::chrono::steady_clock::now();
+    work();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void runScale(std::size_t n, const BenchConfig& config, std::vector<BenchResult>& results) {
+    const std::string dbPath = "bench_" + std::to_string(n) + ".db";
+    std::remove(dbPath.c_str());
+    const std::vector<Row> data = generateRows(n, config.seed + n);
+    std::mt19937_64 rng(config.seed);
+    const std::size_t lookups = 100;
+
+    {
+        Table table("Bench", benchColumns());
+        std::vector<Row> rows = data;
+        results.push_back({"insert_row", n, n, timeIt([&] {
+            for (auto& row : rows) table.insertRow(row);
+        })});
+    }
+    {
+        Table table("Bench", benchColumns());
+        std::vector<Row> rows = data;
+        results.push_back({"append_rows", n, n, timeIt([&] { table.appendRows(std::move(rows)); })});
+    }
+
+    Database db(dbPath);
+    db.setGroupCommit(true);
+    db.createTable("Bench", benchColumns());
+    {
+        std::vector<Row> rows = data;
+        db.insert("Bench", rows);
+    }
+    StatementCache cache;
+    Session session(db, cache);
+
+    auto pointLookup = session.prepare("SELECT * FROM Bench WHERE ID = ?");
+    results.push_back({"point_lookup_indexed", n, lookups, timeIt([&] {
+        for (std::size_t i = 0; i < lookups; i++) {
+            session.query(*pointLookup, { Value(static_cast<double>(rng() % n + 1)) });
+        }
+    })});
+
+    // A batch of IDs fetched by one IN list, against one lookup per ID.
+    const std::size_t batchSize = 200;
+    std::string batchList;
+    for (std::size_t i = 0; i < batchSize; i++) batchList += (i ? ", " : "") + std::to_string(rng() % n + 1);
+    results.push_back({"batch_lookup_in_list", n, batchSize, timeIt([&] {
+        session.query("SELECT * FROM Bench WHERE ID IN (" + batchList + ")");
+    })});
+    results.push_back({"batch_lookup_per_id", n, batchSize, timeIt([&] {
+        for (std::size_t i = 0; i < batchSize; i++) {
+            session.query(*pointLookup, { Value(static_cast<double>(rng() % n + 1)) });
+        }
+    })});
+
+    auto scoreLookup = session.prepare("SELECT * FROM Bench WHERE Score = ?");
+    results.push_back({"point_lookup_unindexed", n, lookups, timeIt([&] {
+        for (std::size_t i = 0; i < lookups; i++) {
+            session.query(*scoreLookup, { data[rng() % n].values[2] });
+        }
+    })});
+
+    auto rangeFilter = session.prepare("SELECT ID, Score FROM Bench WHERE Score >= ? AND Score < ?");
+    results.push_back({"range_filter_10pct", n, 10, timeIt([&] {
+        for (int i = 0; i < 10; i++) {
+            double low = static_cast<double>(rng() % 900000);
+            session.query(*rangeFilter, { Value(low), Value(low + 100000) });
+        }
+    })});
+
+    const std::string smallStatement = "SELECT ID, Score FROM Bench WHERE Category = 3 AND Score >= 1000.5 ORDER BY Score";
+    const std::size_t parses = 10000;
+    results.push_back({"parse_statement", n, parses, timeIt([&] {
+        for (std::size_t i = 0; i < parses; i++) parseStatement(db, tokenize(smallStatement));
+    })});
+
+    results.push_back({"order_by", n, 1, timeIt([&] { session.query("SELECT * FROM Bench ORDER BY Score"); })});
+    results.push_back({"distinct", n, 1, timeIt([&] { session.query("SELECT DISTINCT Category FROM Bench"); })});
+
+    auto dashboard = session.prepare("SELECT Category, Score FROM Bench WHERE Score >= ? AND Score < ?");
+    const std::vector<Value> window = { Value(100000.0), Value(200000.0) };
+    results.push_back({"repeat_select", n, 10, timeIt([&] {
+        for (int i = 0; i < 10; i++) session.query(*dashboard, window);
+    })});
+    db.setResultCacheBudget(std::size_t(64) << 20);
+    results.push_back({"repeat_select_cached", n, 10, timeIt([&] {
+        for (int i = 0; i < 10; i++) session.query(*dashboard, window);
+    })});
+    db.setResultCacheBudget(0);
+
+    results.push_back({"save", n, 1, timeIt([&] { db.flush(); })});
+    std::unique_ptr<Database> reloaded;
+    results.push_back({"load", n, 1, timeIt([&] { reloaded = std::make_unique<Database>(dbPath); })});
+    results.push_back({"preload_tables", n, 1, timeIt([&] { reloaded->preloadTables(); })});
+    reloaded.reset();
+
+    auto statusUpdate = session.prepare("UPDATE Bench SET Category = ? WHERE Category < ?");
+    results.push_back({"update_10pct", n, 1, timeIt([&] { session.execute(*statusUpdate, { Value(5.0), Value(10.0) }); })});
+
+    auto bulkDelete = session.prepare("REMOVE Bench WHERE Category < ?");
+    results.push_back({"bulk_delete_10pct", n, 1, timeIt([&] { session.execute(*bulkDelete, { Value(10.0) }); })});
+
+    // Retention: the oldest year of ten goes with a REMOVE from a plain table, or as one
+    // DROPPARTITION from a table partitioned by year; the newest year is read from both.
+    PartitionScheme byYear;
+    byYear.kind = PartitionKind::RANGE;
+    byYear.column = "Created";
+    for (int year = 2016; year <= 2024; year++) byYear.bounds.emplace_back(std::to_string(year) + "-01-01", DataType::DATE);
+    db.createTable("History", benchColumns());
+    db.createTable("Yearly", benchColumns(), byYear);
+    for (const std::string tableName : {"History", "Yearly"}) {
+        std::vector<Row> rows = data;
+        db.insert(tableName, rows);
+    }
+    results.push_back({"recent_year_select", n, 1, timeIt([&] {
+        session.query("SELECT ID, Score FROM History WHERE Created >= \"2024-01-01\"");
+    })});
+    results.push_back({"recent_year_select_partitioned", n, 1, timeIt([&] {
+        session.query("SELECT ID, Score FROM Yearly WHERE Created >= \"2024-01-01\"");
+    })});
+
+    // The same category lookup through a plain index, which fetches each row, and through one
+    // covering Score, which never leaves the index.
+    std::vector<Column> coveredColumns = benchColumns();
+    coveredColumns[1].include = {"Score"};
+    db.createTable("Covered", coveredColumns);
+    {
+        std::vector<Row> rows = data;
+        db.insert("Covered", rows);
+    }
+    for (const std::string tableName : {"History", "Covered"}) {
+        auto categoryLookup = session.prepare("SELECT Category, Score FROM " + tableName + " WHERE Category = ?");
+        results.push_back({tableName == "History" ? "category_lookup" : "category_lookup_covering", n, lookups, timeIt([&] {
+            for (std::size_t i = 0; i < lookups; i++) session.query(*categoryLookup, { Value(static_cast<double>(rng() % 100)) });
+        })});
+    }
+
+    // A substring search on names by a full scan, and through a trigram index on them.
+    std::vector<Column> searchedColumns = benchColumns();
+    searchedColumns[3].trigramIndex = true;
+    db.createTable("Searched", searchedColumns);
+    {
+        std::vector<Row> rows = data;
+        db.insert("Searched", rows);
+    }
+    const std::size_t searches = 20;
+    for (const std::string tableName : {"History", "Searched"}) {
+        auto nameSearch = session.prepare("SELECT ID, Name FROM " + tableName + " WHERE Name LIKE ?");
+        results.push_back({tableName == "History" ? "name_substring_scan" : "name_substring_trigram", n, searches, timeIt([&] {
+            for (std::size_t i = 0; i < searches; i++) {
+                session.query(*nameSearch, { Value("%" + std::to_string(1000 + rng() % 9000) + "%") });
+            }
+        })});
+    }
+
+    auto retention = session.prepare("REMOVE History WHERE Created < \"2016-01-01\"");
+    results.push_back({"retention_remove", n, 1, timeIt([&] { session.execute(*retention); })});
+    results.push_back({"retention_drop_partition", n, 1, timeIt([&] {
+        db.dropPartition("Yearly", Value("2015-01-01", DataType::DATE));
+    })});
+
+    db.setGroupCommit(false);
+    std::remove(dbPath.c_str());
+    std::filesystem::remove_all(dbPath + ".tables");
+}
+
+void writeJson(std::ostream& out, const BenchConfig& config, const std::vector<BenchResult>& results) {
+    out << "{\n  \"seed\": " << config.seed << ",\n  \"results\": [\n";
+    for (std::size_t i = 0; i < results.size(); i++) {
+        const auto& r = results[i];
+        out << "    {\"benchmark\": \"" << r.name << "\", \"rows\": " << r.rows
+            << ", \"operations\": " << r.operations << ", \"seconds\": " << r.seconds
+            << ", \"ops_per_second\": " << (r.seconds > 0 ? r.operations / r.seconds : 0) << "}"
+            << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+}
+
+int main(int argc, char* argv[]) {
+    BenchConfig config;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string arg = argv[i];
+        if (arg == "--scales") {
+            config.scales.clear();
+            std::stringstream list(argv[i + 1]);
+            std::string item;
+            while (std::getline(list, item, ',')) config.scales.push_back(static_cast<std::size_t>(std::stod(item)));
+        } else if (arg == "--seed") {
+            config.seed = std::stoull(argv[i + 1]);
+        } else if (arg == "--output") {
+            config.outputPath = argv[i + 1];
+        }
+    }
+
+    // The engine reports on std::cout; keep that out of the JSON.
+    std::ostream report(std::cout.rdbuf());
+    NullBuffer sink;
+    std::cout.rdbuf(&sink);
+
+    std::vector<BenchResult> results;
+    for (std::size_t n : config.scales) {
+        std::cerr << "Running " << n << " rows..." << std::endl;
+        runScale(n, config, results);
+    }
+
+    if (config.outputPath.empty()) {
+        writeJson(report, config, results);
+    } else {
+        std::ofstream file(config.outputPath);
+        writeJson(file, config, results);
+    }
+    std::cout.rdbuf(report.rdbuf());
+    return 0;
+}
\ No newline at end of file
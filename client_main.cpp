@@ -0,0 +1,74 @@
+#include <arpa/inet.h>
+#include <cstring>
+#include <iostream>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "Protocol.h"
+
+int connectUnix(const std::string& path) {
+    sockaddr_un addr{};
+    if (path.size() >= sizeof(addr.sun_path)) throw std::runtime_error("Socket path too long: " + path);
+    addr.sun_family = AF_UNIX;
+    std::strcpy(addr.sun_path, path.c_str());
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0 || connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+        throw std::runtime_error("Could not connect to " + path + ": " + std::strerror(errno));
+    }
+    return fd;
+}
+
+int connectTcp(const std::string& host, uint16_t port) {
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    if (inet_pton(AF_INET, host.c_str(), &addr.sin_addr) != 1) throw std::runtime_error("Invalid address: " + host);
+
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0 || connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+        throw std::runtime_error("Could not connect to " + host + ":" + std::to_string(port) + ": " + std::strerror(errno));
+    }
+    return fd;
+}
+
+int main(int argc, char* argv[]) {
+    std::string unixPath;
+    std::string host = "127.0.0.1";
+    uint16_t port = 5432;
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string arg = argv[i];
+        if (arg == "--unix") unixPath = argv[i + 1];
+        else if (arg == "--host") host = argv[i + 1];
+        else if (arg == "--port") port = static_cast<uint16_t>(std::stoi(argv[i + 1]));
+    }
+
+    try {
+        int fd = unixPath.empty() ? connectTcp(host, port) : connectUnix(unixPath);
+        const bool interactive = isatty(STDIN_FILENO);
+        std::string command;
+        std::string response;
+
+        while (true) {
+            if (interactive) std::cout << "FMISql> " << std::flush;
+            if (!getline(std::cin, command)) break;
+            if (command.empty()) continue;
+
+            sendFrame(fd, command);
+            if (!receiveFrame(fd, response)) break;
+            std::cout << response << std::flush;
+
+            // The server hangs up after answering QUIT/EXIT.
+            std::string word = command.substr(0, command.find(' '));
+            for (char& c : word) c = static_cast<char>(toupper(c));
+            if (word == "QUIT" || word == "EXIT") break;
+        }
+        close(fd);
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,67 @@
+#include <csignal>
+#include "Server.h"
+
+Server* activeServer = nullptr;
+
+void handleSignal(int) {
+    if (activeServer) activeServer->stop();
+}
+
+void printUsage() {
+    std::cout << "Usage: server [--db PATH] [--memory-limit SIZE] [--result-cache SIZE] [--preload THREADS] [--unix SOCKET_PATH | --host ADDRESS --port PORT]" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    std::string dbPath = "fmisql.db";
+    std::string memoryLimit;
+    std::string resultCache;
+    std::string preload;
+    ServerConfig config;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--help") {
+            printUsage();
+            return 0;
+        }
+        if (i + 1 >= argc) {
+            printUsage();
+            return 1;
+        }
+        if (arg == "--db") dbPath = argv[++i];
+        else if (arg == "--memory-limit") memoryLimit = argv[++i];
+        else if (arg == "--result-cache") resultCache = argv[++i];
+        else if (arg == "--preload") preload = argv[++i];
+        else if (arg == "--unix") config.unixSocketPath = argv[++i];
+        else if (arg == "--host") config.host = argv[++i];
+        else if (arg == "--port") config.port = static_cast<uint16_t>(std::stoi(argv[++i]));
+        else {
+            printUsage();
+            return 1;
+        }
+    }
+
+    try {
+        Database db(dbPath);
+        if (!memoryLimit.empty()) db.setMemoryLimit(parseByteSize(memoryLimit));
+        if (!resultCache.empty()) db.setResultCacheBudget(parseByteSize(resultCache));
+        // Tables are otherwise read on first use; preloading moves that cost to start-up.
+        if (!preload.empty()) db.preloadTables(std::stoul(preload));
+        Server server(db, config);
+        activeServer = &server;
+        std::signal(SIGINT, handleSignal);
+        std::signal(SIGTERM, handleSignal);
+
+        if (config.unixSocketPath.empty()) {
+            std::cout << "FMISql server listening on " << config.host << ":" << server.getPort() << std::endl;
+        } else {
+            std::cout << "FMISql server listening on " << config.unixSocketPath << std::endl;
+        }
+        server.run();
+        activeServer = nullptr;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
\ No newline at end of file
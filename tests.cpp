@@ -1,6 +1,25 @@
 #include "catch2/catch_all.hpp"
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <numeric>
+#include <thread>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "Commands.h"
+#include "Compression.h"
 #include "Database.h"
 #include "Parser.h"
+#include "Protocol.h"
+#include "Server.h"
+#include "Storage.h"
+
+std::unique_ptr<Expression> parseTestWhere(Database& db, const std::string& tableName, const std::string& text) {
+    auto tokens = tokenize(text);
+    size_t pos = 0;
+    return Parser::parseWhereExpression(tokens, pos, db.getTable(tableName));
+}
 
 std::vector<Column> getTestColumns() {
     std::vector<Column> cols;
@@ -36,21 +55,69 @@ TEST_CASE("Value Comparisons and Date Logic", "[data]") {
 }
 
 TEST_CASE("Index and Constraints", "[index]") {
-    Index idx(true); // Unique index
+    Index<double> idx(true); // Unique index
 
     SECTION("Unique constraint violation") {
-        idx.insert(Value(1.0), 0);
-        CHECK_THROWS_AS(idx.insert(Value(1.0), 1), std::logic_error);
+        idx.insert(1.0, 0);
+        CHECK_THROWS_AS(idx.insert(1.0, 1), std::logic_error);
     }
 
     SECTION("Find in non-unique index") {
-        Index nonUnique(false);
-        nonUnique.insert(Value("Sofia"), 10);
-        nonUnique.insert(Value("Sofia"), 20);
+        Index<std::string> nonUnique(false);
+        nonUnique.insert("Sofia", 10);
+        nonUnique.insert("Sofia", 20);
 
-        auto results = nonUnique.find(Value("Sofia"));
+        auto results = nonUnique.find("Sofia");
         REQUIRE(results.size() == 2);
     }
+
+    SECTION("Sorted batches merge between existing keys") {
+        ColumnIndex nonUnique(DataType::DOUBLE, false);
+        for (double key : {10.0, 20.0, 30.0}) nonUnique.insert(Value(key), static_cast<size_t>(key));
+        const std::vector<Value> keys = {Value(5.0), Value(20.0), Value(20.0), Value(25.0), Value(40.0)};
+        nonUnique.insertSorted({{&keys[0], 100}, {&keys[1], 101}, {&keys[2], 102}, {&keys[3], 103}, {&keys[4], 104}});
+        CHECK(nonUnique.find(Value(20.0)) == std::vector<size_t>{20, 101, 102});
+        CHECK(nonUnique.findRange(nullptr, true, nullptr, true) == std::vector<size_t>{100, 10, 20, 101, 102, 103, 30, 104});
+        CHECK(nonUnique.find(Value("20")).empty());
+
+        ColumnIndex unique(DataType::DOUBLE, true);
+        unique.insert(Value(2.0), 0);
+        CHECK_THROWS_AS(unique.insertSorted({{&keys[0], 1}, {&keys[1], 2}, {&keys[2], 3}}), std::logic_error);
+    }
+
+    SECTION("B+tree stays ordered through splits and removals") {
+        Index<double> tree(false);
+        std::vector<double> keys;
+        for (int i = 0; i < 5000; i++) keys.push_back((i * 7919) % 5000 / 10.0);
+        for (std::size_t i = 0; i < keys.size(); i++) tree.insert(keys[i], i);
+        for (std::size_t i = 0; i < keys.size(); i += 3) tree.remove(keys[i], i);
+
+        const double low = 100.0, high = 200.0;
+        std::vector<size_t> expected;
+        for (std::size_t i = 0; i < keys.size(); i++) {
+            if (i % 3 != 0 && keys[i] > low && keys[i] <= high) expected.push_back(i);
+        }
+        std::vector<size_t> found = tree.findRange(&low, false, &high, true);
+        CHECK(std::ranges::is_sorted(found, {}, [&](size_t row) { return keys[row]; }));
+        std::ranges::sort(found);
+        CHECK(found == expected);
+
+        Index<double> copy = tree;
+        copy.insert(150.05, 9999);
+        CHECK(tree.find(150.05).empty());
+        CHECK(copy.find(150.05) == std::vector<size_t>{9999});
+
+        // Exact ordering: keys closer than Value's epsilon stay distinct.
+        Index<double> exact(true);
+        exact.insert(1.0, 0);
+        exact.insert(1.000001, 1);
+        CHECK(exact.find(1.0) == std::vector<size_t>{0});
+
+        Index<std::string> dates(true);
+        for (const char* date : {"2024-03-01", "2023-12-31", "2024-01-15"}) dates.insert(date, dates.findRange(nullptr, true, nullptr, true).size());
+        const std::string from = "2024-01-01";
+        CHECK(dates.findRange(&from, true, nullptr, true) == std::vector<size_t>{2, 0});
+    }
 }
 
 TEST_CASE("Table Row Management", "[table]") {
@@ -75,13 +142,48 @@ TEST_CASE("Table Row Management", "[table]") {
         table.removeRow(0);
         CHECK(table.getRows().empty());
     }
+
+    SECTION("Inserted values are moved, copies own their rows") {
+        Row r1; r1.values = { Value(0.0), Value(std::string(64, 'x')), Value("2024-01-01") };
+        const char* bytes = r1.values[1].strValue.data();
+        table.insertRow(std::move(r1));
+        CHECK(table.getRows()[0].values[1].strValue.data() == bytes);
+
+        Table copy = table;
+        Row r2; r2.values = { Value(0.0), Value("User2"), Value("2024-01-02") };
+        copy.insertRow(r2);
+        CHECK(table.getRows().size() == 1);
+        REQUIRE(copy.getRows().size() == 2);
+        CHECK(copy.getRows()[0].values[1].strValue == std::string(64, 'x'));
+
+        table = std::move(copy);
+        CHECK(table.getRows().size() == 2);
+        CHECK(table.getIndex("ID")->find(Value(2.0)) == std::vector<size_t>{1});
+    }
+
+    SECTION("Batches are validated before anything is appended") {
+        std::vector<Row> batch(3);
+        batch[0].values = { Value(0.0), Value("A"), Value("2024-01-01") };
+        batch[1].values = { Value(7.0), Value("B"), Value("2024-01-01") };
+        batch[2].values = { Value(7.0), Value("C"), Value("2024-01-01") };
+        CHECK_THROWS_WITH(table.appendRows(std::vector<Row>(batch)), Catch::Matchers::ContainsSubstring("unique column ID"));
+        CHECK(table.getRows().empty());
+        CHECK(table.getAutoIncrementCounters().at("ID") == 1);
+
+        batch[2].values[0] = Value(0.0);
+        table.appendRows(std::move(batch));
+        REQUIRE(table.getRows().size() == 3);
+        CHECK(table.getRows()[2].values[0].numValue == 8.0);
+        CHECK(table.getIndex("ID")->find(Value(8.0)) == std::vector<size_t>{2});
+        CHECK(table.getIndex("ID")->findRange(nullptr, true, nullptr, true) == std::vector<size_t>{0, 1, 2});
+    }
 }
 
 TEST_CASE("Parser Precedence and Expressions", "[parser]") {
     Table table("LogicTest", getTestColumns());
 
     SECTION("AND vs OR Precedence") {
-        auto tokens = Parser::tokenize("ID = 1 OR Name = \"Maria\" AND JoinDate = \"2024-01-01\"");
+        auto tokens = tokenize("ID = 1 OR Name = \"Maria\" AND JoinDate = \"2024-01-01\"");
         size_t pos = 0;
         auto expr = Parser::parseWhereExpression(tokens, pos, table);
 
@@ -95,6 +197,43 @@ TEST_CASE("Parser Precedence and Expressions", "[parser]") {
         r.values = { Value(99.0), Value("Maria"), Value("2025-01-01") };
         CHECK(expr->evaluate(r, table) == false);
     }
+
+    SECTION("Tokens are typed views into the command") {
+        const std::string text = "select ID,Name FROM T WHERE ID>=-2.5 AND Name != \"a b\" AND Day = '2024-01-01' OR X=?";
+        auto tokens = tokenize(text);
+        REQUIRE(tokens.size() == 22);
+        CHECK(tokens[0].is("SELECT"));
+        CHECK(tokens[2] == ",");
+        CHECK(tokens[2].kind == TokenKind::SYMBOL);
+        CHECK(tokens[8].kind == TokenKind::OPERATOR);
+        CHECK(tokens[8] == ">=");
+        CHECK(tokens[9].kind == TokenKind::NUMBER);
+        CHECK(parseNumber(tokens[9].text) == -2.5);
+        CHECK(tokens[12] == "!=");
+        CHECK(tokens[13].kind == TokenKind::STRING);
+        CHECK(unquote(tokens[13]) == "a b");
+        CHECK(unquote(tokens[17]) == "2024-01-01");
+        CHECK(tokens[21].kind == TokenKind::PLACEHOLDER);
+        CHECK(tokens[0].text.data() == text.data());
+        CHECK(tokenize("2024-01-01")[0].kind == TokenKind::WORD);
+        CHECK(tokenize("nan")[0].kind == TokenKind::WORD);
+        CHECK_THROWS_AS(parseNumber("12abc"), std::invalid_argument);
+    }
+
+    SECTION("Keywords match in any case and operators need no spaces") {
+        auto tokens = tokenize("ID=1 or Name=\"Maria\" aNd not ID<0");
+        size_t pos = 0;
+        auto expr = Parser::parseWhereExpression(tokens, pos, table);
+        CHECK(pos == tokens.size());
+
+        Row r;
+        r.values = { Value(2.0), Value("Maria"), Value("2024-01-01") };
+        CHECK(expr->evaluate(r, table));
+        r.values[1] = Value("Ivan");
+        CHECK_FALSE(expr->evaluate(r, table));
+        CHECK(normalizeStatement(tokenize("select * from T where ID=1")) ==
+              normalizeStatement(tokenize("SELECT * FROM T WHERE ID = 1")));
+    }
 }
 
 TEST_CASE("Database Integrity and Checksum", "[database]") {
@@ -124,4 +263,1467 @@ TEST_CASE("Database Integrity and Checksum", "[database]") {
 
         CHECK_THROWS_WITH(Database(testDb), Catch::Matchers::ContainsSubstring("corrupted or invalid"));
     }
+}
+
+TEST_CASE("Server Framing and Sessions", "[server]") {
+    SECTION("Frames survive partial delivery") {
+        std::string wire;
+        appendFrame(wire, "LISTTABLES");
+        appendFrame(wire, "");
+
+        std::string partial = wire.substr(0, 6);
+        std::size_t offset = 0;
+        std::string payload;
+        CHECK_FALSE(extractFrame(partial, offset, payload));
+        CHECK(offset == 0);
+
+        REQUIRE(extractFrame(wire, offset, payload));
+        CHECK(payload == "LISTTABLES");
+        REQUIRE(extractFrame(wire, offset, payload));
+        CHECK(payload.empty());
+        CHECK(offset == wire.size());
+    }
+
+    SECTION("Commands are served over a Unix socket") {
+        const std::string testDb = "test_server.db";
+        const std::string socketPath = "test_server.sock";
+        std::remove(testDb.c_str());
+
+        Database db(testDb);
+        ServerConfig config;
+        config.unixSocketPath = socketPath;
+        Server server(db, config);
+        std::thread loop([&server] { server.run(); });
+
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        std::strcpy(addr.sun_path, socketPath.c_str());
+        int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        REQUIRE(connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0);
+
+        std::string response;
+        sendFrame(fd, "CREATETABLE Remote (ID:Double, Name:String)");
+        REQUIRE(receiveFrame(fd, response));
+        CHECK(response == "Table Remote created\n");
+
+        sendFrame(fd, "QUIT");
+        REQUIRE(receiveFrame(fd, response));
+        CHECK(response == "Goodbye\n");
+        CHECK_FALSE(receiveFrame(fd, response));
+        close(fd);
+
+        // A client that shuts down its write side right after sending still gets every reply.
+        fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        REQUIRE(connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0);
+        sendFrame(fd, "INSERT INTO Remote {(1, \"a\")}");
+        sendFrame(fd, "INSERT INTO Remote {(2, \"b\")}");
+        shutdown(fd, SHUT_WR);
+        REQUIRE(receiveFrame(fd, response));
+        CHECK(response == "1 row inserted.\n");
+        REQUIRE(receiveFrame(fd, response));
+        CHECK(response == "1 row inserted.\n");
+        CHECK_FALSE(receiveFrame(fd, response));
+        close(fd);
+
+        fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        REQUIRE(connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0);
+        sendFrame(fd, "QUIT");
+        REQUIRE(receiveFrame(fd, response));
+        CHECK(response == "Goodbye\n");
+        CHECK_FALSE(receiveFrame(fd, response));
+        close(fd);
+
+        server.stop();
+        loop.join();
+    }
+
+    SECTION("A failed group flush answers with the error instead of the buffered replies") {
+        const std::string testDb = "test_server_flush.db";
+        const std::string socketPath = "test_server_flush.sock";
+        std::remove(testDb.c_str());
+        std::filesystem::remove_all(testDb + ".tables");
+        // A regular file where the table directory belongs makes every table write fail.
+        std::ofstream(testDb + ".tables") << "blocked";
+
+        Database db(testDb);
+        ServerConfig config;
+        config.unixSocketPath = socketPath;
+        Server server(db, config);
+        std::thread loop([&server] { server.run(); });
+
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        std::strcpy(addr.sun_path, socketPath.c_str());
+        int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        REQUIRE(connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0);
+
+        std::string response;
+        sendFrame(fd, "CREATETABLE Lost (ID:Double)");
+        REQUIRE(receiveFrame(fd, response));
+        CHECK(response.starts_with("Error: changes could not be written to disk"));
+
+        std::remove((testDb + ".tables").c_str());
+        sendFrame(fd, "INSERT INTO Lost {(1)}");
+        REQUIRE(receiveFrame(fd, response));
+        CHECK(response == "1 row inserted.\n");
+        close(fd);
+
+        server.stop();
+        loop.join();
+    }
+}
+
+TEST_CASE("Prepared Statements and Plan Cache", "[prepared]") {
+    const std::string testDb = "test_prepared.db";
+    std::remove(testDb.c_str());
+
+    Database db(testDb);
+    db.createTable("People", getTestColumns());
+    StatementCache cache(2);
+    Session session(db, cache);
+
+    SECTION("Placeholders are rebound on every execution") {
+        auto insert = session.prepare("INSERT INTO People {(?, ?, ?)}");
+        session.execute(*insert, { Value(0.0), Value("Ivan"), Value("2024-01-01") });
+        session.execute(*insert, { Value(0.0), Value("Maria"), Value("2024-02-01") });
+        REQUIRE(db.getTable("People").getRows().size() == 2);
+        CHECK(db.getTable("People").getRows()[1].values[1].strValue == "Maria");
+
+        auto remove = session.prepare("REMOVE People WHERE Name = ?");
+        session.execute(*remove, { Value("Ivan") });
+        REQUIRE(db.getTable("People").getRows().size() == 1);
+
+        CHECK_THROWS(session.execute(*remove, {}));
+        CHECK_THROWS(session.execute(*remove, { Value(1.0) }));
+    }
+
+    SECTION("Equivalent statement text shares one cached plan") {
+        auto first = session.prepare("SELECT * FROM People WHERE ID = ?");
+        auto second = session.prepare("select   *  from People where ID = ?");
+        CHECK(first == second);
+        CHECK(cache.getHits() == 1);
+
+        db.createTable("Other", getTestColumns());
+        auto third = session.prepare("SELECT * FROM People WHERE ID = ?");
+        CHECK(third != first);
+        CHECK_THROWS_WITH(session.execute(*first, { Value(1.0) }), Catch::Matchers::ContainsSubstring("out of date"));
+    }
+
+    SECTION("Literals outside prepared statements reject placeholders") {
+        std::ostringstream out;
+        processCommand(session, "SELECT * FROM People WHERE ID = ?", out);
+        CHECK_THAT(out.str(), Catch::Matchers::ContainsSubstring("only allowed in prepared statements"));
+    }
+}
+
+TEST_CASE("Transactions and Group Commit", "[transaction]") {
+    const std::string testDb = "test_transactions.db";
+    std::remove(testDb.c_str());
+
+    auto committedRows = [&testDb](const std::string& tableName) {
+        Database reopened(testDb);
+        return reopened.hasTable(tableName) ? reopened.getTable(tableName).getRows().size() : 0;
+    };
+
+    Database db(testDb);
+    db.createTable("Events", getTestColumns());
+    StatementCache cache;
+    Session writer(db, cache);
+    Session reader(db, cache);
+    std::ostringstream out;
+
+    SECTION("Rollback restores the table") {
+        writer.begin();
+        processCommand(writer, "INSERT INTO Events {(0, \"a\", \"2024-01-01\"), (0, \"b\", \"2024-01-02\")}", out);
+        CHECK(db.getTable("Events").getRows().size() == 2);
+        CHECK(committedRows("Events") == 0);
+
+        writer.rollback();
+        CHECK(db.getTable("Events").getRows().empty());
+    }
+
+    SECTION("Commit makes all statements durable at once") {
+        processCommand(writer, "BEGIN", out);
+        processCommand(writer, "INSERT INTO Events {(0, \"a\", \"2024-01-01\")}", out);
+        processCommand(writer, "INSERT INTO Events {(0, \"b\", \"2024-01-02\")}", out);
+        CHECK(committedRows("Events") == 0);
+
+        processCommand(writer, "COMMIT", out);
+        CHECK(committedRows("Events") == 2);
+    }
+
+    SECTION("Other sessions read committed data and cannot write locked tables") {
+        writer.begin();
+        processCommand(writer, "INSERT INTO Events {(0, \"a\", \"2024-01-01\")}", out);
+
+        std::ostringstream readerOut;
+        processCommand(reader, "INSERT INTO Events {(0, \"b\", \"2024-01-02\")}", readerOut);
+        CHECK_THAT(readerOut.str(), Catch::Matchers::ContainsSubstring("locked"));
+        processCommand(reader, "SELECT * FROM Events", readerOut);
+        CHECK_THAT(readerOut.str(), Catch::Matchers::ContainsSubstring("Total 0 rows selected"));
+
+        writer.commit();
+        CHECK(db.getTable("Events").getRows().size() == 1);
+    }
+
+    SECTION("Group commit defers the flush until the batch ends") {
+        db.setGroupCommit(true);
+        writer.begin();
+        reader.begin();
+        processCommand(writer, "INSERT INTO Events {(0, \"a\", \"2024-01-01\")}", out);
+        processCommand(reader, "CREATETABLE Audit (Note:String)", out);
+        writer.commit();
+        reader.commit();
+        CHECK(committedRows("Events") == 0);
+
+        db.flush();
+        CHECK(committedRows("Events") == 1);
+        CHECK(Database(testDb).hasTable("Audit"));
+        db.setGroupCommit(false);
+    }
+
+    SECTION("The undo log takes back inserts, removals and updates") {
+        processCommand(writer, "INSERT INTO Events {(0, \"a\", \"2024-01-01\"), (0, \"b\", \"2024-01-02\"), (0, \"c\", \"2024-01-03\")}", out);
+        const Table& events = db.getTable("Events");
+        const uint64_t before = events.getVersion();
+
+        writer.begin();
+        processCommand(writer, "INSERT INTO Events {(0, \"d\", \"2024-01-04\")}", out);
+        processCommand(writer, "REMOVE Events WHERE ID = 2", out);
+        processCommand(writer, "UPDATE Events SET Name = \"z\" WHERE ID = 1", out);
+        processCommand(writer, "INSERT INTO Events {(0, \"e\", \"2024-01-05\")}", out);
+        CHECK(events.getRows().size() == 4);
+        CHECK(db.getTable("Events").getMemoryUsage().undoBytes > 0);
+
+        // Other sessions read the committed rows, rebuilt from the log.
+        const ResultSet committed = reader.query("SELECT Name FROM Events WHERE ID <= 3 ORDER BY ID");
+        REQUIRE(committed.size() == 3);
+        CHECK(committed.at(0, 0).strValue == "a");
+        CHECK(committed.at(1, 0).strValue == "b");
+        CHECK(reader.query("SELECT * FROM Events").size() == 3);
+
+        writer.rollback();
+        REQUIRE(events.getRows().size() == 3);
+        CHECK(events.getRows()[0].values[1].strValue == "a");
+        CHECK(events.getRows()[1].values[1].strValue == "b");
+        CHECK(events.getIndex("ID")->find(Value(2.0)) == std::vector<std::size_t>{1});
+        CHECK(events.getIndex("ID")->find(Value(4.0)).empty());
+        CHECK(events.getAutoIncrementCounters().at("ID") == 4);
+        CHECK(events.getVersion() == before);
+        CHECK(events.getMemoryUsage().undoBytes == 0);
+        CHECK(writer.query("SELECT * FROM Events WHERE Name = \"z\"").size() == 0);
+    }
+
+    SECTION("A dropped table and a split partition come back on rollback") {
+        processCommand(writer, "INSERT INTO Events {(0, \"a\", \"2024-01-01\"), (0, \"b\", \"2024-03-01\")}", out);
+        processCommand(writer, "CREATETABLE Days (ID:Double, Day:Date) PARTITION BY RANGE(Day) (\"2024-02-01\")", out);
+        processCommand(writer, "INSERT INTO Days {(1, \"2024-01-10\"), (2, \"2024-02-10\"), (3, \"2024-03-10\")}", out);
+
+        writer.begin();
+        processCommand(writer, "DROPTABLE Events", out);
+        processCommand(writer, "ADDPARTITION Days \"2024-03-01\"", out);
+        processCommand(writer, "REMOVE Days WHERE ID = 3", out);
+        CHECK_FALSE(db.hasTable("Events"));
+        CHECK(reader.query("SELECT * FROM Days").size() == 3);
+        CHECK(db.getTable("Days").getPartitions().size() == 3);
+
+        writer.rollback();
+        CHECK(db.getTable("Events").getRows().size() == 2);
+        const Table& days = db.getTable("Days");
+        REQUIRE(days.getPartitions().size() == 2);
+        CHECK(days.getPartitions()[1].getRowCount() == 2);
+        CHECK(writer.query("SELECT ID FROM Days WHERE Day > \"2024-03-01\"").at(0, 0).numValue == 3);
+    }
+}
+
+
+TEST_CASE("CSV Import and Export", "[csv]") {
+    const std::string testDb = "test_csv.db";
+    const std::string csvPath = "test_csv.csv";
+    std::remove(testDb.c_str());
+
+    Database db(testDb);
+    db.createTable("Source", getTestColumns());
+    db.createTable("Target", getTestColumns());
+
+    SECTION("Round trip keeps quoting and types") {
+        std::vector<Row> rows(2);
+        rows[0].values = { Value(0.0), Value("Doe, \"Jr\""), Value("2024-01-01", DataType::DATE) };
+        rows[1].values = { Value(0.0), Value(""), Value("2024-02-01", DataType::DATE) };
+        db.insert("Source", rows);
+
+        db.exportCsv("Source", csvPath);
+        db.importCsv("Target", csvPath);
+
+        const auto& imported = db.getTable("Target").getRows();
+        REQUIRE(imported.size() == 2);
+        CHECK(imported[0].values[1].strValue == "Doe, \"Jr\"");
+        CHECK(imported[1].values[1].strValue.empty());
+        CHECK(imported[1].values[0].numValue == 2.0);
+        CHECK(imported[1].values[2].type == DataType::DATE);
+    }
+
+    SECTION("Large files are split into chunks on record boundaries") {
+        {
+            std::ofstream csv(csvPath);
+            csv << "Name,JoinDate\n";
+            for (int i = 0; i < 200000; i++) {
+                csv << "\"user\n" << i << "\",2024-01-01\n";
+            }
+        }
+        db.importCsv("Target", csvPath);
+
+        const Table& table = db.getTable("Target");
+        REQUIRE(table.getRows().size() == 200000);
+        CHECK(table.getRows()[199999].values[0].numValue == 200000.0);
+        CHECK(table.getRows()[199999].values[1].strValue == "user\n199999");
+    }
+
+    SECTION("Malformed numbers report their line") {
+        {
+            std::ofstream csv(csvPath);
+            csv << "ID,Name\n1,a\nx,b\n";
+        }
+        CHECK_THROWS_WITH(db.importCsv("Target", csvPath), Catch::Matchers::ContainsSubstring("Line 3"));
+    }
+
+    std::remove(csvPath.c_str());
+}
+
+
+TEST_CASE("Result Sets and Output Sinks", "[results]") {
+    const std::string testDb = "test_results.db";
+    std::remove(testDb.c_str());
+
+    Database db(testDb);
+    db.createTable("People", getTestColumns());
+    std::vector<Row> rows(2);
+    rows[0].values = { Value(0.0), Value("Ivan"), Value("2024-01-01", DataType::DATE) };
+    rows[1].values = { Value(0.0), Value("Maria \"M\""), Value("2024-02-01", DataType::DATE) };
+    db.insert("People", rows);
+
+    StatementCache cache;
+    Session session(db, cache);
+    ResultSet result = session.query("SELECT Name, ID FROM People WHERE ID > ? ORDER BY ID", { Value(0.0) });
+
+    SECTION("Select returns typed rows") {
+        REQUIRE(result.columns.size() == 2);
+        CHECK(result.columns[0].name == "Name");
+        CHECK(result.columns[1].type == DataType::DOUBLE);
+        REQUIRE(result.size() == 2);
+        CHECK(result.at(1, 1).numValue == 2.0);
+    }
+
+    SECTION("Table sink keeps the interactive layout") {
+        std::ostringstream out;
+        TableSink(out).write(result);
+        CHECK(out.str() == "|Name|ID|\n--------\n|\"Ivan\"| 1|\n|\"Maria \"M\"\"| 2|\nTotal 2 rows selected\n");
+    }
+
+    SECTION("CSV and JSON lines sinks") {
+        std::ostringstream csv;
+        CsvSink(csv).write(result);
+        CHECK(csv.str() == "Name,ID\nIvan,1\n\"Maria \"\"M\"\"\",2\n");
+
+        std::ostringstream json;
+        JsonLinesSink(json).write(result);
+        CHECK(json.str() == "{\"Name\":\"Ivan\",\"ID\":1}\n{\"Name\":\"Maria \\\"M\\\"\",\"ID\":2}\n");
+    }
+
+    SECTION("Binary sink frames rows and the row count") {
+        std::ostringstream out;
+        BinarySink(out).write(result);
+        const std::string bytes = out.str();
+        CHECK(bytes.substr(0, 4) == "FMIR");
+        uint64_t rowCount;
+        std::memcpy(&rowCount, bytes.data() + bytes.size() - sizeof(rowCount), sizeof(rowCount));
+        CHECK(rowCount == 2);
+    }
+}
+
+
+TEST_CASE("Query Plans and EXPLAIN", "[planner]") {
+    const std::string testDb = "test_planner.db";
+    std::remove(testDb.c_str());
+
+    Database db(testDb);
+    db.createTable("People", getTestColumns());
+    std::vector<Row> rows(10);
+    for (std::size_t i = 0; i < rows.size(); i++) {
+        rows[i].values = { Value(0.0), Value("User" + std::to_string(i % 3)), Value("2024-01-01", DataType::DATE) };
+    }
+    db.insert("People", rows);
+
+    StatementCache cache;
+    Session session(db, cache);
+    auto parseWhere = [&](const std::string& text) {
+        auto tokens = tokenize(text);
+        size_t pos = 0;
+        return Parser::parseWhereExpression(tokens, pos, db.getTable("People"));
+    };
+
+    SECTION("Indexed predicates choose an index access path") {
+        auto equality = parseWhere("Name = \"User1\" AND ID = 4");
+        AccessPath lookup = chooseAccessPath(db.getTable("People"), equality.get());
+        CHECK(lookup.kind == AccessKind::INDEX_LOOKUP);
+        REQUIRE(lookup.predicate);
+        CHECK(lookup.column == "ID");
+
+        auto range = parseWhere("ID > 7");
+        CHECK(chooseAccessPath(db.getTable("People"), range.get()).kind == AccessKind::INDEX_RANGE);
+
+        auto unindexed = parseWhere("Name = \"User1\" OR ID = 4");
+        CHECK(chooseAccessPath(db.getTable("People"), unindexed.get()).kind == AccessKind::FULL_SCAN);
+    }
+
+    SECTION("EXPLAIN ANALYZE reports per-operator counters") {
+        auto where = parseWhere("ID >= 3 AND Name = \"User0\"");
+        QueryPlan plan = db.explainSelect("People", {"Name"}, where, "ID", true, true);
+        REQUIRE(plan.analyzed);
+        OperatorStats* scan = plan.find("Index Range Scan");
+        REQUIRE(scan);
+        CHECK(scan->indexProbes == 1);
+        CHECK(scan->rowsOut == 8);
+        CHECK(plan.find("Filter")->rowsOut == 3);
+        CHECK(plan.find("Distinct")->rowsOut == 1);
+
+        std::ostringstream out;
+        processCommand(session, "EXPLAIN SELECT Name FROM People WHERE ID = 2", out);
+        CHECK(out.str().find("-> Index Lookup (using ID index: ID = 2)") != std::string::npos);
+        CHECK(out.str().find("time=") == std::string::npos);
+    }
+
+    SECTION("Batch remove keeps rows and indexes consistent") {
+        std::ostringstream out;
+        processCommand(session, "EXPLAIN ANALYZE REMOVE People WHERE Name = \"User1\"", out);
+        CHECK(out.str().find("-> Seq Scan") != std::string::npos);
+        CHECK(out.str().find("rows out=3") != std::string::npos);
+
+        ResultSet left = session.query("SELECT ID FROM People ORDER BY ID");
+        REQUIRE(left.size() == 7);
+        CHECK(left.at(1, 0).numValue == 3.0);
+        CHECK(session.query("SELECT Name FROM People WHERE ID = 10").at(0, 0).strValue == "User0");
+        CHECK(session.query("SELECT Name FROM People WHERE ID = 5").empty());
+    }
+
+    std::remove(testDb.c_str());
+}
+
+TEST_CASE("Column Statistics and Cost-Based Planning", "[statistics]") {
+    const std::string testDb = "test_statistics.db";
+    std::remove(testDb.c_str());
+
+    {
+        Database db(testDb);
+        db.createTable("People", getTestColumns());
+        std::vector<Row> rows(200);
+        for (std::size_t i = 0; i < rows.size(); i++) {
+            rows[i].values = { Value(0.0), Value("User" + std::to_string(i % 4)), Value("2024-01-01", DataType::DATE) };
+        }
+        db.insert("People", rows);
+
+        StatementCache cache;
+        Session session(db, cache);
+        std::ostringstream out;
+        processCommand(session, "ANALYZE People", out);
+        CHECK(out.str() == "Table People analyzed (200 rows).\n");
+
+        const Table& table = db.getTable("People");
+        REQUIRE(table.getStatistics());
+        const TableStats& stats = *table.getStatistics();
+        CHECK(stats.rowCount == 200);
+        CHECK(stats.columns.at("Name").distinctCount == 4);
+        CHECK(stats.columns.at("ID").distinctCount == Approx(200).epsilon(0.05));
+        CHECK(stats.columns.at("ID").min.numValue == 1.0);
+        CHECK(stats.columns.at("ID").max.numValue == 200.0);
+        CHECK(stats.columns.at("ID").fractionBelow(Value(51.0)) == Approx(0.25).margin(0.02));
+
+        auto parseWhere = [&](const std::string& text) {
+            auto tokens = tokenize(text);
+            size_t pos = 0;
+            return Parser::parseWhereExpression(tokens, pos, table);
+        };
+
+        SECTION("Index only when it beats a scan") {
+            auto wide = parseWhere("ID > 20");
+            CHECK(chooseAccessPath(table, wide.get()).kind == AccessKind::FULL_SCAN);
+            auto narrow = parseWhere("ID > 190");
+            AccessPath path = chooseAccessPath(table, narrow.get());
+            CHECK(path.kind == AccessKind::INDEX_RANGE);
+            CHECK(path.estimatedRows == Approx(10).margin(3));
+        }
+
+        SECTION("AND and OR operands are ordered by selectivity") {
+            auto conjunction = parseWhere("Name = \"User1\" AND JoinDate = \"2024-01-01\" AND ID = 7");
+            orderPredicates(conjunction.get(), table);
+            CHECK(conjunction->toString() == "((ID = 7 AND Name = \"User1\") AND JoinDate = \"2024-01-01\")");
+
+            auto disjunction = parseWhere("ID = 7 OR Name = \"User1\"");
+            orderPredicates(disjunction.get(), table);
+            CHECK(disjunction->toString() == "(Name = \"User1\" OR ID = 7)");
+            CHECK(session.query("SELECT ID FROM People WHERE ID = 7 OR Name = \"User1\"").size() == 51);
+        }
+    }
+
+    SECTION("Statistics survive a reload") {
+        Database db(testDb);
+        REQUIRE(db.getTable("People").getStatistics());
+        CHECK(db.getTable("People").getStatistics()->columns.at("Name").distinctCount == 4);
+    }
+
+    std::remove(testDb.c_str());
+}
+
+TEST_CASE("Zone Maps Skip Blocks", "[zonemap]") {
+    const std::string testDb = "test_zonemap.db";
+    std::remove(testDb.c_str());
+
+    Database db(testDb);
+    db.createTable("Events", { Column("Seq", DataType::DOUBLE), Column("Kind", DataType::STRING) });
+    std::vector<Row> rows(3000);
+    for (std::size_t i = 0; i < rows.size(); i++) {
+        rows[i].values = { Value(static_cast<double>(i + 1)), Value(i % 2 ? "click" : "view") };
+    }
+    db.insert("Events", rows);
+    REQUIRE(db.getTable("Events").getBlockCount() == 3);
+
+    SECTION("Range predicates skip blocks outside the bounds") {
+        auto tokens = tokenize("Seq >= 2500 AND Kind = \"click\"");
+        size_t pos = 0;
+        auto where = Parser::parseWhereExpression(tokens, pos, db.getTable("Events"));
+        QueryPlan plan = db.explainSelect("Events", {"*"}, where, "", false, true);
+        OperatorStats* scan = plan.find("Seq Scan");
+        REQUIRE(scan);
+        CHECK(scan->blocksSkipped == 2);
+        CHECK(scan->rowsIn == 3000 - 2 * Table::blockSize);
+        CHECK(scan->rowsOut == 251);
+    }
+
+    SECTION("Zone maps follow deletes") {
+        auto tokens = tokenize("Seq < 1500");
+        size_t pos = 0;
+        db.remove("Events", Parser::parseWhereExpression(tokens, pos, db.getTable("Events")));
+        const Table& table = db.getTable("Events");
+        REQUIRE(table.getBlockCount() == 2);
+        CHECK(table.getBlock(0).min[0].numValue == 1500.0);
+        CHECK(table.getBlock(1).max[0].numValue == 3000.0);
+    }
+}
+
+TEST_CASE("Bloom Filters Skip Blocks", "[bloom]") {
+    const std::string testDb = "test_bloom.db";
+    std::remove(testDb.c_str());
+
+    {
+        Database db(testDb);
+        StatementCache cache;
+        Session session(db, cache);
+        std::ostringstream out;
+        processCommand(session, "CREATETABLE Visits (Email:String, Score:Double) INDEX ON Score BLOOM ON Email BLOOM ON Score", out);
+
+        std::vector<Row> rows(5000);
+        for (std::size_t i = 0; i < rows.size(); i++) {
+            rows[i].values = { Value("user" + std::to_string(i * 7919 % 5000) + "@fmi.bg"), Value(static_cast<double>(i % 97)) };
+        }
+        db.insert("Visits", rows);
+    }
+
+    Database db(testDb);
+    const Table& table = db.getTable("Visits");
+    REQUIRE(table.getColumns()[0].bloomFilter);
+    REQUIRE(table.getBlockCount() == 5);
+
+    SECTION("Filters never miss a present value") {
+        for (std::size_t b = 0; b < table.getBlockCount(); b++) {
+            CHECK(table.getBlock(b).blooms[0].mayContain(table.getRows()[b * Table::blockSize].values[0]));
+            CHECK(table.getBlock(b).blooms[1].mayContain(Value(table.getRows()[b * Table::blockSize].values[1].numValue + 1e-6)));
+        }
+        CHECK(table.getBlock(0).blooms[0].mayContain(Value("nobody@fmi.bg")) == false);
+    }
+
+    SECTION("Equality scans skip blocks without the value") {
+        auto tokens = tokenize("Email = \"user4321@fmi.bg\"");
+        size_t pos = 0;
+        auto where = Parser::parseWhereExpression(tokens, pos, table);
+        QueryPlan plan = db.explainSelect("Visits", {"*"}, where, "", false, true);
+        OperatorStats* scan = plan.find("Seq Scan");
+        REQUIRE(scan);
+        CHECK(scan->rowsOut == 1);
+        CHECK(scan->blocksSkipped >= 3);
+    }
+}
+
+TEST_CASE("Compressed File Format", "[storage]") {
+    const std::string testDb = "test_storage.db";
+    std::remove(testDb.c_str());
+
+    SECTION("Block compressor round trip") {
+        std::string repetitive;
+        for (int i = 0; i < 2000; i++) repetitive += "row " + std::to_string(i % 50) + ";";
+        const std::string compressed = compressBlock(repetitive);
+        CHECK(compressed.size() < repetitive.size() / 4);
+        CHECK(decompressBlock(compressed, repetitive.size()) == repetitive);
+        CHECK(decompressBlock(compressBlock(""), 0).empty());
+        CHECK_THROWS(decompressBlock(compressed.substr(0, compressed.size() / 2), repetitive.size()));
+    }
+
+    SECTION("Tables round trip through the versioned format") {
+        {
+            Database db(testDb);
+            std::vector<Column> columns = getTestColumns();
+            columns.emplace_back("Score", DataType::DOUBLE);
+            columns.back().hasDefault = true;
+            columns.back().defaultValue = Value(-1.5);
+            db.createTable("People", columns);
+            std::vector<Row> rows(3000);
+            for (std::size_t i = 0; i < rows.size(); i++) {
+                rows[i].values = { Value(0.0), Value(i % 7 ? "Ivan" : "Maria"), Value("2024-01-0" + std::to_string(i % 9 + 1), DataType::DATE),
+                                   Value(i % 3 ? static_cast<double>(i) / 8 : -static_cast<double>(i)) };
+            }
+            db.insert("People", rows);
+        }
+
+        std::ifstream file(testDb + ".tables/1.tbl", std::ios::binary | std::ios::ate);
+        CHECK(file.tellg() < 3000 * 20);
+        file.seekg(0);
+        char magic[8];
+        file.read(magic, sizeof(magic));
+        CHECK(std::string(magic, sizeof(magic)) == "FMISQLTB");
+        file.close();
+
+        Database db(testDb);
+        const Table& table = db.getTable("People");
+        REQUIRE(table.getRows().size() == 3000);
+        CHECK(table.getColumns()[3].defaultValue.numValue == -1.5);
+        CHECK(table.getAutoIncrementCounters().at("ID") == 3001);
+        const Row& row = table.getRows()[2999];
+        CHECK(row.values[0].numValue == 3000.0);
+        CHECK(row.values[1].strValue == "Ivan");
+        CHECK(row.values[2].type == DataType::DATE);
+        CHECK(row.values[2].strValue == "2024-01-03");
+        CHECK(row.values[3].numValue == 2999.0 / 8);
+        CHECK(table.getRows()[3].values[3].numValue == -3.0);
+    }
+
+    SECTION("Unversioned files are still readable") {
+        std::ostringstream legacy(std::ios::binary);
+        auto put32 = [&](uint32_t value) { legacy.write(reinterpret_cast<char*>(&value), sizeof(value)); };
+        auto putString = [&](const std::string& value) { put32(value.size()); legacy.write(value.data(), value.size()); };
+        put32(1);
+        putString("Old");
+        put32(2);
+        putString("ID");
+        legacy.put(static_cast<char>(DataType::DOUBLE));
+        legacy.put(1);
+        putString("Name");
+        legacy.put(static_cast<char>(DataType::STRING));
+        legacy.put(0);
+        put32(2);
+        for (double id : {1.0, 2.0}) {
+            legacy.write(reinterpret_cast<char*>(&id), sizeof(id));
+            putString(id == 1.0 ? "Ivan" : "Maria");
+        }
+        const std::string payload = legacy.str();
+        const uint64_t checksum = calculateChecksum(payload.data(), payload.size());
+        {
+            std::ofstream out(testDb, std::ios::binary);
+            out.write(reinterpret_cast<const char*>(&checksum), sizeof(checksum));
+            out.write(payload.data(), payload.size());
+        }
+
+        {
+            Database db(testDb);
+            const Table& table = db.getTable("Old");
+            REQUIRE(table.getRows().size() == 2);
+            CHECK(table.getRows()[1].values[1].strValue == "Maria");
+            REQUIRE(table.getIndex("ID"));
+            CHECK(table.getIndex("ID")->find(Value(2.0)) == std::vector<size_t>{1});
+        }
+
+        // Closing the database upgrades it to a catalog plus one file per table.
+        std::ifstream catalog(testDb, std::ios::binary);
+        char magic[8];
+        catalog.read(magic, sizeof(magic));
+        CHECK(std::string(magic, sizeof(magic)) == "FMISQLDB");
+        CHECK(std::filesystem::exists(testDb + ".tables/1.tbl"));
+        catalog.close();
+        CHECK(Database(testDb).getTable("Old").getRows().size() == 2);
+    }
+    std::filesystem::remove_all(testDb + ".tables");
+}
+
+TEST_CASE("Per-Table Files and Lazy Loading", "[storage]") {
+    const std::string testDb = "test_tablefiles.db";
+    const std::string tableDir = testDb + ".tables";
+    std::remove(testDb.c_str());
+    std::filesystem::remove_all(tableDir);
+
+    auto addRows = [](Database& db, const std::string& tableName, std::size_t count) {
+        std::vector<Row> rows(count);
+        for (auto& row : rows) row.values = { Value(0.0), Value("Ivan"), Value("2024-01-01", DataType::DATE) };
+        db.insert(tableName, rows);
+    };
+    {
+        Database db(testDb);
+        db.createTable("Hot", getTestColumns());
+        db.createTable("Cold", getTestColumns());
+        addRows(db, "Hot", 10);
+        addRows(db, "Cold", 10);
+    }
+    const std::string hotFile = tableDir + "/1.tbl";
+    const std::string coldFile = tableDir + "/2.tbl";
+    REQUIRE(std::filesystem::exists(hotFile));
+    REQUIRE(std::filesystem::exists(coldFile));
+
+    SECTION("Only changed tables are rewritten") {
+        const auto coldWritten = std::filesystem::last_write_time(coldFile);
+        {
+            Database db(testDb);
+            addRows(db, "Hot", 5);
+        }
+        CHECK(std::filesystem::last_write_time(coldFile) == coldWritten);
+        CHECK_FALSE(std::filesystem::exists(hotFile + ".tmp"));
+
+        Database db(testDb);
+        CHECK(db.getTable("Hot").getRows().size() == 15);
+        CHECK(db.getTable("Cold").getRows().size() == 10);
+    }
+
+    SECTION("Tables are read on first use") {
+        {
+            std::fstream file(coldFile, std::ios::binary | std::ios::in | std::ios::out);
+            file.seekp(15, std::ios::beg);
+            file.put(0xFF);
+        }
+        Database db(testDb);
+        CHECK(db.hasTable("Cold"));
+        CHECK(db.getTable("Hot").getRows().size() == 10);
+        addRows(db, "Hot", 1);
+        CHECK_THROWS_WITH(db.getTable("Cold"), Catch::Matchers::ContainsSubstring("corrupted or invalid"));
+    }
+
+    SECTION("Preloading reads every table file in parallel") {
+        {
+            Database db(testDb);
+            db.createTable("Third", getTestColumns());
+            addRows(db, "Third", 7);
+        }
+        Database db(testDb);
+        CHECK(db.getMemoryUsage().total() == 0);
+        const LoadReport report = db.preloadTables(2);
+        CHECK(report.tables == 3);
+        CHECK(report.rows == 27);
+        CHECK(report.threads == 2);
+        CHECK(report.wallSeconds >= 0);
+        CHECK(db.getMemoryUsage().total() > 0);
+        CHECK(db.getTable("Third").getIndex("ID")->find(Value(7.0)).size() == 1);
+        CHECK(db.preloadTables().tables == 0);
+
+        {
+            std::fstream file(coldFile, std::ios::binary | std::ios::in | std::ios::out);
+            file.seekp(15, std::ios::beg);
+            file.put(0xFF);
+        }
+        Database damaged(testDb);
+        CHECK_THROWS_WITH(damaged.preloadTables(), Catch::Matchers::ContainsSubstring("corrupted or invalid"));
+        CHECK(damaged.getTable("Hot").getRows().size() == 10);
+        CHECK_THROWS(damaged.getTable("Cold"));
+    }
+
+    SECTION("Dropping a table deletes its file") {
+        {
+            Database db(testDb);
+            db.dropTable("Cold");
+        }
+        CHECK_FALSE(std::filesystem::exists(coldFile));
+        Database db(testDb);
+        CHECK_FALSE(db.hasTable("Cold"));
+        CHECK(db.getTable("Hot").getRows().size() == 10);
+    }
+
+    std::remove(testDb.c_str());
+    std::filesystem::remove_all(tableDir);
+}
+
+TEST_CASE("UPDATE in Place", "[update]") {
+    const std::string testDb = "test_update.db";
+    std::remove(testDb.c_str());
+
+    Database db(testDb);
+    std::vector<Column> columns = getTestColumns();
+    columns[1].indexed = true;
+    db.createTable("People", columns);
+    std::vector<Row> rows(2000);
+    for (std::size_t i = 0; i < rows.size(); i++) {
+        rows[i].values = { Value(0.0), Value("User" + std::to_string(i % 4)), Value("2024-01-01", DataType::DATE) };
+    }
+    db.insert("People", rows);
+
+    StatementCache cache;
+    Session session(db, cache);
+
+    SECTION("Rows change in place and keep their ids") {
+        std::ostringstream out;
+        processCommand(session, "UPDATE People SET Name = \"Active\", JoinDate = \"2025-06-01\" WHERE ID > 1990", out);
+        CHECK(out.str() == "10 rows updated.\n");
+
+        const Table& table = db.getTable("People");
+        REQUIRE(table.getRows().size() == 2000);
+        CHECK(table.getRows()[1995].values[0].numValue == 1996.0);
+        CHECK(table.getRows()[1995].values[1].strValue == "Active");
+        CHECK(table.getRows()[1995].values[2].type == DataType::DATE);
+        CHECK(table.getAutoIncrementCounters().at("ID") == 2001);
+
+        CHECK(session.query("SELECT ID FROM People WHERE Name = \"Active\"").size() == 10);
+        CHECK(session.query("SELECT ID FROM People WHERE Name = \"User3\"").size() == 497);
+        CHECK(session.query("SELECT ID FROM People WHERE JoinDate > \"2025-01-01\"").size() == 10);
+    }
+
+    SECTION("Unique indexes are checked before any row changes") {
+        CHECK_THROWS_WITH(db.update("People", {{0, Value(7.0)}}, parseTestWhere(db, "People", "ID = 8")),
+                          Catch::Matchers::ContainsSubstring("unique column ID"));
+        CHECK_THROWS(db.update("People", {{1, Value("Changed")}, {0, Value(5000.0)}}, parseTestWhere(db, "People", "ID < 3")));
+        CHECK(session.query("SELECT ID FROM People WHERE Name = \"Changed\"").empty());
+
+        db.update("People", {{0, Value(5000.0)}}, parseTestWhere(db, "People", "ID = 8"));
+        CHECK(session.query("SELECT Name FROM People WHERE ID = 8").empty());
+        CHECK(session.query("SELECT Name FROM People WHERE ID = 5000").at(0, 0).strValue == "User3");
+        CHECK(db.getTable("People").getRows()[7].values[0].numValue == 5000.0);
+        CHECK(db.getTable("People").getAutoIncrementCounters().at("ID") == 5001);
+    }
+
+    SECTION("Prepared UPDATE binds SET and WHERE placeholders") {
+        auto rename = session.prepare("UPDATE People SET Name = ? WHERE ID = ?");
+        session.execute(*rename, { Value("Renamed"), Value(42.0) });
+        session.execute(*rename, { Value("Renamed"), Value(43.0) });
+        CHECK(session.query("SELECT ID FROM People WHERE Name = \"Renamed\"").size() == 2);
+
+        std::ostringstream out;
+        processCommand(session, "EXPLAIN UPDATE People SET Name = \"X\" WHERE ID = 1", out);
+        CHECK(out.str().find("Update (Name)") != std::string::npos);
+        CHECK(out.str().find("-> Index Lookup") != std::string::npos);
+    }
+
+    std::remove(testDb.c_str());
+    std::filesystem::remove_all(testDb + ".tables");
+}
+
+TEST_CASE("Memory Accounting and Limits", "[memory]") {
+    const std::string testDb = "test_memory.db";
+    std::remove(testDb.c_str());
+    std::filesystem::remove_all(testDb + ".tables");
+
+    auto makeRows = [](std::size_t count) {
+        std::vector<Row> rows(count);
+        for (auto& row : rows) row.values = { Value(0.0), Value(std::string(100, 'n')), Value("2024-01-01", DataType::DATE) };
+        return rows;
+    };
+
+    SECTION("Rows, strings and indexes are counted") {
+        TrackingResource tracker;
+        {
+            std::pmr::vector<Value> values(&tracker);
+            values.resize(10);
+            CHECK(tracker.getBytes() == 10 * sizeof(Value));
+        }
+        CHECK(tracker.getBytes() == 0);
+
+        std::vector<Column> columns = getTestColumns();
+        columns[1].indexed = true;
+        Table table("People", columns);
+        table.appendRows(makeRows(1000));
+        const MemoryUsage usage = table.getMemoryUsage();
+        CHECK(usage.rowBytes >= 1000 * (sizeof(Row) + 3 * sizeof(Value)));
+        CHECK(usage.stringBytes >= 1000 * 101);
+        CHECK(usage.indexBytes >= 1000 * (sizeof(double) + sizeof(std::string) + 101));
+        CHECK(usage.summaryBytes > 0);
+        CHECK(table.getIndex("Name")->memoryUsage() > table.getIndex("ID")->memoryUsage());
+
+        std::vector<std::size_t> firstHalf(500);
+        std::iota(firstHalf.begin(), firstHalf.end(), 0);
+        table.removeRows(firstHalf);
+        CHECK(table.getMemoryUsage().stringBytes == usage.stringBytes / 2);
+        table.updateRows({0}, {{1, Value(std::string(300, 'l'))}});
+        const std::size_t grown = stringHeapBytes(table.getRows()[0].values[1].strValue);
+        CHECK(grown > 300);
+        CHECK(table.getMemoryUsage().stringBytes == usage.stringBytes / 2 - 101 + grown);
+        CHECK(Table(table).getMemoryUsage().stringBytes == table.getMemoryUsage().stringBytes);
+    }
+
+    SECTION("Inserts over a table or global limit are rejected") {
+        Database db(testDb);
+        StatementCache cache;
+        Session session(db, cache);
+        db.createTable("People", getTestColumns());
+        std::vector<Row> rows = makeRows(100);
+        db.insert("People", rows);
+
+        std::ostringstream out;
+        processCommand(session, "SETLIMIT People 64kb", out);
+        CHECK(out.str() == "Memory limit of People set to 64.0 KB\n");
+        rows = makeRows(1000);
+        CHECK_THROWS_WITH(db.insert("People", rows), Catch::Matchers::ContainsSubstring("Memory limit of People"));
+        CHECK(db.getTable("People").getRows().size() == 100);
+        rows = makeRows(10);
+        db.insert("People", rows);
+
+        processCommand(session, "SETLIMIT People 0", out);
+        processCommand(session, "SETLIMIT 1KB", out);
+        rows = makeRows(1);
+        CHECK_THROWS_WITH(db.insert("People", rows), Catch::Matchers::StartsWith("Global memory limit (1.0 KB)"));
+        CHECK_THROWS_WITH(parseByteSize("12 parsecs"), "Invalid size: 12 parsecs");
+
+        out.str("");
+        processCommand(session, "STATS", out);
+        CHECK_THAT(out.str(), Catch::Matchers::ContainsSubstring("People: 110 rows"));
+        CHECK_THAT(out.str(), Catch::Matchers::ContainsSubstring("limit 1.0 KB"));
+    }
+
+    SECTION("Partitioned tables count the storage of their partitions") {
+        PartitionScheme byId;
+        byId.kind = PartitionKind::HASH;
+        byId.column = "ID";
+        byId.count = 3;
+        Table partitioned("People", getTestColumns(), byId);
+        Table plain("People", getTestColumns());
+        partitioned.appendRows(makeRows(3000));
+        plain.appendRows(makeRows(3000));
+        const MemoryUsage usage = partitioned.getMemoryUsage();
+        CHECK(usage.rowBytes >= 3000 * (sizeof(Row) + 3 * sizeof(Value)));
+        CHECK(usage.stringBytes == plain.getMemoryUsage().stringBytes);
+        CHECK(usage.indexBytes > 0);
+        CHECK(usage.summaryBytes > 0);
+
+        Database db(testDb);
+        db.createTable("Sharded", getTestColumns(), byId);
+        std::vector<Row> rows = makeRows(1000);
+        db.insert("Sharded", rows);
+        db.setTableMemoryLimit("Sharded", db.getTable("Sharded").getMemoryUsage().total() + 1024);
+        rows = makeRows(100);
+        CHECK_THROWS_WITH(db.insert("Sharded", rows), Catch::Matchers::ContainsSubstring("Memory limit of Sharded"));
+        CHECK(db.getTable("Sharded").getRowCount() == 1000);
+    }
+
+    SECTION("Running byte counts follow every change") {
+        // Zone maps: the count kept as blocks are added, widened and rebuilt matches a walk of them.
+        Table table("People", getTestColumns());
+        table.appendRows(makeRows(3000));
+        table.updateRows({5, 2500}, {{1, Value(std::string(200, 'z'))}});
+        table.removeRows({0, 1, 2});
+        table.updateRows({1024}, {{1, Value(std::string(300, 'a'))}});
+        std::size_t walked = 0;
+        for (std::size_t b = 0; b < table.getBlockCount(); b++) {
+            const BlockSummary& block = table.getBlock(b);
+            walked += (block.min.capacity() + block.max.capacity()) * sizeof(Value) + block.mixedTypes.capacity() / 8 +
+                      block.blooms.capacity() * sizeof(BloomFilter);
+            for (std::size_t i = 0; i < block.min.size(); i++) {
+                walked += stringHeapBytes(block.min[i].strValue) + stringHeapBytes(block.max[i].strValue) +
+                          block.blooms[i].memoryUsage();
+            }
+        }
+        const std::size_t structs = table.getMemoryUsage().summaryBytes - walked;
+        CHECK(structs % sizeof(BlockSummary) == 0);
+        CHECK(structs >= table.getBlockCount() * sizeof(BlockSummary));
+
+        // Trigram postings: removing every value gives back all the bytes its postings took.
+        TrigramIndex trigrams;
+        for (std::size_t i = 0; i < 500; i++) trigrams.insert(Value("user" + std::to_string(i)), i);
+        for (std::size_t i = 0; i < 500; i++) trigrams.remove(Value("user" + std::to_string(i)), i);
+        const std::size_t emptied = trigrams.memoryUsage();
+        trigrams.clear();
+        CHECK(trigrams.memoryUsage() == emptied);
+    }
+
+    std::remove(testDb.c_str());
+    std::filesystem::remove_all(testDb + ".tables");
+}
+
+TEST_CASE("Result Cache", "[resultcache]") {
+    const std::string testDb = "test_resultcache.db";
+    std::remove(testDb.c_str());
+    std::filesystem::remove_all(testDb + ".tables");
+
+    Database db(testDb);
+    StatementCache cache;
+    Session session(db, cache);
+    db.createTable("People", getTestColumns());
+    std::vector<Row> rows(100);
+    for (std::size_t i = 0; i < rows.size(); i++) {
+        rows[i].values = { Value(0.0), Value("User" + std::to_string(i % 5)), Value("2024-01-01", DataType::DATE) };
+    }
+    db.insert("People", rows);
+    const ResultCache& results = db.getResultCache();
+
+    SECTION("Repeated queries hit until the table changes") {
+        session.query("SELECT * FROM People WHERE Name = \"User1\"");
+        CHECK(results.getHits() + results.getMisses() == 0);
+
+        std::ostringstream out;
+        processCommand(session, "SETCACHE 1MB", out);
+        CHECK(out.str() == "Result cache budget set to 1.0 MB\n");
+        CHECK(session.query("SELECT * FROM People WHERE Name = \"User1\"").size() == 20);
+        CHECK(session.query("select * from People where Name=\"User1\"").size() == 20);
+        CHECK(results.getHits() == 1);
+        CHECK(results.getMisses() == 1);
+
+        processCommand(session, "INSERT INTO People {(0, \"User1\", \"2024-02-01\")}", out);
+        CHECK(session.query("SELECT * FROM People WHERE Name = \"User1\"").size() == 21);
+        CHECK(results.getMisses() == 2);
+        processCommand(session, "UPDATE People SET Name = \"Gone\" WHERE ID = 2", out);
+        CHECK(session.query("SELECT * FROM People WHERE Name = \"User1\"").size() == 20);
+        processCommand(session, "REMOVE People WHERE Name = \"User1\"", out);
+        CHECK(session.query("SELECT * FROM People WHERE Name = \"User1\"").empty());
+        CHECK(results.getHits() == 1);
+    }
+
+    SECTION("Bound values, rollbacks and recreated tables") {
+        db.setResultCacheBudget(1 << 20);
+        auto byId = session.prepare("SELECT Name FROM People WHERE ID = ?");
+        CHECK(session.query(*byId, {Value(1.0)}).at(0, 0).strValue == "User0");
+        session.query(*byId, {Value(1.0000001)});
+        CHECK(session.query(*byId, {Value(2.0)}).at(0, 0).strValue == "User1");
+        CHECK(results.getHits() == 0);
+        CHECK(session.query(*byId, {Value(2.0)}).at(0, 0).strValue == "User1");
+        CHECK(results.getHits() == 1);
+
+        const uint64_t before = db.getTable("People").getVersion();
+        Session writer(db, cache);
+        writer.begin();
+        writer.query("SELECT * FROM People");
+        processCommand(writer, "INSERT INTO People {(0, \"Temp\", \"2024-01-01\")}");
+        CHECK(writer.query("SELECT * FROM People").size() == 101);
+        CHECK(session.query("SELECT * FROM People").size() == 100);
+        writer.rollback();
+        CHECK(db.getTable("People").getVersion() == before);
+        const std::size_t hits = results.getHits();
+        CHECK(session.query("SELECT * FROM People").size() == 100);
+        CHECK(results.getHits() == hits + 1);
+
+        db.dropTable("People");
+        db.createTable("People", getTestColumns());
+        CHECK(session.query("SELECT * FROM People").empty());
+    }
+
+    SECTION("Least recently used results leave first when over budget") {
+        ResultSet big;
+        big.columns = {{"Name", DataType::STRING}};
+        big.rows.resize(10, Row(std::vector<Value>{Value(std::string(1000, 'x'))}));
+        const std::size_t bytes = ResultCache::resultBytes(big);
+
+        ResultCache lru(3 * bytes);
+        lru.put("a", 1, big);
+        lru.put("b", 1, big);
+        CHECK(lru.find("a", 1));
+        lru.put("c", 1, big);
+        CHECK(lru.size() == 2);
+        CHECK_FALSE(lru.find("b", 1));
+        CHECK(lru.find("a", 1));
+        CHECK_FALSE(lru.find("a", 2));
+        CHECK(lru.size() == 1);
+        CHECK(lru.getBytes() <= 3 * bytes);
+    }
+
+    std::remove(testDb.c_str());
+    std::filesystem::remove_all(testDb + ".tables");
+}
+
+TEST_CASE("Table Partitioning", "[partition]") {
+    const std::string testDb = "test_partition.db";
+    std::remove(testDb.c_str());
+    std::filesystem::remove_all(testDb + ".tables");
+
+    auto partitionSizes = [](const Table& table) {
+        std::vector<std::size_t> sizes;
+        for (const auto& partition : table.getPartitions()) sizes.push_back(partition.getRows().size());
+        return sizes;
+    };
+
+    SECTION("Range partitions prune scans and drop in one step") {
+        Database db(testDb);
+        StatementCache cache;
+        Session session(db, cache);
+        std::ostringstream out;
+        processCommand(session, "CREATETABLE Events (ID:Double AUTOINCREMENT, Day:Date, Kind:String) INDEX ON ID "
+                                "PARTITION BY RANGE(Day) (\"2024-02-01\", \"2024-03-01\")", out);
+        REQUIRE(db.getTable("Events").isPartitioned());
+        for (int month = 1; month <= 4; month++) {
+            std::vector<Row> rows(10);
+            for (std::size_t i = 0; i < rows.size(); i++) {
+                rows[i].values = { Value(0.0), Value("2024-0" + std::to_string(month) + "-1" + std::to_string(i), DataType::DATE),
+                                   Value(i % 2 ? "click" : "view") };
+            }
+            db.insert("Events", rows);
+        }
+        const Table& events = db.getTable("Events");
+        CHECK(events.getRowCount() == 40);
+        CHECK(events.getRows().empty());
+        CHECK(partitionSizes(events) == std::vector<std::size_t>{10, 10, 20});
+
+        CHECK(session.query("SELECT * FROM Events WHERE Day >= \"2024-03-01\"").size() == 20);
+        CHECK(session.query("SELECT ID FROM Events WHERE ID = 15").at(0, 0).numValue == 15);
+        const ResultSet ordered = session.query("SELECT ID FROM Events WHERE Kind = \"click\" ORDER BY ID");
+        REQUIRE(ordered.size() == 20);
+        CHECK(ordered.at(0, 0).numValue == 2);
+        CHECK(ordered.at(19, 0).numValue == 40);
+
+        out.str("");
+        processCommand(session, "EXPLAIN ANALYZE SELECT * FROM Events WHERE Day < \"2024-02-01\" OR Day = \"2024-04-13\"", out);
+        CHECK_THAT(out.str(), Catch::Matchers::ContainsSubstring("Partition Scan (2 of 3 partitions: p0 Seq Scan, p2 Seq Scan"));
+        CHECK_THAT(out.str(), Catch::Matchers::ContainsSubstring("rows in=30, rows out=11"));
+
+        processCommand(session, "REMOVE Events WHERE Day >= \"2024-02-01\" AND Day < \"2024-02-14\"", out);
+        CHECK(partitionSizes(events) == std::vector<std::size_t>{10, 6, 20});
+        CHECK_THROWS_WITH(db.update("Events", {{1, Value("2024-05-01", DataType::DATE)}}, nullptr),
+                          Catch::Matchers::ContainsSubstring("Cannot update partition column Day"));
+
+        out.str("");
+        processCommand(session, "DROPPARTITION Events \"2024-01-20\"", out);
+        CHECK(out.str() == "Partition dropped from Events (10 rows removed)\n");
+        CHECK(partitionSizes(events) == std::vector<std::size_t>{6, 20});
+        CHECK(events.getPartitioning().describe(0) == "Day < \"2024-03-01\"");
+        processCommand(session, "ADDPARTITION Events \"2024-04-01\"", out);
+        CHECK(partitionSizes(events) == std::vector<std::size_t>{6, 10, 10});
+        CHECK(session.query("SELECT * FROM Events WHERE Day >= \"2024-04-01\"").size() == 10);
+
+        out.str("");
+        processCommand(session, "TABLEINFO Events", out);
+        CHECK_THAT(out.str(), Catch::Matchers::ContainsSubstring("Partitioned by RANGE(Day) into 3 partitions"));
+        CHECK_THAT(out.str(), Catch::Matchers::ContainsSubstring("p2 (\"2024-04-01\" <= Day): 10 rows"));
+        out.str("");
+        processCommand(session, "ADDPARTITION Events \"2024-03-01\"", out);
+        CHECK_THAT(out.str(), Catch::Matchers::ContainsSubstring("already exists"));
+    }
+
+    SECTION("Hash partitions keep unique columns unique across partitions") {
+        PartitionScheme byName;
+        byName.kind = PartitionKind::HASH;
+        byName.column = "Name";
+        byName.count = 4;
+        Table people("People", getTestColumns(), byName);
+        std::vector<Row> rows(200);
+        for (std::size_t i = 0; i < rows.size(); i++) {
+            rows[i].values = { Value(0.0), Value("User" + std::to_string(i)), Value("2024-01-01", DataType::DATE) };
+        }
+        people.appendRows(std::move(rows));
+        for (std::size_t size : partitionSizes(people)) CHECK(size > 20);
+        CHECK(people.getPartitions()[byName.partitionOf(Value("User7"))].getIndex("ID")->find(Value(8.0)).size() == 1);
+
+        std::vector<Row> duplicate(1);
+        duplicate[0].values = { Value(8.0), Value("Someone else"), Value("2024-01-01", DataType::DATE) };
+        CHECK_THROWS_WITH(people.appendRows(std::move(duplicate)), "Duplicate value 8 for unique column ID");
+        CHECK(people.getRowCount() == 200);
+        CHECK(people.getAutoIncrementCounters().at("ID") == 201);
+
+        auto matchingName = std::make_unique<ComparisonExpression>("Name", "=", Value("User7"));
+        CHECK(prunePartitions(people, matchingName.get()) == std::vector<std::size_t>{byName.partitionOf(Value("User7"))});
+        auto byId = std::make_unique<ComparisonExpression>("ID", "=", Value(8.0));
+        CHECK(prunePartitions(people, byId.get()).size() == 4);
+        const Value takenId = people.getPartitions()[1].getRows()[0].values[0];
+        CHECK_THROWS_WITH(people.updatePartitionRows({0}, {{0}}, {{0, takenId}}),
+                          "Duplicate value " + takenId.toString() + " for unique column ID");
+        CHECK_THROWS_WITH(people.dropPartition(Value("User7")), "Table People is not RANGE partitioned");
+        CHECK_THROWS_WITH(Table("Bad", getTestColumns(), PartitionScheme{PartitionKind::RANGE, "Missing", {Value(1.0)}}),
+                          "Unknown partition column: Missing");
+    }
+
+    SECTION("Partitions survive saving and loading") {
+        {
+            Database db(testDb);
+            StatementCache cache;
+            Session session(db, cache);
+            processCommand(session, "CREATETABLE Readings (ID:Double AUTOINCREMENT, Sensor:Double) INDEX ON Sensor "
+                                    "PARTITION BY HASH(Sensor) 3");
+            std::vector<Row> rows(90);
+            for (std::size_t i = 0; i < rows.size(); i++) rows[i].values = { Value(0.0), Value(static_cast<double>(i % 9)) };
+            db.insert("Readings", rows);
+            db.analyze("Readings");
+        }
+        Database db(testDb);
+        const Table& readings = db.getTable("Readings");
+        REQUIRE(readings.getPartitions().size() == 3);
+        CHECK(readings.getRowCount() == 90);
+        CHECK(readings.getPartitions()[0].getStatistics() != nullptr);
+        CHECK(db.select("Readings", {"*"}, parseTestWhere(db, "Readings", "Sensor = 4"), "", false).size() == 10);
+
+        std::vector<Row> more(1);
+        more[0].values = { Value(0.0), Value(4.0) };
+        db.insert("Readings", more);
+        const ResultSet last = db.select("Readings", {"ID"}, parseTestWhere(db, "Readings", "Sensor = 4"), "ID", false);
+        CHECK(last.at(last.size() - 1, 0).numValue == 91);
+    }
+
+    std::remove(testDb.c_str());
+    std::filesystem::remove_all(testDb + ".tables");
+}
+TEST_CASE("Covering Indexes and Index-Only Scans", "[index]") {
+    const std::string testDb = "test_covering.db";
+    std::remove(testDb.c_str());
+    std::filesystem::remove_all(testDb + ".tables");
+
+    SECTION("Covered queries are answered from the index") {
+        Database db(testDb);
+        StatementCache cache;
+        Session session(db, cache);
+        std::ostringstream out;
+        processCommand(session, "CREATETABLE Orders (ID:Double AUTOINCREMENT, Customer:String, Total:Double, Note:String) "
+                                "INDEX ON Customer INCLUDE (Total, ID)", out);
+        std::vector<Row> rows(300);
+        for (std::size_t i = 0; i < rows.size(); i++) {
+            rows[i].values = { Value(0.0), Value("c" + std::to_string(i % 30)), Value(static_cast<double>(i % 7)), Value("n") };
+        }
+        db.insert("Orders", rows);
+
+        out.str("");
+        processCommand(session, "EXPLAIN ANALYZE SELECT ID, Total FROM Orders WHERE Customer = \"c3\" AND Total > 2 ORDER BY Customer", out);
+        CHECK_THAT(out.str(), Catch::Matchers::ContainsSubstring("Index Only Scan (using Customer index: Customer = \"c3\")"));
+        CHECK_THAT(out.str(), !Catch::Matchers::ContainsSubstring("Sort"));
+        out.str("");
+        processCommand(session, "EXPLAIN SELECT ID, Note FROM Orders WHERE Customer = \"c3\"", out);
+        CHECK_THAT(out.str(), Catch::Matchers::ContainsSubstring("Index Lookup"));
+
+        // The covered and the row-fetching plan agree, row for row.
+        const ResultSet covered = session.query("SELECT ID, Total FROM Orders WHERE Customer >= \"c25\" AND Customer < \"c3\" ORDER BY Total");
+        const ResultSet fetched = session.query("SELECT ID, Total, Note FROM Orders WHERE Customer >= \"c25\" AND Customer < \"c3\" ORDER BY Total");
+        REQUIRE(covered.size() == 50);
+        REQUIRE(fetched.size() == 50);
+        std::multiset<std::pair<double, double>> coveredRows, fetchedRows;
+        for (std::size_t i = 0; i < covered.size(); i++) {
+            CHECK(covered.at(i, 1).numValue == fetched.at(i, 1).numValue);
+            coveredRows.emplace(covered.at(i, 0).numValue, covered.at(i, 1).numValue);
+            fetchedRows.emplace(fetched.at(i, 0).numValue, fetched.at(i, 1).numValue);
+        }
+        CHECK(coveredRows == fetchedRows);
+
+        processCommand(session, "UPDATE Orders SET Total = 100 WHERE ID = 4", out);
+        processCommand(session, "REMOVE Orders WHERE ID = 34", out);
+        const ResultSet changed = session.query("SELECT ID, Total FROM Orders WHERE Customer = \"c3\"");
+        REQUIRE(changed.size() == 9);
+        CHECK(changed.at(0, 0).numValue == 4);
+        CHECK(changed.at(0, 1).numValue == 100);
+        CHECK(changed.at(1, 0).numValue == 64);
+
+        std::vector<Column> plainColumns = db.getTable("Orders").getColumns();
+        plainColumns[1].include.clear();
+        Table plain("Plain", plainColumns);
+        plain.appendRows(std::vector<Row>(db.getTable("Orders").getRows()));
+        CHECK(db.getTable("Orders").getIndex("Customer")->memoryUsage() > plain.getIndex("Customer")->memoryUsage());
+    }
+
+    SECTION("INCLUDE lists are validated and saved") {
+        std::vector<Column> columns = getTestColumns();
+        columns[1].indexed = true;
+        columns[1].include = {"Missing"};
+        CHECK_THROWS_WITH(Table("Bad", columns), "Unknown INCLUDE column: Missing");
+        columns[1].include = {"Name"};
+        CHECK_THROWS_WITH(Table("Bad", columns), "Column Name cannot be included in an index on Name");
+
+        {
+            Database db(testDb);
+            StatementCache cache;
+            Session session(db, cache);
+            processCommand(session, "CREATETABLE Scores (Player:String, Points:Double) INDEX ON Player INCLUDE (Points)");
+            processCommand(session, "INSERT INTO Scores {(\"ana\", 3), (\"bob\", 5), (\"ana\", 7)}");
+        }
+        Database db(testDb);
+        StatementCache cache;
+        Session session(db, cache);
+        CHECK(db.getTable("Scores").getColumns()[0].include == std::vector<std::string>{"Points"});
+        std::ostringstream out;
+        processCommand(session, "TABLEINFO Scores", out);
+        CHECK_THAT(out.str(), Catch::Matchers::ContainsSubstring("Player:String, Indexed INCLUDE (Points)"));
+        const ResultSet points = session.query("SELECT Points FROM Scores WHERE Player = \"ana\"");
+        REQUIRE(points.size() == 2);
+        CHECK(points.at(0, 0).numValue + points.at(1, 0).numValue == 10);
+    }
+
+    std::remove(testDb.c_str());
+    std::filesystem::remove_all(testDb + ".tables");
+}
+
+TEST_CASE("IN and BETWEEN Predicates", "[planner]") {
+    const std::string testDb = "test_inbetween.db";
+    std::remove(testDb.c_str());
+    std::filesystem::remove_all(testDb + ".tables");
+
+    Database db(testDb);
+    StatementCache cache;
+    Session session(db, cache);
+    std::ostringstream out;
+    processCommand(session, "CREATETABLE Items (ID:Double AUTOINCREMENT, Kind:String, Price:Double) INDEX ON ID INDEX ON Kind", out);
+    std::vector<Row> rows(3000);
+    for (std::size_t i = 0; i < rows.size(); i++) {
+        rows[i].values = { Value(0.0), Value("k" + std::to_string(i % 10)), Value(static_cast<double>(i)) };
+    }
+    db.insert("Items", rows);
+
+    auto explain = [&](const std::string& condition) {
+        auto tokens = tokenize(condition);
+        size_t pos = 0;
+        auto where = Parser::parseWhereExpression(tokens, pos, db.getTable("Items"));
+        return db.explainSelect("Items", {"*"}, where, "", false, true);
+    };
+
+    SECTION("IN and BETWEEN agree with the equivalent OR and AND chains") {
+        const ResultSet in = session.query("SELECT ID FROM Items WHERE ID IN (2999, 17, 5, 17)");
+        const ResultSet chain = session.query("SELECT ID FROM Items WHERE ID = 5 OR ID = 17 OR ID = 2999");
+        REQUIRE(in.size() == 3);
+        REQUIRE(chain.size() == 3);
+        for (std::size_t i = 0; i < in.size(); i++) CHECK(in.at(i, 0).numValue == chain.at(i, 0).numValue);
+
+        CHECK(session.query("SELECT ID FROM Items WHERE Kind IN (\"k1\", \"k3\")").size() == 600);
+        CHECK(session.query("SELECT ID FROM Items WHERE Kind NOT IN (\"k1\", \"k3\")").size() == 2400);
+        CHECK(session.query("SELECT ID FROM Items WHERE Price BETWEEN 10 AND 19").size() == 10);
+        CHECK(session.query("SELECT ID FROM Items WHERE Price NOT BETWEEN 10 AND 2999").size() == 10);
+        CHECK(session.query("SELECT ID FROM Items WHERE Price BETWEEN 19 AND 10").size() == 0);
+
+        processCommand(session, "REMOVE Items WHERE Kind IN (\"k0\", \"k9\")", out);
+        CHECK(db.getTable("Items").getRows().size() == 2400);
+    }
+
+    SECTION("IN probes the index once per value and BETWEEN scans one range") {
+        processCommand(session, "EXPLAIN SELECT * FROM Items WHERE ID IN (3, 1, 2)", out);
+        CHECK_THAT(out.str(), Catch::Matchers::ContainsSubstring("Index Multi-Lookup (using ID index: ID IN (1, 2, 3))"));
+        processCommand(session, "EXPLAIN SELECT * FROM Items WHERE ID BETWEEN 100 AND 199", out);
+        CHECK_THAT(out.str(), Catch::Matchers::ContainsSubstring("Index Range Scan (using ID index: ID BETWEEN 100 AND 199)"));
+
+        QueryPlan plan = explain("Kind IN (\"k2\", \"k4\", \"k2\")");
+        OperatorStats* probe = plan.find("Index Multi-Lookup");
+        REQUIRE(probe);
+        CHECK(probe->indexProbes == 2);
+        CHECK(probe->rowsOut == 600);
+    }
+
+    SECTION("Blocks outside every listed value or the range are skipped") {
+        QueryPlan plan = explain("Price BETWEEN 2500 AND 2600");
+        OperatorStats* scan = plan.find("Seq Scan");
+        REQUIRE(scan);
+        CHECK(scan->blocksSkipped == 2);
+        CHECK(scan->rowsOut == 101);
+
+        plan = explain("Price IN (5, 2500)");
+        CHECK(plan.find("Seq Scan")->blocksSkipped == 1);
+    }
+
+    SECTION("Prepared IN lists are rebound on every execution") {
+        auto select = session.prepare("SELECT ID FROM Items WHERE ID IN (?, ?)");
+        CHECK(session.query(*select, { Value(1.0), Value(2.0) }).size() == 2);
+        const ResultSet same = session.query(*select, { Value(3.0), Value(3.0) });
+        REQUIRE(same.size() == 1);
+        CHECK(same.at(0, 0).numValue == 3);
+    }
+
+    SECTION("Malformed lists are rejected") {
+        processCommand(session, "SELECT * FROM Items WHERE ID IN 1", out);
+        CHECK_THAT(out.str(), Catch::Matchers::ContainsSubstring("Expected ( after IN"));
+        processCommand(session, "SELECT * FROM Items WHERE ID BETWEEN 1 2", out);
+        CHECK_THAT(out.str(), Catch::Matchers::ContainsSubstring("Expected AND in BETWEEN"));
+    }
+
+    std::remove(testDb.c_str());
+    std::filesystem::remove_all(testDb + ".tables");
+}
+
+TEST_CASE("LIKE Patterns and Trigram Indexes", "[like]") {
+    const std::string testDb = "test_like.db";
+    std::remove(testDb.c_str());
+    std::filesystem::remove_all(testDb + ".tables");
+
+    SECTION("Wildcards match any run or exactly one character") {
+        CHECK(likeMatch("alice@example.com", "%@example.com"));
+        CHECK(likeMatch("abc", "a_c"));
+        CHECK(likeMatch("mississippi", "%iss%ipp%"));
+        CHECK(likeMatch("", "%"));
+        CHECK_FALSE(likeMatch("abc", "ab"));
+        CHECK_FALSE(likeMatch("ab", "a_c"));
+        CHECK_FALSE(likeMatch("Abc", "abc"));
+        CHECK(prefixSuccessor("ab") == "ac");
+        CHECK(prefixSuccessor("a\xFF") == "b");
+        CHECK_FALSE(prefixSuccessor(""));
+    }
+
+    SECTION("Prefixes scan the ordered index and infixes probe the trigram index") {
+        Database db(testDb);
+        StatementCache cache;
+        Session session(db, cache);
+        std::ostringstream out;
+        processCommand(session, "CREATETABLE Users (ID:Double AUTOINCREMENT, Name:String, Email:String, Code:String) "
+                                "INDEX ON Name TRIGRAM ON Email", out);
+        std::vector<Row> rows(3000);
+        for (std::size_t i = 0; i < rows.size(); i++) {
+            char code[32];
+            std::snprintf(code, sizeof(code), "c%04zu", i);
+            rows[i].values = { Value(0.0), Value("user" + std::to_string(i)),
+                               Value("user" + std::to_string(i) + (i % 3 == 0 ? "@example.com" : "@mail.org")), Value(code) };
+        }
+        db.insert("Users", rows);
+
+        out.str("");
+        processCommand(session, "EXPLAIN SELECT ID FROM Users WHERE Name LIKE \"user12%\"", out);
+        CHECK_THAT(out.str(), Catch::Matchers::ContainsSubstring("Index Range Scan (using Name index: Name LIKE \"user12%\")"));
+        CHECK(session.query("SELECT ID FROM Users WHERE Name LIKE \"user12%\"").size() == 111);
+        CHECK(session.query("SELECT ID FROM Users WHERE Name LIKE \"user12\"").size() == 1);
+
+        out.str("");
+        processCommand(session, "EXPLAIN SELECT ID FROM Users WHERE Email LIKE \"%99@exam%\"", out);
+        CHECK_THAT(out.str(), Catch::Matchers::ContainsSubstring("Trigram Index Scan (using Email trigram index: Email LIKE \"%99@exam%\")"));
+        CHECK(session.query("SELECT ID FROM Users WHERE Email LIKE \"%99@exam%\"").size() == 10);
+        CHECK(session.query("SELECT ID FROM Users WHERE Email LIKE \"%1_3@mail%\"").size() == 20);
+        CHECK(session.query("SELECT ID FROM Users WHERE Email NOT LIKE \"%@mail.org\"").size() == 1000);
+
+        // Fragments shorter than a trigram leave nothing to probe.
+        out.str("");
+        processCommand(session, "EXPLAIN SELECT ID FROM Users WHERE Email LIKE \"%9_\"", out);
+        CHECK_THAT(out.str(), Catch::Matchers::ContainsSubstring("Seq Scan"));
+
+        auto tokens = tokenize("Code LIKE \"c29%\"");
+        size_t pos = 0;
+        auto where = Parser::parseWhereExpression(tokens, pos, db.getTable("Users"));
+        QueryPlan plan = db.explainSelect("Users", {"*"}, where, "", false, true);
+        OperatorStats* scan = plan.find("Seq Scan");
+        REQUIRE(scan);
+        CHECK(scan->blocksSkipped == 2);
+        CHECK(scan->rowsOut == 100);
+
+        auto byName = session.prepare("SELECT ID FROM Users WHERE Name LIKE ?");
+        CHECK(session.query(*byName, { Value("user299%") }).size() == 11);
+        CHECK(session.query(*byName, { Value("nobody%") }).size() == 0);
+
+        processCommand(session, "UPDATE Users SET Email = \"root@new.net\" WHERE ID = 1", out);
+        processCommand(session, "REMOVE Users WHERE Email LIKE \"%@mail.org\"", out);
+        REQUIRE(db.getTable("Users").getRows().size() == 1000);
+        const ResultSet moved = session.query("SELECT ID FROM Users WHERE Email LIKE \"%@new.net\"");
+        REQUIRE(moved.size() == 1);
+        CHECK(moved.at(0, 0).numValue == 1);
+        CHECK(session.query("SELECT ID FROM Users WHERE Email LIKE \"%99@exam%\"").size() == 10);
+    }
+
+    SECTION("Trigram indexes are validated and saved") {
+        std::vector<Column> columns = getTestColumns();
+        columns[0].trigramIndex = true;
+        CHECK_THROWS_WITH(Table("Bad", columns), Catch::Matchers::ContainsSubstring("cannot have a trigram index"));
+
+        {
+            Database db(testDb);
+            StatementCache cache;
+            Session session(db, cache);
+            processCommand(session, "CREATETABLE Notes (ID:Double, Text:String) TRIGRAM ON Text");
+            processCommand(session, "INSERT INTO Notes {(1, \"quarterly report\"), (2, \"meeting notes\")}");
+            std::ostringstream out;
+            processCommand(session, "SELECT * FROM Notes WHERE ID LIKE \"1%\"", out);
+            CHECK_THAT(out.str(), Catch::Matchers::ContainsSubstring("LIKE needs a String or Date column: ID"));
+        }
+        Database db(testDb);
+        StatementCache cache;
+        Session session(db, cache);
+        std::ostringstream out;
+        processCommand(session, "TABLEINFO Notes", out);
+        CHECK_THAT(out.str(), Catch::Matchers::ContainsSubstring("Text:String, Trigram"));
+        CHECK(db.getTable("Notes").getTrigramIndex("Text"));
+        const ResultSet found = session.query("SELECT ID FROM Notes WHERE Text LIKE \"%report%\"");
+        REQUIRE(found.size() == 1);
+        CHECK(found.at(0, 0).numValue == 1);
+    }
+
+    std::remove(testDb.c_str());
+    std::filesystem::remove_all(testDb + ".tables");
 }
\ No newline at end of file